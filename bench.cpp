@@ -0,0 +1,321 @@
+#include "hoeffding.h"
+#include "generator.h"
+#include <chrono>
+
+#if defined(GLIB_WIN)
+	#include <psapi.h>
+	#pragma comment(lib, "psapi.lib")
+#else
+	#include <sys/resource.h>
+#endif
+
+using namespace TDatastream;
+
+///////////////////////////////
+// Benchmark-Scenario
+// Examples are generated in blocks, so generation, evaluation and learning can be timed separately
+// without starting a timer for every example
+class TBenchScenario {
+public:
+	TBenchScenario(const TStr& Nm_, PStreamGen Gen_, const TDriftMode& DriftMode_)
+		: Nm(Nm_), Gen(Gen_), DriftMode(DriftMode_) { }
+public:
+	TStr Nm;
+	PStreamGen Gen;
+	TDriftMode DriftMode;
+};
+
+///////////////////////////////
+// Kernel-Benchmark
+// Times a single learner kernel on prepared inputs; results are written as tab-separated lines 
+// (kernel, parameters, operations, nanoseconds per operation) that can be diffed across runs 
+class TKernelBench {
+public:
+	typedef std::chrono::steady_clock TClock;
+	TKernelBench(FILE* Out_) : Out(Out_), Sink(0.0) { }
+	inline void Start() { StartTm = TClock::now(); }
+	void Stop(const TStr& KernelNm, const TStr& ParamStr, const uint64& OpsN);
+	inline void Use(const double& Val) { Sink += Val; } // keeps the compiler from dropping the kernel calls 
+	inline double GetSink() const { return Sink; }
+private:
+	FILE* Out;
+	TClock::time_point StartTm;
+	volatile double Sink;
+};
+
+PStreamGen GetStreamGen(const TStr& StreamNm, const int& DriftPeriod, const int& Seed);
+void RunScenario(const TBenchScenario& Scenario, const uint64& ExamplesN, const int& BlockN, const int& EvalEvery,
+	const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking, const int& DriftCheck, const int& WindowSize, FILE* Out);
+void RunKernels(const int& ExamplesN, const int& RepsN, const int& Seed, FILE* Out);
+void BenchHistCls(TKernelBench& Bench, const int& MxBinsN, const int& LabelsN, const int& ExamplesN, const int& RepsN, TRnd& Rnd);
+void BenchHistReg(TKernelBench& Bench, const int& MxBinsN, const int& ExamplesN, const int& RepsN, TRnd& Rnd);
+void BenchNode(TKernelBench& Bench, const int& ValsN, const int& LabelsN, const int& ExamplesN, const int& RepsN, const int& Seed);
+void BenchRouting(TKernelBench& Bench, const int& ExamplesN, const int& Seed);
+uint64 GetPeakMemKB();
+
+int main(int argc, char** argv) {
+	try {
+		Env = TEnv(argc, argv, TNotify::StdNotify);
+		const TStr SuiteNm = Env.GetIfArgPrefixStr("-suite:", "stream", "Benchmark suite (stream, kernels)");
+		const TStr OutFNm = Env.GetIfArgPrefixStr("-out:", "", "Results file (stdout if empty)");
+		const TStr PathNm = Env.GetIfArgPrefixStr("-path:", "all", "Learner path (vfdt, cvfdt, hat, regression, all)");
+		const TStr StreamNm = Env.GetIfArgPrefixStr("-stream:", "hyperplane", "Classification stream (sea, hyperplane, randomtree, rbf)");
+		// NOTE: Double, so that 1e8 can be given on the command line
+		const uint64 ExamplesN = (uint64) Env.GetIfArgPrefixFlt("-examples:", 1e6, "Number of examples (1e6 to 1e8)");
+		const int DriftPeriod = Env.GetIfArgPrefixInt("-driftPeriod:", 250000, "Examples between abrupt drifts in the cvfdt and hat paths");
+		const int EvalEvery = Env.GetIfArgPrefixInt("-evalEvery:", 100, "Test-then-train every n-th example (0 for never)");
+		const int BlockN = Env.GetIfArgPrefixInt("-block:", 10000, "Examples generated at once");
+		const int Seed = Env.GetIfArgPrefixInt("-seed:", 1, "Random seed");
+		const double SplitConfidence = Env.GetIfArgPrefixFlt("-splitConfidence:", 1e-6, "Split confidence");
+		const double TieBreaking = Env.GetIfArgPrefixFlt("-tieBreaking:", 0.01, "Tie breaking");
+		const int GracePeriod = Env.GetIfArgPrefixInt("-gracePeriod:", 300, "Grace period");
+		const int DriftCheck = Env.GetIfArgPrefixInt("-driftCheck:", 10000, "Drift check");
+		const int WindowSize = Env.GetIfArgPrefixInt("-windowSize:", 50000, "Window size");
+		const int KernelExamplesN = Env.GetIfArgPrefixInt("-kernelExamples:", 100000, "Examples fed to each kernel");
+		const int KernelRepsN = Env.GetIfArgPrefixInt("-kernelReps:", 1000, "Repetitions of the split heuristics");
+		EAssertR(SuiteNm == "stream" || SuiteNm == "kernels", "Suite must be either stream or kernels.");
+
+		// NOTE: The learner reports progress on stdout; use -out: to keep the results apart 
+		FILE* Out = OutFNm.Empty() ? stdout : fopen(OutFNm.CStr(), "w");
+		EAssertR(Out != NULL, "Cannot open '" + OutFNm + "'.");
+		if (SuiteNm == "kernels") {
+			EAssertR(KernelExamplesN > 0 && KernelRepsN > 0, "Invalid kernel benchmark parameters.");
+			RunKernels(KernelExamplesN, KernelRepsN, Seed, Out);
+			if (Out != stdout) { fclose(Out); }
+			return 0;
+		}
+
+		EAssertR(ExamplesN > 0 && BlockN > 0 && EvalEvery >= 0 && DriftPeriod >= 0, "Invalid benchmark parameters.");
+
+		TVec<TBenchScenario> ScenarioV;
+		if (PathNm == "all" || PathNm == "vfdt") {
+			ScenarioV.Add(TBenchScenario("vfdt", GetStreamGen(StreamNm, 0, Seed), TDriftMode::NONE));
+		}
+		if (PathNm == "all" || PathNm == "cvfdt") {
+			ScenarioV.Add(TBenchScenario("cvfdt", GetStreamGen(StreamNm, DriftPeriod, Seed), TDriftMode::CVFDT));
+		}
+		if (PathNm == "all" || PathNm == "hat") {
+			ScenarioV.Add(TBenchScenario("hat", GetStreamGen(StreamNm, DriftPeriod, Seed), TDriftMode::HAT));
+		}
+		if (PathNm == "all" || PathNm == "regression") {
+			ScenarioV.Add(TBenchScenario("regression", TFriedmanGen::New(DriftPeriod, 1.0, Seed), TDriftMode::HAT)); // HAT is the adaptive regression learner 
+		}
+		EAssertR(!ScenarioV.Empty(), "Unknown learner path '" + PathNm + "'.");
+
+		// NOTE: Peak memory is per process; run one path per process to get per-path numbers
+		fprintf(Out, "path\tstream\texamples\tsec\texamples/sec\tgen-sec\tlearn-sec\teval-sec\terror\tnodes\tpeak-kb\n");
+		for (int ScenarioN = 0; ScenarioN < ScenarioV.Len(); ++ScenarioN) {
+			RunScenario(ScenarioV[ScenarioN], ExamplesN, BlockN, EvalEvery, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, Out);
+		}
+		if (Out != stdout) { fclose(Out); }
+	} catch(PExcept Except) {
+		printf("%s\n", TStr("[Error] "+Except->GetMsgStr()).CStr());
+		return 2;
+	}
+	return 0;
+}
+
+PStreamGen GetStreamGen(const TStr& StreamNm, const int& DriftPeriod, const int& Seed) {
+	if (StreamNm == "sea") { return TSeaGen::New(DriftPeriod, 0.1, Seed); }
+	if (StreamNm == "hyperplane") { return THyperplaneGen::New(10, 2, 0.001, DriftPeriod, 0.05, Seed); }
+	if (StreamNm == "randomtree") { return TRandomTreeGen::New(10, 5, 2, 5, DriftPeriod, 0.0, Seed); }
+	if (StreamNm == "rbf") { return TRandomRbfGen::New(10, 2, 50, 0.0, DriftPeriod, Seed); }
+	throw TDtExcept::New("Unknown stream '" + StreamNm + "'.");
+}
+
+void RunScenario(const TBenchScenario& Scenario, const uint64& ExamplesN, const int& BlockN, const int& EvalEvery,
+	const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking, const int& DriftCheck, const int& WindowSize, FILE* Out) {
+	const TStr ConfigFNm = "bench-" + Scenario.Gen->GetNm() + ".config";
+	Scenario.Gen->SaveConfig(ConfigFNm);
+	PHoeffdingTree Tree = THoeffdingTree::New(ConfigFNm, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize);
+	Tree->SetAdaptive(Scenario.DriftMode);
+	const bool ClsP = Scenario.Nm != "regression";
+
+	TTmProfiler Prof;
+	const int GenTmN = Prof.AddTimer("gen");
+	const int LearnTmN = Prof.AddTimer("learn");
+	const int EvalTmN = Prof.AddTimer("eval");
+	TVec<PExample> BlockV(BlockN, 0);
+	double Loss = 0.0; uint64 EvalN = 0;
+	for (uint64 ExampleN = 0; ExampleN < ExamplesN; ) {
+		const int CrrBlockN = (int) TMath::Mn((uint64) BlockN, ExamplesN-ExampleN);
+		Prof.StartTimer(GenTmN);
+		BlockV.Clr(false);
+		for (int BlockExampleN = 0; BlockExampleN < CrrBlockN; ++BlockExampleN) { BlockV.Add(Scenario.Gen->Next()); }
+		Prof.StopTimer(GenTmN);
+		// Test-then-train on a sample of the block before it is learned
+		if (EvalEvery > 0) {
+			Prof.StartTimer(EvalTmN);
+			for (int BlockExampleN = (int) ((EvalEvery-ExampleN%EvalEvery)%EvalEvery); BlockExampleN < CrrBlockN; BlockExampleN += EvalEvery) {
+				PExample Example = BlockV[BlockExampleN];
+				if (ClsP) {
+					Loss += Tree->Classify(Example) == Example->Label ? 0.0 : 1.0;
+				} else {
+					Loss += fabs(Tree->Predict(Example)-Example->Value);
+				}
+				++EvalN;
+			}
+			Prof.StopTimer(EvalTmN);
+		}
+		Prof.StartTimer(LearnTmN);
+		for (int BlockExampleN = 0; BlockExampleN < CrrBlockN; ++BlockExampleN) { Tree->Process(BlockV[BlockExampleN]); }
+		Prof.StopTimer(LearnTmN);
+		ExampleN += CrrBlockN;
+	}
+	const double LearnSec = Prof.GetTimerSec(LearnTmN);
+	const double Sec = LearnSec+Prof.GetTimerSec(GenTmN)+Prof.GetTimerSec(EvalTmN);
+	// Throughput counts learning only; generation and evaluation are reported separately
+	fprintf(Out, "%s\t%s\t%s\t%.3f\t%.0f\t%.3f\t%.3f\t%.3f\t%.6f\t%d\t%s\n", Scenario.Nm.CStr(), Scenario.Gen->GetNm().CStr(),
+		TUInt64::GetStr(ExamplesN).CStr(), Sec, LearnSec > 0.0 ? ExamplesN/LearnSec : 0.0, Prof.GetTimerSec(GenTmN), LearnSec,
+		Prof.GetTimerSec(EvalTmN), EvalN > 0 ? Loss/EvalN : 0.0, Tree->GetNodesN(), TUInt64::GetStr(GetPeakMemKB()).CStr());
+	fflush(Out);
+}
+
+///////////////////////////////
+// Kernel-Benchmark
+void TKernelBench::Stop(const TStr& KernelNm, const TStr& ParamStr, const uint64& OpsN) {
+	const double NSec = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(TClock::now()-StartTm).count();
+	fprintf(Out, "%s\t%s\t%s\t%.1f\n", KernelNm.CStr(), ParamStr.CStr(), TUInt64::GetStr(OpsN).CStr(), OpsN > 0 ? NSec/OpsN : 0.0);
+	fflush(Out);
+}
+
+void RunKernels(const int& ExamplesN, const int& RepsN, const int& Seed, FILE* Out) {
+	TKernelBench Bench(Out);
+	TRnd Rnd(Seed);
+	fprintf(Out, "kernel\tparams\tops\tns/op\n");
+	const int BinsNV[] = { 10, 100, 1000 };
+	const int LabelsNV[] = { 2, 10 };
+	for (int BinsN_ : BinsNV) {
+		for (int LabelsN : LabelsNV) { BenchHistCls(Bench, BinsN_, LabelsN, ExamplesN, RepsN, Rnd); }
+		BenchHistReg(Bench, BinsN_, ExamplesN, RepsN, Rnd);
+	}
+	const int ValsNV[] = { 2, 10, 100 };
+	for (int ValsN : ValsNV) {
+		for (int LabelsN : LabelsNV) { BenchNode(Bench, ValsN, LabelsN, ExamplesN, RepsN, Seed); }
+	}
+	BenchRouting(Bench, ExamplesN, Seed);
+}
+
+// Examples have a single numeric attribute drawn uniformly from [0,1]; the histogram fills up to MxBinsN bins 
+void BenchHistCls(TKernelBench& Bench, const int& MxBinsN, const int& LabelsN, const int& ExamplesN, const int& RepsN, TRnd& Rnd) {
+	TVec<PExample> ExampleV(ExamplesN, 0);
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) {
+		TAttributeV AttributesV; AttributesV.Add(TAttribute(0, Rnd.GetUniDev()));
+		ExampleV.Add(TExample::New(AttributesV, (int) Rnd.GetUniDevInt(LabelsN)));
+	}
+	const TStr ParamStr = TStr::Fmt("bins=%d,labels=%d", MxBinsN, LabelsN);
+	PIdGen IdGen = TIdGen::New();
+	THist Hist(MxBinsN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Hist.IncCls(ExampleV[ExampleN], 0, IdGen); }
+	Bench.Stop("THist::IncCls", ParamStr, ExamplesN);
+	double SplitVal = 0.0;
+	Bench.Start();
+	for (int RepN = 0; RepN < RepsN; ++RepN) { Bench.Use(Hist.InfoGain(SplitVal)); }
+	Bench.Stop("THist::InfoGain", ParamStr, RepsN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Hist.DecCls(ExampleV[ExampleN], 0); }
+	Bench.Stop("THist::DecCls", ParamStr, ExamplesN);
+}
+
+void BenchHistReg(TKernelBench& Bench, const int& MxBinsN, const int& ExamplesN, const int& RepsN, TRnd& Rnd) {
+	TVec<PExample> ExampleV(ExamplesN, 0);
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) {
+		TAttributeV AttributesV; AttributesV.Add(TAttribute(0, Rnd.GetUniDev()));
+		const double Val = AttributesV[0].Num;
+		ExampleV.Add(TExample::New(AttributesV, Val < 0.5 ? Val+Rnd.GetNrmDev() : 10.0*Val+Rnd.GetNrmDev()));
+	}
+	const TStr ParamStr = TStr::Fmt("bins=%d", MxBinsN);
+	THist Hist(MxBinsN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Hist.IncReg(ExampleV[ExampleN], 0); }
+	Bench.Stop("THist::IncReg", ParamStr, ExamplesN);
+	double SplitVal = 0.0;
+	Bench.Start();
+	for (int RepN = 0; RepN < RepsN; ++RepN) { Bench.Use(Hist.StdGain(SplitVal)); }
+	Bench.Stop("THist::StdGain", ParamStr, RepsN);
+}
+
+// Leaf kernels on the root of a tree that never splits, with ten discrete attributes of ValsN values each 
+void BenchNode(TKernelBench& Bench, const int& ValsN, const int& LabelsN, const int& ExamplesN, const int& RepsN, const int& Seed) {
+	PStreamGen Gen = TRandomTreeGen::New(10, ValsN, LabelsN, 5, 0, 0.0, Seed);
+	const TStr ConfigFNm = "bench-kernels.config";
+	Gen->SaveConfig(ConfigFNm);
+	PHoeffdingTree Tree = THoeffdingTree::New(ConfigFNm, TInt::Mx, 1e-6, 0.01);
+	Tree->SetAdaptive(TDriftMode::NONE);
+	TVec<PExample> ExampleV(ExamplesN, 0);
+	TStrV LineV(ExamplesN, 0);
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) {
+		PExample Example = Gen->Next();
+		TChA LineChA;
+		for (int AttrN = 0; AttrN < Example->AttributesV.Len(); ++AttrN) {
+			LineChA += TInt::GetStr(Example->AttributesV[AttrN].Value); LineChA += ',';
+		}
+		LineChA += TInt::GetStr(Example->Label);
+		ExampleV.Add(Example); LineV.Add(LineChA);
+	}
+	const TStr ParamStr = TStr::Fmt("values=%d,labels=%d", ValsN, LabelsN);
+	PNode Root = Tree->Root;
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Bench.Use(Tree->Preprocess(LineV[ExampleN])->Label); }
+	Bench.Stop("THoeffdingTree::Preprocess", ParamStr, ExamplesN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Tree->IncCounts(Root, ExampleV[ExampleN]); }
+	Bench.Stop("THoeffdingTree::IncCounts", ParamStr, ExamplesN);
+	const int AttrsN = Tree->Schema->GetAttrsN();
+	Bench.Start();
+	for (int RepN = 0; RepN < RepsN; ++RepN) {
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) { Bench.Use(Root->InfoGain(AttrN, *Tree->Schema)); }
+	}
+	Bench.Stop("TNode::InfoGain", ParamStr, (uint64) RepsN*AttrsN);
+	Bench.Start();
+	for (int RepN = 0; RepN < RepsN; ++RepN) {
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) { Bench.Use(Root->GiniGain(AttrN, *Tree->Schema)); }
+	}
+	Bench.Stop("TNode::GiniGain", ParamStr, (uint64) RepsN*AttrsN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Bench.Use(Tree->NaiveBayes(Root, ExampleV[ExampleN])); }
+	Bench.Stop("THoeffdingTree::NaiveBayes", ParamStr, ExamplesN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Tree->DecCounts(Root, ExampleV[ExampleN]); }
+	Bench.Stop("THoeffdingTree::DecCounts", ParamStr, ExamplesN);
+}
+
+// Routes examples from the root to their leaves in a tree grown on a random-tree stream 
+void BenchRouting(TKernelBench& Bench, const int& ExamplesN, const int& Seed) {
+	PStreamGen Gen = TRandomTreeGen::New(10, 5, 2, 8, 0, 0.0, Seed);
+	const TStr ConfigFNm = "bench-kernels.config";
+	Gen->SaveConfig(ConfigFNm);
+	PHoeffdingTree Tree = THoeffdingTree::New(ConfigFNm, 300, 1e-6, 0.01);
+	Tree->SetAdaptive(TDriftMode::NONE);
+	for (int ExampleN = 0; ExampleN < 10*ExamplesN; ++ExampleN) { Tree->Process(Gen->Next()); }
+	TVec<PExample> ExampleV(ExamplesN, 0);
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { ExampleV.Add(Gen->Next()); }
+	uint64 StepsN = 0;
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) {
+		PNode CrrNode = Tree->Root;
+		while (!Tree->IsLeaf(CrrNode)) { CrrNode = Tree->GetNextNodeCls(CrrNode, ExampleV[ExampleN]); ++StepsN; }
+		Bench.Use(CrrNode->Id);
+	}
+	Bench.Stop("THoeffdingTree::GetNextNodeCls", TStr::Fmt("nodes=%d,depth=%.2f", Tree->GetNodesN(), 1.0*StepsN/ExamplesN), StepsN);
+	Bench.Start();
+	for (int ExampleN = 0; ExampleN < ExamplesN; ++ExampleN) { Bench.Use(Tree->GetLeaf(Tree->Root(), *ExampleV[ExampleN])->Id); }
+	Bench.Stop("THoeffdingTree::GetLeaf", TStr::Fmt("nodes=%d,depth=%.2f", Tree->GetNodesN(), 1.0*StepsN/ExamplesN), StepsN);
+}
+
+uint64 GetPeakMemKB() {
+#if defined(GLIB_WIN)
+	PROCESS_MEMORY_COUNTERS MemCounters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &MemCounters, sizeof(MemCounters))) { return 0; }
+	return (uint64) MemCounters.PeakWorkingSetSize/1024;
+#else
+	struct rusage Usage;
+	if (getrusage(RUSAGE_SELF, &Usage) != 0) { return 0; }
+	#if defined(__APPLE__)
+	return (uint64) Usage.ru_maxrss/1024; // bytes on OS X
+	#else
+	return (uint64) Usage.ru_maxrss; // kilobytes on Linux
+	#endif
+#endif
+}
@@ -0,0 +1,228 @@
+#include "datain.h"
+#include "hoeffding.h"
+#include <cstring>
+#ifdef HT_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HT_ZSTD
+#include <zstd.h>
+#endif
+
+namespace TDatastream {
+	///////////////////////////////
+	// Block-Sources
+	class TBlockSrc {
+	public:
+		virtual ~TBlockSrc() { }
+		virtual int Read(char* Bf, const int& BfL) = 0; // returns 0 at the end of the file; throws on error
+	};
+
+	class TPlainSrc : public TBlockSrc {
+	public:
+		TPlainSrc(const TStr& FNm) : In(fopen(FNm.CStr(), "rb")) { EAssertR(In != NULL, "Cannot open `"+FNm+"'."); }
+		~TPlainSrc() { fclose(In); }
+		int Read(char* Bf, const int& BfL) {
+			const int BytesN = (int) fread(Bf, 1, BfL, In);
+			if (BytesN < BfL && ferror(In)) { throw TDtExcept::New("Read error."); }
+			return BytesN;
+		}
+	private:
+		FILE* In;
+	};
+
+#ifdef HT_ZLIB
+	// NOTE: gzread also reads concatenated gzip members, as written by `cat a.gz b.gz'
+	class TGzipSrc : public TBlockSrc {
+	public:
+		TGzipSrc(const TStr& FNm) : In(gzopen(FNm.CStr(), "rb")) {
+			EAssertR(In != NULL, "Cannot open `"+FNm+"'.");
+			gzbuffer(In, 256*1024);
+		}
+		~TGzipSrc() { gzclose(In); }
+		// A short read is the end of the file or an error; a file cut off before the end of its stream leaves Z_BUF_ERROR 
+		int Read(char* Bf, const int& BfL) {
+			const int BytesN = gzread(In, Bf, BfL);
+			if (BytesN < BfL) {
+				int ErrN = Z_OK;
+				const char* ErrMsg = gzerror(In, &ErrN);
+				if (ErrN == Z_BUF_ERROR) { throw TDtExcept::New("Gzip error: the file is truncated."); }
+				if (BytesN < 0 || (ErrN != Z_OK && ErrN != Z_STREAM_END)) { throw TDtExcept::New(TStr("Gzip error: ")+ErrMsg); }
+			}
+			return BytesN;
+		}
+	private:
+		gzFile In;
+	};
+#endif
+
+#ifdef HT_ZSTD
+	class TZstdSrc : public TBlockSrc {
+	public:
+		TZstdSrc(const TStr& FNm) : In(fopen(FNm.CStr(), "rb")), DCtx(ZSTD_createDCtx()), InBfV(ZSTD_DStreamInSize()), InEnd(0), InPos(0),
+			EofP(false), FrameRest(0) {
+			EAssertR(In != NULL, "Cannot open `"+FNm+"'.");
+		}
+		~TZstdSrc() { ZSTD_freeDCtx(DCtx); fclose(In); }
+		int Read(char* Bf, const int& BfL) {
+			ZSTD_outBuffer Out = { Bf, (size_t) BfL, 0 };
+			while (Out.pos < Out.size) {
+				if (InPos == InEnd && !EofP) {
+					InEnd = fread(InBfV.data(), 1, InBfV.size(), In); InPos = 0;
+					if (InEnd == 0) {
+						if (ferror(In)) { throw TDtExcept::New("Read error."); }
+						EofP = true;
+					}
+				}
+				if (InPos == InEnd) { // end of the file: flush what the decoder still holds; a frame that cannot finish is cut off 
+					if (FrameRest == 0) { break; }
+					const size_t PrevPos = Out.pos;
+					ZSTD_inBuffer ZIn = { InBfV.data(), 0, 0 };
+					FrameRest = ZSTD_decompressStream(DCtx, &Out, &ZIn);
+					if (ZSTD_isError(FrameRest)) { throw TDtExcept::New(TStr("Zstd error: ")+ZSTD_getErrorName(FrameRest)); }
+					if (FrameRest != 0 && Out.pos == PrevPos) { throw TDtExcept::New("Zstd error: the file is truncated."); }
+					continue;
+				}
+				ZSTD_inBuffer ZIn = { InBfV.data(), InEnd, InPos };
+				FrameRest = ZSTD_decompressStream(DCtx, &Out, &ZIn);
+				if (ZSTD_isError(FrameRest)) { throw TDtExcept::New(TStr("Zstd error: ")+ZSTD_getErrorName(FrameRest)); }
+				InPos = ZIn.pos;
+			}
+			return (int) Out.pos;
+		}
+	private:
+		FILE* In;
+		ZSTD_DCtx* DCtx;
+		std::vector<char> InBfV;
+		size_t InEnd;
+		size_t InPos;
+		bool EofP;
+		size_t FrameRest; // 0 once the last frame is decoded and flushed 
+	};
+#endif
+
+	///////////////////////////////
+	// Data-Input
+	TDataIn::TDataIn(const TStr& FNm, const int& BlockKB) : Compression(GetCompression(FNm)), Src(NULL), ReadBlockN(0), ReadPos(-1),
+		StopP(false), FillWaitsN(0) {
+		EAssertR(BlockKB > 0, "Block size must be positive.");
+		EAssertR(IsSupported(Compression), "`"+FNm+"' is compressed, but compiled without "+
+			(Compression == TCompression::GZIP ? "HT_ZLIB" : "HT_ZSTD")+".");
+		switch (Compression) {
+#ifdef HT_ZLIB
+		case TCompression::GZIP: Src = new TGzipSrc(FNm); break;
+#endif
+#ifdef HT_ZSTD
+		case TCompression::ZSTD: Src = new TZstdSrc(FNm); break;
+#endif
+		default: Src = new TPlainSrc(FNm); break;
+		}
+		for (int BlockN = 0; BlockN < 2; ++BlockN) {
+			BlockV[BlockN].resize(BlockKB*1024);
+			BlockLenV[BlockN] = 0; FullV[BlockN] = false;
+		}
+		Filler = std::thread(&TDataIn::Fill, this);
+	}
+	TDataIn::~TDataIn() {
+		{
+			std::lock_guard<std::mutex> Lock(BlockMutex);
+			StopP = true;
+		}
+		EmptyCond.notify_all();
+		if (Filler.joinable()) { Filler.join(); }
+		delete Src;
+	}
+	TCompression TDataIn::GetCompression(const TStr& FNm) {
+		FILE* In = fopen(FNm.CStr(), "rb");
+		EAssertR(In != NULL, "Cannot open `"+FNm+"'.");
+		uchar MagicV[4] = { 0, 0, 0, 0 };
+		const size_t BytesN = fread(MagicV, 1, 4, In);
+		fclose(In);
+		if (BytesN >= 2 && MagicV[0] == 0x1f && MagicV[1] == 0x8b) { return TCompression::GZIP; }
+		if (BytesN == 4 && MagicV[0] == 0x28 && MagicV[1] == 0xb5 && MagicV[2] == 0x2f && MagicV[3] == 0xfd) { return TCompression::ZSTD; }
+		return TCompression::NONE;
+	}
+	bool TDataIn::IsSupported(const TCompression& Compression) {
+		switch (Compression) {
+		case TCompression::NONE: return true;
+#ifdef HT_ZLIB
+		case TCompression::GZIP: return true;
+#endif
+#ifdef HT_ZSTD
+		case TCompression::ZSTD: return true;
+#endif
+		default: return false;
+		}
+	}
+	void TDataIn::Fill() {
+		int FillBlockN = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> Lock(BlockMutex);
+				EmptyCond.wait(Lock, [this, FillBlockN] { return !FullV[FillBlockN] || StopP; });
+				if (StopP) { return; }
+			}
+			// The block is ours until it is marked full
+			std::vector<char>& Block = BlockV[FillBlockN];
+			int BlockLen = 0;
+			std::string FillErrStr; // a deep copy; TStr reference counts are not thread-safe
+			try {
+				while (BlockLen < (int) Block.size()) {
+					const int BytesN = Src->Read(Block.data()+BlockLen, (int) Block.size()-BlockLen);
+					if (BytesN == 0) { break; }
+					BlockLen += BytesN;
+				}
+			} catch (PExcept Except) {
+				FillErrStr = Except->GetMsgStr().CStr(); BlockLen = 0;
+			}
+			std::lock_guard<std::mutex> Lock(BlockMutex);
+			BlockLenV[FillBlockN] = BlockLen; FullV[FillBlockN] = true;
+			if (!FillErrStr.empty()) { ErrStr = FillErrStr; }
+			FullCond.notify_one();
+			if (BlockLen == 0) { return; } // end of the file, or an error
+			FillBlockN = 1-FillBlockN;
+		}
+	}
+	bool TDataIn::NextBlock() {
+		std::unique_lock<std::mutex> Lock(BlockMutex);
+		if (ReadPos != -1) { // hand the consumed block back to the filler
+			if (BlockLenV[ReadBlockN] == 0) { return false; }
+			FullV[ReadBlockN] = false; EmptyCond.notify_one();
+			ReadBlockN = 1-ReadBlockN;
+		}
+		if (!FullV[ReadBlockN]) { ++FillWaitsN; FullCond.wait(Lock, [this] { return FullV[ReadBlockN]; }); }
+		if (!ErrStr.empty()) { throw TDtExcept::New(ErrStr.c_str()); }
+		ReadPos = 0;
+		return BlockLenV[ReadBlockN] > 0;
+	}
+	int TDataIn::Read(char* Bf, const int& BfL) {
+		int BytesN = 0;
+		while (BytesN < BfL) {
+			if (ReadPos == -1 || ReadPos == BlockLenV[ReadBlockN]) {
+				if (!NextBlock()) { break; }
+			}
+			const int CopyN = TMath::Mn<int>(BfL-BytesN, BlockLenV[ReadBlockN]-ReadPos);
+			memcpy(Bf+BytesN, BlockV[ReadBlockN].data()+ReadPos, CopyN);
+			BytesN += CopyN; ReadPos += CopyN;
+		}
+		return BytesN;
+	}
+	bool TDataIn::GetNextLn(TStr& Line) {
+		std::string LineStr;
+		bool AnyP = false;
+		while (true) {
+			if (ReadPos == -1 || ReadPos == BlockLenV[ReadBlockN]) {
+				if (!NextBlock()) { break; }
+			}
+			const char* Start = BlockV[ReadBlockN].data()+ReadPos;
+			const int RestN = BlockLenV[ReadBlockN]-ReadPos;
+			const char* End = (const char*) memchr(Start, '\n', RestN);
+			AnyP = true;
+			if (End == NULL) { LineStr.append(Start, RestN); ReadPos += RestN; continue; }
+			LineStr.append(Start, End-Start); ReadPos += (int) (End-Start)+1;
+			break;
+		}
+		if (!LineStr.empty() && LineStr.back() == '\r') { LineStr.pop_back(); }
+		Line = LineStr.c_str();
+		return AnyP;
+	}
+} // namespace TDatastream
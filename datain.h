@@ -0,0 +1,59 @@
+#ifndef DATAIN_H
+#define DATAIN_H
+
+#include <base.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDatastream {
+	///////////////////////////////
+	// Forward-Declarations
+	class TBlockSrc;
+
+	// compression of a data file, detected from its first bytes
+	enum class TCompression : char { NONE, GZIP, ZSTD };
+
+	///////////////////////////////
+	// Data-Input
+	// Reads a plain, gzip, or zstd data file. Gzip needs zlib and zstd needs libzstd; compile with HT_ZLIB and HT_ZSTD
+	// (and link the libraries) to enable them. A background thread reads and decompresses the file into one of two
+	// blocks of BlockKB kilobytes while the consumer takes lines or bytes from the other one, so decompression overlaps
+	// with parsing and learning. Read and GetNextLn must be called from one thread
+	ClassTP(TDataIn, PDataIn) // {
+	public:
+		static PDataIn New(const TStr& FNm, const int& BlockKB = 1024) { return new TDataIn(FNm, BlockKB); }
+		~TDataIn();
+		int Read(char* Bf, const int& BfL); // fills Bf unless the file ends; returns the number of bytes read
+		bool GetNextLn(TStr& Line); // line without `\n' or `\r\n'; false at the end of the file
+		inline TCompression GetCompression() const { return Compression; }
+		inline uint64 GetFillWaitsN() const { return FillWaitsN; } // the consumer waited for decompression
+		static TCompression GetCompression(const TStr& FNm);
+		static bool IsSupported(const TCompression& Compression);
+	private:
+		TDataIn(const TStr& FNm, const int& BlockKB);
+		TDataIn(const TDataIn&);
+		TDataIn& operator=(const TDataIn&);
+		void Fill(); // background thread
+		bool NextBlock(); // waits for the next full block; false at the end of the file
+	private:
+		const TCompression Compression;
+		TBlockSrc* Src;
+		std::mutex BlockMutex;
+		std::condition_variable FullCond; // a block was filled
+		std::condition_variable EmptyCond; // a block was consumed
+		std::vector<char> BlockV[2];
+		int BlockLenV[2]; // 0 marks the end of the file
+		bool FullV[2];
+		int ReadBlockN; // block the consumer reads; the other one is filled
+		int ReadPos; // -1 until the consumer has waited for the block
+		bool StopP;
+		std::string ErrStr; // first error of the background thread
+		uint64 FillWaitsN;
+		std::thread Filler;
+	};
+} // namespace TDatastream
+
+#endif
@@ -0,0 +1,159 @@
+#include "ensemble.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Hoeffding-Tree-Ensemble
+	THoeffdingEnsemble::THoeffdingEnsemble(const TStr& ConfigNm, const int& TreesN, const int& GracePeriod, const double& SplitConfidence,
+		const double& TieBreaking, const int& DriftCheck, const int& WindowSize, const double& Lambda_,
+		const int& SubspaceN, const int& ThreadsN_, const int& Seed)
+		: StopP(false), IdleN(0), WaitN(0), ErrP(false), Lambda(Lambda_), ThreadsN(ThreadsN_ > 0 ? ThreadsN_ : TMath::Mn<int>(TreesN, TMath::Mx<int>(1, std::thread::hardware_concurrency()))) {
+		EAssertR(TreesN > 0, "Ensemble needs at least one tree.");
+		EAssertR(Lambda > 0, "Poisson parameter must be positive.");
+		PSchema Schema = TSchema::New(ConfigNm); // one copy for all trees 
+		for (int TreeN = 0; TreeN < TreesN; ++TreeN) {
+			PHoeffdingTree Tree = THoeffdingTree::New(Schema, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize);
+			if (SubspaceN > 0) { Tree->SetSubspace(SubspaceN, Seed+TreeN); }
+			TreeV.Add(TEnsTree::New(Tree, Seed+TreeN));
+		}
+		for (int WorkerN = 0; WorkerN < ThreadsN; ++WorkerN) {
+			WorkerV.push_back(std::thread(&THoeffdingEnsemble::Work, this, WorkerN));
+		}
+	}
+	THoeffdingEnsemble::~THoeffdingEnsemble() {
+		try { Flush(); } catch (PExcept Except) { } // a destructor does not throw 
+		StopP.store(true, std::memory_order_release);
+		{ std::lock_guard<std::mutex> Lock(WaitMutex); } // a worker checks StopP under the lock before it sleeps 
+		WorkCond.notify_all();
+		for (auto It = WorkerV.begin(); It != WorkerV.end(); ++It) { It->join(); }
+	}
+	void THoeffdingEnsemble::Process(PExample Example) {
+		CheckErr();
+		TShExample ShExample(new TExample(*Example));
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) {
+			TEnsTree* EnsTree = TreeV[TreeN]();
+			// Back-pressure: wait for the slowest tree instead of buffering without bound 
+			if (!EnsTree->Queue.Push(ShExample)) {
+				WakeWorkers();
+				std::unique_lock<std::mutex> Lock(WaitMutex);
+				WaitN.fetch_add(1); std::atomic_thread_fence(std::memory_order_seq_cst);
+				DoneCond.wait(Lock, [EnsTree, &ShExample] { return EnsTree->Queue.Push(ShExample); });
+				WaitN.fetch_sub(1);
+			}
+			++EnsTree->PushedN;
+		}
+		WakeWorkers();
+	}
+	TLabel THoeffdingEnsemble::Classify(PExample Example) {
+		Flush();
+		const int LabelsN = TreeV[0]->Tree->Schema->GetLabelsN();
+		TIntV VoteV(LabelsN); VoteV.PutAll(0);
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) {
+			VoteV[TreeV[TreeN]->Tree->Classify(Example)]++;
+		}
+		return VoteV.GetMxValN();
+	}
+	double THoeffdingEnsemble::Predict(PExample Example) {
+		Flush();
+		double Sum = 0.0;
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) {
+			Sum += TreeV[TreeN]->Tree->Predict(Example);
+		}
+		return Sum/TreeV.Len();
+	}
+	void THoeffdingEnsemble::Flush() {
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) {
+			TEnsTree* EnsTree = TreeV[TreeN]();
+			if (EnsTree->DoneN.load(std::memory_order_acquire) == EnsTree->PushedN) { continue; }
+			std::unique_lock<std::mutex> Lock(WaitMutex);
+			WaitN.fetch_add(1); std::atomic_thread_fence(std::memory_order_seq_cst);
+			DoneCond.wait(Lock, [EnsTree] { return EnsTree->DoneN.load(std::memory_order_acquire) == EnsTree->PushedN; });
+			WaitN.fetch_sub(1);
+		}
+		CheckErr();
+	}
+	void THoeffdingEnsemble::SetAdaptive(const TDriftMode& DriftMode) {
+		Flush();
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) { TreeV[TreeN]->Tree->SetAdaptive(DriftMode); }
+	}
+	void THoeffdingEnsemble::Work(const int& WorkerN) {
+		const int TreesN = TreeV.Len();
+		while (!StopP.load(std::memory_order_acquire)) {
+			bool WorkP = false;
+			// Own trees first 
+			for (int TreeN = WorkerN; TreeN < TreesN; TreeN += ThreadsN) {
+				WorkP = Drain(TreeV[TreeN]()) || WorkP;
+			}
+			// Then steal from trees that fall behind 
+			for (int TreeN = 0; !WorkP && TreeN < TreesN; ++TreeN) {
+				if (TreeN % ThreadsN != WorkerN) { WorkP = Drain(TreeV[TreeN]()); }
+			}
+			if (WorkP) { WakeWaiters(); continue; }
+			// Sleep until some tree has examples; IdleN is raised before the queues are checked, so Process either sees
+			// a sleeping worker or the worker sees the new examples 
+			std::unique_lock<std::mutex> Lock(WaitMutex);
+			IdleN.fetch_add(1); std::atomic_thread_fence(std::memory_order_seq_cst);
+			WorkCond.wait(Lock, [this] { return StopP.load(std::memory_order_acquire) || IsWorkReady(); });
+			IdleN.fetch_sub(1);
+		}
+	}
+	bool THoeffdingEnsemble::Drain(TEnsTree* EnsTree) {
+		if (EnsTree->Queue.Empty()) { return false; }
+		bool IdleP = false;
+		if (!EnsTree->BusyP.compare_exchange_strong(IdleP, true, std::memory_order_acquire)) { return false; }
+		TShExample ShExample;
+		// CVFDT keeps every repeat in its window with its own leaf and bin IDs, so only there a repeat needs its own copy 
+		const bool CopyP = EnsTree->Tree->GetDriftMode() == TDriftMode::CVFDT;
+		// Bound the batch so that a single fast-growing tree doesn't starve the others of this worker 
+		for (int ExampleN = 0; ExampleN < 256 && EnsTree->Queue.Pop(ShExample); ++ExampleN) {
+			const int WeightN = GetPoissonDev(EnsTree->Rnd, Lambda);
+			try {
+				PExample Example;
+				for (int RepN = 0; RepN < WeightN; ++RepN) {
+					if (RepN == 0 || CopyP) { Example = TExample::New(*ShExample); }
+					EnsTree->Tree->Process(Example);
+				}
+			} catch (PExcept Except) {
+				const TStr MsgStr = Except->GetMsgStr();
+				std::lock_guard<std::mutex> Lock(WaitMutex);
+				if (ErrStr.Empty()) { ErrStr = MsgStr; ErrP.store(true, std::memory_order_release); }
+			}
+			ShExample.reset();
+			EnsTree->DoneN.fetch_add(1, std::memory_order_release);
+		}
+		EnsTree->BusyP.store(false, std::memory_order_release);
+		if (!EnsTree->Queue.Empty()) { WakeWorkers(); } // the batch bound left examples that another worker may take 
+		return true;
+	}
+	bool THoeffdingEnsemble::IsWorkReady() const {
+		for (int TreeN = 0; TreeN < TreeV.Len(); ++TreeN) {
+			const TEnsTree* EnsTree = TreeV[TreeN]();
+			if (!EnsTree->Queue.Empty() && !EnsTree->BusyP.load(std::memory_order_acquire)) { return true; }
+		}
+		return false;
+	}
+	void THoeffdingEnsemble::WakeWorkers() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (IdleN.load() == 0) { return; }
+		{ std::lock_guard<std::mutex> Lock(WaitMutex); }
+		WorkCond.notify_all();
+	}
+	void THoeffdingEnsemble::WakeWaiters() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (WaitN.load() == 0) { return; }
+		{ std::lock_guard<std::mutex> Lock(WaitMutex); }
+		DoneCond.notify_all();
+	}
+	void THoeffdingEnsemble::CheckErr() {
+		if (!ErrP.load(std::memory_order_acquire)) { return; }
+		std::lock_guard<std::mutex> Lock(WaitMutex);
+		if (!ErrStr.Empty()) { throw TDtExcept::New(ErrStr); }
+	}
+	// See [Knuth, 1997], Vol. 2, Section 3.4.1 
+	int THoeffdingEnsemble::GetPoissonDev(TRnd& Rnd, const double& Lambda) {
+		const double Limit = exp(-Lambda);
+		double Prod = Rnd.GetUniDev();
+		int DevN = 0;
+		while (Prod > Limit) { ++DevN; Prod *= Rnd.GetUniDev(); }
+		return DevN;
+	}
+} // namespace TDatastream
@@ -0,0 +1,137 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "hoeffding.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TDatastream {
+	///////////////////////////////
+	// Single-Producer-Single-Consumer-Queue
+	// Lock-free bounded ring buffer; Capacity must be a power of two
+	template <class TVal>
+	class TSpscQueue {
+	public:
+		TSpscQueue(const int& Capacity_ = 1024)
+			: Capacity(Capacity_), Mask(Capacity_-1), Head(0), Tail(0) {
+			EAssertR(Capacity > 0 && (Capacity & Mask) == 0, "Queue capacity must be a power of two.");
+			ValV = new TVal[Capacity];
+		}
+		~TSpscQueue() { delete [] ValV; }
+		bool Push(const TVal& Val) { // producer only
+			const uint64 CrrTail = Tail.load(std::memory_order_relaxed);
+			if (CrrTail-Head.load(std::memory_order_acquire) == (uint64)Capacity) { return false; }
+			ValV[CrrTail & Mask] = Val;
+			Tail.store(CrrTail+1, std::memory_order_release);
+			return true;
+		}
+		bool Pop(TVal& Val) { // consumer only
+			const uint64 CrrHead = Head.load(std::memory_order_relaxed);
+			if (CrrHead == Tail.load(std::memory_order_acquire)) { return false; }
+			Val = ValV[CrrHead & Mask];
+			ValV[CrrHead & Mask] = TVal(); // release the reference early
+			Head.store(CrrHead+1, std::memory_order_release);
+			return true;
+		}
+		inline bool Empty() const {
+			return Head.load(std::memory_order_acquire) == Tail.load(std::memory_order_acquire);
+		}
+		inline int Len() const {
+			return (int)(Tail.load(std::memory_order_acquire)-Head.load(std::memory_order_acquire));
+		}
+	private:
+		TSpscQueue(const TSpscQueue&);
+		TSpscQueue& operator=(const TSpscQueue&);
+	private:
+		const int Capacity;
+		const uint64 Mask;
+		TVal* ValV;
+		alignas(64) std::atomic<uint64> Head; // producer and consumer indices live on separate cache lines
+		alignas(64) std::atomic<uint64> Tail;
+	};
+
+	// Examples are shared between the workers read-only; every tree learns from its own copy, made only if its Poisson
+	// weight is not zero, because PExample reference counts are not thread-safe and trees set leaf and bin IDs of examples
+	typedef std::shared_ptr<const TExample> TShExample;
+
+	///////////////////////////////
+	// Ensemble-Member
+	ClassTP(TEnsTree, PEnsTree) // {
+	public:
+		static PEnsTree New(PHoeffdingTree Tree, const int& Seed) { return new TEnsTree(Tree, Seed); }
+	private:
+		TEnsTree(PHoeffdingTree Tree_, const int& Seed)
+			: Tree(Tree_), Queue(4096), BusyP(false), PushedN(0), DoneN(0), Rnd(Seed) { }
+	public:
+		PHoeffdingTree Tree;
+		TSpscQueue<TShExample> Queue; // examples waiting to be learned
+		std::atomic<bool> BusyP; // set while some worker drains the queue; ensures trees learn in stream order
+		uint64 PushedN; // examples pushed so far (producer only)
+		std::atomic<uint64> DoneN; // examples learned so far
+		TRnd Rnd; // Poisson weights
+	};
+
+	///////////////////////////////
+	// Hoeffding-Tree-Ensemble
+	// Online bagging [Oza and Russell, 2001]; each tree learns every example k ~ Poisson(Lambda) times.
+	// Worker threads prefer their own trees and steal idle trees from other workers when they run dry; with nothing
+	// to learn they sleep until the next example. An error on a worker is thrown from the next call on the ensemble.
+	ClassTP(THoeffdingEnsemble, PHoeffdingEnsemble) // {
+	public:
+		THoeffdingEnsemble(const TStr& ConfigNm, const int& TreesN, const int& GracePeriod, const double& SplitConfidence,
+			const double& TieBreaking, const int& DriftCheck, const int& WindowSize, const double& Lambda_,
+			const int& SubspaceN, const int& ThreadsN, const int& Seed);
+		static PHoeffdingEnsemble New(const TStr& ConfigNm, const int& TreesN, const int& GracePeriod, const double& SplitConfidence,
+			const double& TieBreaking, const int& DriftCheck = 100, const int& WindowSize = 10000, const double& Lambda = 1.0,
+			const int& SubspaceN = 0, const int& ThreadsN = 0, const int& Seed = 1) {
+			return new THoeffdingEnsemble(ConfigNm, TreesN, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize,
+				Lambda, SubspaceN, ThreadsN, Seed);
+		}
+		~THoeffdingEnsemble();
+		// Lines are parsed with THoeffdingTree::Parse, which does not touch the profiler that a worker may be updating
+		void Process(const TStr& Line, const TCh& Delimiter = ',') {
+			Process(TreeV[0]->Tree->Parse(Line, Delimiter));
+		}
+		void Process(PExample Example); // fan the example out to all trees
+		// NOTE: Predictions wait until the trees learned all queued examples
+		TLabel Classify(PExample Example); // majority vote
+		inline TLabel Classify(const TStr& Line, const TCh& Delimiter = ',') {
+			return Classify(TreeV[0]->Tree->Parse(Line, Delimiter));
+		}
+		double Predict(PExample Example); // average
+		inline double Predict(const TStr& Line, const TCh& Delimiter = ',') {
+			return Predict(TreeV[0]->Tree->Parse(Line, Delimiter));
+		}
+		void Flush(); // block until all queued examples are learned; throws the first error of a worker
+		void SetAdaptive(const TDriftMode& DriftMode); // call before the first example
+		inline int GetTreesN() const { return TreeV.Len(); }
+		inline PHoeffdingTree GetTree(const int& TreeN) const { return TreeV[TreeN]->Tree; }
+	private:
+		void Work(const int& WorkerN); // worker thread loop
+		bool Drain(TEnsTree* EnsTree); // learn queued examples of a single tree; returns false if the tree was busy or idle
+		bool IsWorkReady() const; // some tree has examples and no worker
+		void WakeWorkers(); // after examples were queued
+		void WakeWaiters(); // after examples were learned
+		void CheckErr();
+		static int GetPoissonDev(TRnd& Rnd, const double& Lambda);
+	private:
+		TVec<PEnsTree> TreeV;
+		std::vector<std::thread> WorkerV;
+		std::atomic<bool> StopP;
+		std::mutex WaitMutex;
+		std::condition_variable WorkCond; // idle workers wait for examples
+		std::condition_variable DoneCond; // the producer waits for room in a queue or for the trees to catch up
+		std::atomic<int> IdleN; // workers waiting on WorkCond; examples are only signaled if some worker sleeps
+		std::atomic<int> WaitN; // threads waiting on DoneCond
+		std::atomic<bool> ErrP;
+		TStr ErrStr; // first error of a worker; guarded by WaitMutex
+		const double Lambda; // Poisson parameter; 1 gives bootstrap replicates
+		const int ThreadsN;
+	};
+} // namespace TDatastream
+
+#endif
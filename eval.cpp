@@ -0,0 +1,81 @@
+#include "eval.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Prequential-Evaluator
+	TPreqEval::TPreqEval(const bool& ClsP_, const int& LabelsN, const double& FadingFactor_, const int& WindowN_,
+		const int& ReportEvery_, const TStr& CurveFNm)
+		: ClsP(ClsP_), FadingFactor(FadingFactor_), WindowN(WindowN_), ReportEvery(ReportEvery_), ExamplesN(0),
+		FadingLoss(0.0), FadingSqLoss(0.0), FadingN(0.0), WindowLen(0), WindowPos(0), WindowCorrectN(0), WindowLoss(0.0), WindowSqLoss(0.0) {
+		EAssertR(FadingFactor > 0.0 && FadingFactor <= 1.0, "Fading factor must lie in (0,1].");
+		EAssertR(WindowN > 0 && ReportEvery >= 0, "Window must be positive and report period nonnegative.");
+		if (ClsP) {
+			LabelPrV.Gen(WindowN);
+			TrueCountV.Gen(LabelsN); TrueCountV.PutAll(0);
+			PredCountV.Gen(LabelsN); PredCountV.PutAll(0);
+		} else {
+			ErrV.Gen(WindowN);
+		}
+		if (!CurveFNm.Empty()) {
+			CurveOut = TFOut::New(CurveFNm);
+			CurveOut->PutStrLn(ClsP ? "examples\terr\twindow-err\tkappa\tnodes\tmem-kb" : "examples\tmae\trmse\twindow-mae\twindow-rmse\tnodes\tmem-kb");
+		}
+	}
+	void TPreqEval::AddCls(const int& TrueLabel, const int& PredLabel) {
+		const double Loss = TrueLabel == PredLabel ? 0.0 : 1.0;
+		FadingLoss = FadingFactor*FadingLoss+Loss;
+		FadingN = FadingFactor*FadingN+1.0;
+		if (WindowLen == WindowN) { // drop the oldest example
+			const TIntPr& OldPr = LabelPrV[WindowPos];
+			WindowCorrectN -= OldPr.Val1 == OldPr.Val2;
+			--TrueCountV[OldPr.Val1]; --PredCountV[OldPr.Val2];
+		} else { ++WindowLen; }
+		LabelPrV[WindowPos] = TIntPr(TrueLabel, PredLabel);
+		WindowCorrectN += TrueLabel == PredLabel;
+		++TrueCountV[TrueLabel]; ++PredCountV[PredLabel];
+		WindowPos = (WindowPos+1) % WindowN;
+		++ExamplesN;
+	}
+	void TPreqEval::AddReg(const double& TrueVal, const double& PredVal) {
+		const double Err = TrueVal-PredVal;
+		FadingLoss = FadingFactor*FadingLoss+TFlt::Abs(Err);
+		FadingSqLoss = FadingFactor*FadingSqLoss+Err*Err;
+		FadingN = FadingFactor*FadingN+1.0;
+		if (WindowLen == WindowN) {
+			const double OldErr = ErrV[WindowPos];
+			WindowLoss -= TFlt::Abs(OldErr); WindowSqLoss -= OldErr*OldErr;
+		} else { ++WindowLen; }
+		ErrV[WindowPos] = Err;
+		WindowLoss += TFlt::Abs(Err); WindowSqLoss += Err*Err;
+		WindowPos = (WindowPos+1) % WindowN;
+		++ExamplesN;
+	}
+	// kappa = (p0-pc)/(1-pc), where p0 is the accuracy and pc the accuracy of a random classifier with the same label frequencies
+	double TPreqEval::GetKappa() const {
+		if (WindowLen == 0) { return 0.0; }
+		double Pc = 0.0;
+		for (int LabelN = 0; LabelN < TrueCountV.Len(); ++LabelN) {
+			Pc += (1.0*TrueCountV[LabelN]/WindowLen)*(1.0*PredCountV[LabelN]/WindowLen);
+		}
+		const double P0 = GetWindowAcc();
+		return Pc < 1.0 ? (P0-Pc)/(1.0-Pc) : 0.0;
+	}
+	void TPreqEval::Report(const int& NodesN, const uint64& MemUsed) {
+		if (CurveOut.Empty()) { return; }
+		if (ClsP) {
+			CurveOut->PutStrLn(TStr::Fmt("%s\t%.6f\t%.6f\t%.6f\t%d\t%s", TUInt64::GetStr(ExamplesN).CStr(), 1.0-GetFadingAcc(),
+				1.0-GetWindowAcc(), GetKappa(), NodesN, TUInt64::GetStr(MemUsed/1024).CStr()));
+		} else {
+			CurveOut->PutStrLn(TStr::Fmt("%s\t%.6f\t%.6f\t%.6f\t%.6f\t%d\t%s", TUInt64::GetStr(ExamplesN).CStr(), GetFadingMae(),
+				GetFadingRmse(), GetWindowMae(), GetWindowRmse(), NodesN, TUInt64::GetStr(MemUsed/1024).CStr()));
+		}
+	}
+	TStr TPreqEval::GetStr() const {
+		if (ClsP) {
+			return TStr::Fmt("examples = %s; accuracy = %.4f (fading), %.4f (window); kappa = %.4f", TUInt64::GetStr(ExamplesN).CStr(),
+				GetFadingAcc(), GetWindowAcc(), GetKappa());
+		}
+		return TStr::Fmt("examples = %s; MAE = %.4f (fading), %.4f (window); RMSE = %.4f (fading), %.4f (window)", TUInt64::GetStr(ExamplesN).CStr(),
+			GetFadingMae(), GetWindowMae(), GetFadingRmse(), GetWindowRmse());
+	}
+} // namespace TDatastream
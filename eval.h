@@ -0,0 +1,62 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include <base.h>
+
+namespace TDatastream {
+	///////////////////////////////
+	// Prequential-Evaluator
+	// Test-then-train evaluation; see `On Evaluating Stream Learning Algorithms' [Gama et al., 2013].
+	// Every example costs O(1): fading-factor estimates are updated in place and the sliding window keeps
+	// running sums. Classification tracks accuracy and Cohen's kappa, regression tracks MAE and RMSE.
+	// Every ReportEvery examples a learning-curve row goes to CurveFNm, which stays open for the whole run.
+	ClassTP(TPreqEval, PPreqEval) // {
+	public:
+		TPreqEval(const bool& ClsP_, const int& LabelsN, const double& FadingFactor_, const int& WindowN_,
+			const int& ReportEvery_, const TStr& CurveFNm);
+		static PPreqEval New(const bool& ClsP, const int& LabelsN, const double& FadingFactor = 0.9995, const int& WindowN = 1000,
+			const int& ReportEvery = 1000, const TStr& CurveFNm = TStr()) {
+			return new TPreqEval(ClsP, LabelsN, FadingFactor, WindowN, ReportEvery, CurveFNm);
+		}
+		~TPreqEval() { if (!CurveOut.Empty()) { CurveOut->Flush(); } }
+		void AddCls(const int& TrueLabel, const int& PredLabel); // classification
+		void AddReg(const double& TrueVal, const double& PredVal); // regression
+		inline bool IsReportDue() const { return ReportEvery > 0 && ExamplesN > 0 && ExamplesN % ReportEvery == 0; }
+		void Report(const int& NodesN, const uint64& MemUsed); // append a learning-curve row
+		inline uint64 GetExamplesN() const { return ExamplesN; }
+		// classification
+		inline double GetFadingAcc() const { return FadingN > 0.0 ? 1.0-FadingLoss/FadingN : 0.0; }
+		inline double GetWindowAcc() const { return WindowLen > 0 ? 1.0*WindowCorrectN/WindowLen : 0.0; }
+		double GetKappa() const; // over the sliding window
+		// regression
+		inline double GetFadingMae() const { return FadingN > 0.0 ? FadingLoss/FadingN : 0.0; }
+		inline double GetFadingRmse() const { return FadingN > 0.0 ? TMath::Sqrt(FadingSqLoss/FadingN) : 0.0; }
+		inline double GetWindowMae() const { return WindowLen > 0 ? WindowLoss/WindowLen : 0.0; }
+		inline double GetWindowRmse() const { return WindowLen > 0 ? TMath::Sqrt(TMath::Mx<double>(0.0, WindowSqLoss)/WindowLen) : 0.0; }
+		// fading-factor error rate for classification, MAE for regression
+		inline double GetFadingErr() const { return ClsP ? 1.0-GetFadingAcc() : GetFadingMae(); }
+		TStr GetStr() const;
+	private:
+		const bool ClsP;
+		const double FadingFactor;
+		const int WindowN;
+		const int ReportEvery;
+		uint64 ExamplesN;
+		double FadingLoss; // 0/1 loss for classification, absolute error for regression
+		double FadingSqLoss;
+		double FadingN;
+		// sliding window; a ring of the last WindowN examples
+		int WindowLen;
+		int WindowPos; // next slot
+		TIntPrV LabelPrV; // (true, predicted) labels
+		TFltV ErrV; // signed errors
+		int WindowCorrectN;
+		double WindowLoss;
+		double WindowSqLoss;
+		TIntV TrueCountV; // label counts in the window; needed for kappa
+		TIntV PredCountV;
+		PSOut CurveOut;
+	};
+} // namespace TDatastream
+
+#endif
@@ -0,0 +1,254 @@
+#include "generator.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Synthetic-Stream-Generator
+	// Attributes with ValsN = 0 are numeric; others are discrete with values 0..ValsN-1
+	void TStreamGen::SaveConfig(const TStr& FNm, const TStrV& NmV, const TIntV& ValsNV) {
+		EAssertR(NmV.Len() == ValsNV.Len(), "Each attribute needs its number of values.");
+		TFOut FOut(FNm);
+		TChA FormatChA = "dataFormat: (";
+		for (int AttrN = 0; AttrN < NmV.Len(); ++AttrN) {
+			if (AttrN > 0) { FormatChA += ","; }
+			FormatChA += NmV.GetVal(AttrN);
+		}
+		FormatChA += ")";
+		FOut.PutStrLn(FormatChA);
+		for (int AttrN = 0; AttrN < NmV.Len(); ++AttrN) {
+			const int ValsN = ValsNV.GetVal(AttrN);
+			if (ValsN == 0) {
+				FOut.PutStrFmtLn("%s: numeric", NmV.GetVal(AttrN).CStr());
+				continue;
+			}
+			// NOTE: The parser treats single-valued attributes as numeric
+			EAssertR(ValsN > 1, "Discrete attributes need at least two values.");
+			TChA ValsChA;
+			for (int ValN = 0; ValN < ValsN; ++ValN) {
+				if (ValN > 0) { ValsChA += ","; }
+				ValsChA += TInt::GetStr(ValN);
+			}
+			FOut.PutStrFmtLn("%s: discrete(%s)", NmV.GetVal(AttrN).CStr(), ValsChA.CStr());
+		}
+		FOut.Flush();
+	}
+
+	///////////////////////////////
+	// SEA-Concepts
+	void TSeaGen::SaveConfig(const TStr& FNm) const {
+		TStrV NmV; NmV.Add("a1"); NmV.Add("a2"); NmV.Add("a3"); NmV.Add("c");
+		TIntV ValsNV; ValsNV.Add(0); ValsNV.Add(0); ValsNV.Add(0); ValsNV.Add(2);
+		TStreamGen::SaveConfig(FNm, NmV, ValsNV);
+	}
+	PExample TSeaGen::Gen() {
+		static const double ThetaV[] = { 8.0, 9.0, 7.0, 9.5 };
+		TAttributeV AttributesV(3, 0);
+		double X1 = 0.0, X2 = 0.0;
+		for (int AttrN = 0; AttrN < 3; ++AttrN) {
+			const double X = 10.0*Rnd.GetUniDev();
+			if (AttrN == 0) { X1 = X; } else if (AttrN == 1) { X2 = X; }
+			AttributesV.Add(TAttribute(AttrN, X));
+		}
+		const TLabel Label = X1+X2 <= ThetaV[ConceptN] ? 1 : 0;
+		return TExample::New(AttributesV, (int) AddNoise(Label, 2));
+	}
+
+	///////////////////////////////
+	// Rotating-Hyperplane
+	THyperplaneGen::THyperplaneGen(const int& AttrsN, const int& DriftAttrsN_, const double& Magnitude_, const int& DriftPeriod,
+		const double& Noise, const int& Seed)
+		: TStreamGen(DriftPeriod, Noise, Seed), DriftAttrsN(DriftAttrsN_), Magnitude(Magnitude_) {
+		EAssertR(AttrsN > 0 && DriftAttrsN >= 0 && DriftAttrsN <= AttrsN, "Invalid number of (drifting) attributes.");
+		WeightV.Gen(AttrsN, 0);
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) { WeightV.Add(Rnd.GetUniDev()); }
+		DirV.Gen(DriftAttrsN, 0);
+		for (int AttrN = 0; AttrN < DriftAttrsN; ++AttrN) { DirV.Add(Rnd.GetUniDev() < 0.5 ? -1.0 : 1.0); }
+	}
+	void THyperplaneGen::SaveConfig(const TStr& FNm) const {
+		TStrV NmV; TIntV ValsNV;
+		for (int AttrN = 0; AttrN < WeightV.Len(); ++AttrN) {
+			NmV.Add("a" + TInt::GetStr(AttrN+1)); ValsNV.Add(0);
+		}
+		NmV.Add("c"); ValsNV.Add(2);
+		TStreamGen::SaveConfig(FNm, NmV, ValsNV);
+	}
+	PExample THyperplaneGen::Gen() {
+		const int AttrsN = WeightV.Len();
+		TAttributeV AttributesV(AttrsN, 0);
+		double Sum = 0.0, W0 = 0.0;
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			const double X = Rnd.GetUniDev();
+			Sum += WeightV[AttrN]*X;
+			W0 += WeightV[AttrN];
+			AttributesV.Add(TAttribute(AttrN, X));
+		}
+		const TLabel Label = Sum >= 0.5*W0 ? 1 : 0;
+		// Incremental drift
+		for (int AttrN = 0; AttrN < DriftAttrsN; ++AttrN) {
+			WeightV[AttrN] += DirV[AttrN]*Magnitude;
+			if (Rnd.GetUniDev() < 0.1) { DirV[AttrN] = -DirV[AttrN]; }
+		}
+		return TExample::New(AttributesV, (int) AddNoise(Label, 2));
+	}
+	void THyperplaneGen::Drift() { // abrupt drift: new random weights
+		for (int AttrN = 0; AttrN < WeightV.Len(); ++AttrN) { WeightV[AttrN] = Rnd.GetUniDev(); }
+	}
+
+	///////////////////////////////
+	// Random-Tree
+	TRandomTreeGen::TRandomTreeGen(const int& AttrsN_, const int& ValsN_, const int& LabelsN_, const int& MxDepth_,
+		const int& DriftPeriod, const double& Noise, const int& Seed)
+		: TStreamGen(DriftPeriod, Noise, Seed), AttrsN(AttrsN_), ValsN(ValsN_), LabelsN(LabelsN_), MxDepth(MxDepth_) {
+		EAssertR(AttrsN > 0 && ValsN > 1 && LabelsN > 1 && MxDepth > 0, "Invalid random tree parameters.");
+		GenTree();
+	}
+	void TRandomTreeGen::SaveConfig(const TStr& FNm) const {
+		TStrV NmV; TIntV ValsNV;
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			NmV.Add("a" + TInt::GetStr(AttrN+1)); ValsNV.Add(ValsN);
+		}
+		NmV.Add("c"); ValsNV.Add(LabelsN);
+		TStreamGen::SaveConfig(FNm, NmV, ValsNV);
+	}
+	void TRandomTreeGen::GenTree() {
+		AttrV.Clr(); FstChildV.Clr(); ChildV.Clr();
+		TIntV UsedAttrV;
+		GenNode(0, UsedAttrV);
+	}
+	// Each attribute is tested at most once on a path; nodes below MxDepth/2 become leaves with probability 0.15
+	int TRandomTreeGen::GenNode(const int& Depth, TIntV& UsedAttrV) {
+		const int NodeN = AttrV.Add(-1);
+		FstChildV.Add(0);
+		const bool LeafP = Depth >= MxDepth || UsedAttrV.Len() == AttrsN ||
+			(Depth >= MxDepth/2 && Rnd.GetUniDev() < 0.15);
+		if (LeafP) {
+			FstChildV[NodeN] = Rnd.GetUniDevInt(LabelsN);
+			return NodeN;
+		}
+		int AttrN;
+		do { AttrN = Rnd.GetUniDevInt(AttrsN); } while (UsedAttrV.IsIn(AttrN));
+		AttrV[NodeN] = AttrN;
+		const int FstChildN = ChildV.Len();
+		FstChildV[NodeN] = FstChildN;
+		for (int ValN = 0; ValN < ValsN; ++ValN) { ChildV.Add(-1); }
+		UsedAttrV.Add(AttrN);
+		for (int ValN = 0; ValN < ValsN; ++ValN) {
+			const int ChildN = GenNode(Depth+1, UsedAttrV);
+			ChildV[FstChildN+ValN] = ChildN;
+		}
+		UsedAttrV.DelLast();
+		return NodeN;
+	}
+	PExample TRandomTreeGen::Gen() {
+		TAttributeV AttributesV(AttrsN, 0);
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			AttributesV.Add(TAttribute(AttrN, (int) Rnd.GetUniDevInt(ValsN)));
+		}
+		int NodeN = 0;
+		while (AttrV[NodeN] != -1) {
+			NodeN = ChildV[FstChildV[NodeN]+AttributesV[AttrV[NodeN]].Value];
+		}
+		return TExample::New(AttributesV, (int) AddNoise(FstChildV[NodeN], LabelsN));
+	}
+
+	///////////////////////////////
+	// Random-Radial-Basis-Function
+	TRandomRbfGen::TRandomRbfGen(const int& AttrsN_, const int& LabelsN_, const int& CentroidsN, const double& Speed_,
+		const int& DriftPeriod, const int& Seed)
+		: TStreamGen(DriftPeriod, 0.0, Seed), AttrsN(AttrsN_), LabelsN(LabelsN_), Speed(Speed_) {
+		EAssertR(AttrsN > 0 && LabelsN > 1 && CentroidsN > 0, "Invalid random RBF parameters.");
+		double SumWeight = 0.0;
+		for (int CentroidN = 0; CentroidN < CentroidsN; ++CentroidN) {
+			TFltV CenterV_(AttrsN, 0), DirV(AttrsN, 0);
+			double Norm = 0.0;
+			for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+				CenterV_.Add(Rnd.GetUniDev());
+				DirV.Add(Rnd.GetNrmDev());
+				Norm += DirV.Last()*DirV.Last();
+			}
+			Norm = sqrt(Norm);
+			for (int AttrN = 0; AttrN < AttrsN; ++AttrN) { DirV[AttrN] /= Norm; }
+			CenterV.Add(CenterV_);
+			SpeedV.Add(DirV);
+			LabelV.Add(Rnd.GetUniDevInt(LabelsN));
+			StdDevV.Add(Rnd.GetUniDev());
+			SumWeight += Rnd.GetUniDev();
+			CumWeightV.Add(SumWeight);
+		}
+	}
+	void TRandomRbfGen::SaveConfig(const TStr& FNm) const {
+		TStrV NmV; TIntV ValsNV;
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			NmV.Add("a" + TInt::GetStr(AttrN+1)); ValsNV.Add(0);
+		}
+		NmV.Add("c"); ValsNV.Add(LabelsN);
+		TStreamGen::SaveConfig(FNm, NmV, ValsNV);
+	}
+	PExample TRandomRbfGen::Gen() {
+		// Pick a centroid with probability proportional to its weight
+		const double W = CumWeightV.Last()*Rnd.GetUniDev();
+		int CentroidN = 0;
+		while (CentroidN < CumWeightV.Len()-1 && CumWeightV[CentroidN] < W) { ++CentroidN; }
+		// Random direction, random distance from the centroid
+		TFltV OffV(AttrsN, 0);
+		double Norm = 0.0;
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			OffV.Add(2.0*Rnd.GetUniDev()-1.0);
+			Norm += OffV.Last()*OffV.Last();
+		}
+		const double Scale = Rnd.GetNrmDev()*StdDevV[CentroidN]/(Norm > 0.0 ? sqrt(Norm) : 1.0);
+		TAttributeV AttributesV(AttrsN, 0);
+		const TFltV& Center = CenterV[CentroidN];
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			AttributesV.Add(TAttribute(AttrN, Center[AttrN]+OffV[AttrN]*Scale));
+		}
+		// Move the centroids; they bounce off the edges of the unit cube
+		if (Speed > 0.0) {
+			for (int CrrCentroidN = 0; CrrCentroidN < CenterV.Len(); ++CrrCentroidN) {
+				TFltV& CrrCenter = CenterV[CrrCentroidN];
+				TFltV& DirV = SpeedV[CrrCentroidN];
+				for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+					CrrCenter[AttrN] += DirV[AttrN]*Speed;
+					if (CrrCenter[AttrN] < 0.0 || CrrCenter[AttrN] > 1.0) {
+						DirV[AttrN] = -DirV[AttrN];
+						CrrCenter[AttrN] += 2.0*DirV[AttrN]*Speed;
+					}
+				}
+			}
+		}
+		return TExample::New(AttributesV, (int) LabelV[CentroidN]);
+	}
+	void TRandomRbfGen::Drift() {
+		for (int CentroidN = 0; CentroidN < LabelV.Len(); ++CentroidN) {
+			LabelV[CentroidN] = Rnd.GetUniDevInt(LabelsN);
+		}
+	}
+
+	///////////////////////////////
+	// Friedman-Regression
+	TFriedmanGen::TFriedmanGen(const int& DriftPeriod, const double& Noise, const int& Seed)
+		: TStreamGen(DriftPeriod, Noise, Seed) {
+		for (int AttrN = 0; AttrN < 5; ++AttrN) { PermV.Add(AttrN); }
+	}
+	void TFriedmanGen::SaveConfig(const TStr& FNm) const {
+		TStrV NmV; TIntV ValsNV;
+		for (int AttrN = 0; AttrN < 10; ++AttrN) {
+			NmV.Add("x" + TInt::GetStr(AttrN+1)); ValsNV.Add(0);
+		}
+		NmV.Add("y"); ValsNV.Add(0);
+		TStreamGen::SaveConfig(FNm, NmV, ValsNV);
+	}
+	PExample TFriedmanGen::Gen() {
+		TAttributeV AttributesV(10, 0);
+		double X[10];
+		for (int AttrN = 0; AttrN < 10; ++AttrN) {
+			X[AttrN] = Rnd.GetUniDev();
+			AttributesV.Add(TAttribute(AttrN, X[AttrN]));
+		}
+		const double X1 = X[PermV[0]], X2 = X[PermV[1]], X3 = X[PermV[2]], X4 = X[PermV[3]], X5 = X[PermV[4]];
+		const double Y = 10.0*sin(TMath::Pi*X1*X2)+20.0*(X3-0.5)*(X3-0.5)+10.0*X4+5.0*X5+Noise*Rnd.GetNrmDev();
+		return TExample::New(AttributesV, Y);
+	}
+	void TFriedmanGen::Drift() { // relevant attributes trade places
+		PermV.Shuffle(Rnd);
+	}
+} // namespace TDatastream
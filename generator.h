@@ -0,0 +1,160 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "hoeffding.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Synthetic-Stream-Generator
+	// Generates encoded examples directly in memory, without going through text; SaveConfig writes
+	// the matching configuration file, so the learner can be created for the generator's schema.
+	// Every DriftPeriod examples (0 for never) the generator changes its concept.
+	ClassTP(TStreamGen, PStreamGen) // {
+	public:
+		TStreamGen(const int& DriftPeriod_, const double& Noise_, const int& Seed)
+			: DriftPeriod(DriftPeriod_), Noise(Noise_), ExamplesN(0), Rnd(Seed) { }
+		virtual ~TStreamGen() { }
+		PExample Next() {
+			if (DriftPeriod > 0 && ExamplesN > 0 && ExamplesN % DriftPeriod == 0) { Drift(); }
+			++ExamplesN;
+			return Gen();
+		}
+		virtual void SaveConfig(const TStr& FNm) const = 0;
+		virtual TStr GetNm() const = 0;
+		inline uint64 GetExamplesN() const { return ExamplesN; }
+	protected:
+		virtual PExample Gen() = 0;
+		virtual void Drift() = 0; // abrupt concept change
+		// Helpers for writing config files
+		static void SaveConfig(const TStr& FNm, const TStrV& NmV, const TIntV& ValsNV);
+		inline TLabel AddNoise(const TLabel& Label, const int& LabelsN) {
+			return Rnd.GetUniDev() < Noise ? TLabel(Rnd.GetUniDevInt(LabelsN)) : Label;
+		}
+	protected:
+		const int DriftPeriod;
+		const double Noise; // probability of a random label for classification; standard deviation for regression
+		uint64 ExamplesN;
+		TRnd Rnd;
+	};
+
+	///////////////////////////////
+	// SEA-Concepts
+	// Three attributes from [0,10]; label is a1+a2 <= Theta [Street and Kim, 2001]
+	class TSeaGen : public TStreamGen {
+	public:
+		static PStreamGen New(const int& DriftPeriod = 0, const double& Noise = 0.1, const int& Seed = 1) {
+			return new TSeaGen(DriftPeriod, Noise, Seed);
+		}
+		void SaveConfig(const TStr& FNm) const;
+		TStr GetNm() const { return "sea"; }
+	protected:
+		TSeaGen(const int& DriftPeriod, const double& Noise, const int& Seed)
+			: TStreamGen(DriftPeriod, Noise, Seed), ConceptN(0) { }
+		PExample Gen();
+		void Drift() { ConceptN = (ConceptN+1) % 4; }
+	private:
+		int ConceptN;
+	};
+
+	///////////////////////////////
+	// Rotating-Hyperplane
+	// Label is w'x >= w0 where w0 = sum(w)/2; the first DriftAttrsN weights move by Magnitude per example
+	// and change direction with probability 0.1 [Hulten et al., 2001]
+	class THyperplaneGen : public TStreamGen {
+	public:
+		static PStreamGen New(const int& AttrsN = 10, const int& DriftAttrsN = 2, const double& Magnitude = 0.001,
+			const int& DriftPeriod = 0, const double& Noise = 0.05, const int& Seed = 1) {
+			return new THyperplaneGen(AttrsN, DriftAttrsN, Magnitude, DriftPeriod, Noise, Seed);
+		}
+		void SaveConfig(const TStr& FNm) const;
+		TStr GetNm() const { return "hyperplane"; }
+	protected:
+		THyperplaneGen(const int& AttrsN, const int& DriftAttrsN_, const double& Magnitude_, const int& DriftPeriod,
+			const double& Noise, const int& Seed);
+		PExample Gen();
+		void Drift();
+	private:
+		TFltV WeightV;
+		TFltV DirV; // +1 or -1 for each drifting weight
+		const int DriftAttrsN;
+		const double Magnitude;
+	};
+
+	///////////////////////////////
+	// Random-Tree
+	// Discrete attributes; label is given by a random decision tree [Domingos and Hulten, 2000];
+	// drift replaces the tree with a new random one
+	class TRandomTreeGen : public TStreamGen {
+	public:
+		static PStreamGen New(const int& AttrsN = 10, const int& ValsN = 5, const int& LabelsN = 2, const int& MxDepth = 5,
+			const int& DriftPeriod = 0, const double& Noise = 0.0, const int& Seed = 1) {
+			return new TRandomTreeGen(AttrsN, ValsN, LabelsN, MxDepth, DriftPeriod, Noise, Seed);
+		}
+		void SaveConfig(const TStr& FNm) const;
+		TStr GetNm() const { return "randomtree"; }
+	protected:
+		TRandomTreeGen(const int& AttrsN_, const int& ValsN_, const int& LabelsN_, const int& MxDepth_, const int& DriftPeriod,
+			const double& Noise, const int& Seed);
+		PExample Gen();
+		void Drift() { GenTree(); }
+	private:
+		void GenTree();
+		int GenNode(const int& Depth, TIntV& UsedAttrV);
+	private:
+		const int AttrsN;
+		const int ValsN;
+		const int LabelsN;
+		const int MxDepth;
+		TIntV AttrV; // attribute tested by the node; -1 for leaves
+		TIntV FstChildV; // index of the first child in ChildV; the label for leaves
+		TIntV ChildV;
+	};
+
+	///////////////////////////////
+	// Random-Radial-Basis-Function
+	// Examples are drawn around random centroids, each with its own label, spread, and weight;
+	// centroids move by Speed per example [Bifet et al., 2009]
+	class TRandomRbfGen : public TStreamGen {
+	public:
+		static PStreamGen New(const int& AttrsN = 10, const int& LabelsN = 2, const int& CentroidsN = 50, const double& Speed = 0.0,
+			const int& DriftPeriod = 0, const int& Seed = 1) {
+			return new TRandomRbfGen(AttrsN, LabelsN, CentroidsN, Speed, DriftPeriod, Seed);
+		}
+		void SaveConfig(const TStr& FNm) const;
+		TStr GetNm() const { return "rbf"; }
+	protected:
+		TRandomRbfGen(const int& AttrsN_, const int& LabelsN_, const int& CentroidsN, const double& Speed_, const int& DriftPeriod, const int& Seed);
+		PExample Gen();
+		void Drift(); // relabel the centroids
+	private:
+		const int AttrsN;
+		const int LabelsN;
+		const double Speed;
+		TVec<TFltV> CenterV;
+		TVec<TFltV> SpeedV; // direction of the movement of each centroid
+		TIntV LabelV;
+		TFltV StdDevV;
+		TFltV CumWeightV; // cumulative weights for sampling the centroids
+	};
+
+	///////////////////////////////
+	// Friedman-Regression
+	// y = 10 sin(pi x1 x2) + 20 (x3 - 0.5)^2 + 10 x4 + 5 x5 + N(0, Noise); x6..x10 are irrelevant [Friedman, 1991];
+	// drift permutes the relevant attributes, as in the global abrupt drift of [Ikonomovska et al., 2011]
+	class TFriedmanGen : public TStreamGen {
+	public:
+		static PStreamGen New(const int& DriftPeriod = 0, const double& Noise = 1.0, const int& Seed = 1) {
+			return new TFriedmanGen(DriftPeriod, Noise, Seed);
+		}
+		void SaveConfig(const TStr& FNm) const;
+		TStr GetNm() const { return "friedman"; }
+	protected:
+		TFriedmanGen(const int& DriftPeriod, const double& Noise, const int& Seed);
+		PExample Gen();
+		void Drift();
+	private:
+		TIntV PermV; // which attribute plays the role of x1, x2, ..., x5
+	};
+} // namespace TDatastream
+
+#endif
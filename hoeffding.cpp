@@ -15,6 +15,20 @@ namespace TDatastream {
 			SndV[ElN] += Scalar*FstV[ElN];
 		}
 	}
+	void TMisc::AddVec(const int& Scalar, const TCountV& FstV, TVec<int64>& SndV) {
+		while (SndV.Len() < FstV.Len()) { SndV.Add(0); }
+		for (int ElN = 0; ElN < FstV.Len(); ++ElN) {
+			SndV[ElN] += Scalar*FstV[ElN];
+		}
+	}
+	double TMisc::Gini(const TVec<int64>& FreqV, const int64& N) {
+		double g = 1.0, p = 0.0;
+		for (int ElN = 0; ElN < FreqV.Len(); ++ElN) {
+			p = N > 0 ? 1.0*FreqV[ElN]/N : 0.0;
+			g -= p*p;
+		}
+		return g;
+	}
 	double TMisc::Entropy(const TIntV& FreqV, const int& N) {
 		double h = 0.0, p = 0.0;
 		for (auto It = FreqV.BegI(); It != FreqV.EndI(); ++It) {
@@ -23,6 +37,140 @@ namespace TDatastream {
 		}
 		return h;
 	}
+	double TMisc::Entropy(const TVec<int64>& FreqV, const int64& N) {
+		double h = 0.0, p = 0.0;
+		for (int ElN = 0; ElN < FreqV.Len(); ++ElN) {
+			p = N > 0 ? 1.0*FreqV[ElN]/N : 0.0;
+			if (p > 0) { h -= p*TMath::Log2(p); }
+		}
+		return h;
+	}
+	double TMisc::Entropy(const TCountV& FreqV, const int64& N) {
+		double h = 0.0, p = 0.0;
+		for (int ElN = 0; ElN < FreqV.Len(); ++ElN) {
+			p = N > 0 ? 1.0*FreqV[ElN]/N : 0.0;
+			if (p > 0) { h -= p*TMath::Log2(p); }
+		}
+		return h;
+	}
+
+	///////////////////////////////
+	// Adaptive-Width-Counters
+	TCountV::TCountV(TSIn& SIn) {
+		SIn.Load(CountsN); SIn.Load(WidthB);
+		BfV.Gen(CountsN*WidthB);
+		if (CountsN > 0) { SIn.LoadBf(BfV.BegI(), CountsN*WidthB); }
+	}
+	void TCountV::Save(TSOut& SOut) const {
+		SOut.Save(CountsN); SOut.Save(WidthB);
+		if (CountsN > 0) { SOut.SaveBf(BfV.BegI(), CountsN*WidthB); }
+	}
+	bool TCountV::operator==(const TCountV& CountV) const {
+		if (CountsN != CountV.CountsN) { return false; }
+		for (int CountN = 0; CountN < CountsN; ++CountN) {
+			if (GetVal(CountN) != CountV.GetVal(CountN)) { return false; }
+		}
+		return true;
+	}
+	void TCountV::Gen(const int& CountsN_) {
+		CountsN = CountsN_; WidthB = 1;
+		BfV.Gen(CountsN); BfV.PutAll(0);
+	}
+	void TCountV::Add(const int64& Count) {
+		for (int ByteN = 0; ByteN < WidthB; ++ByteN) { BfV.Add(0); }
+		++CountsN;
+		if (Count != 0) { Inc(CountsN-1, Count); }
+	}
+	int TCountV::GetMxValN() const {
+		int MxValN = 0;
+		for (int CountN = 1; CountN < CountsN; ++CountN) {
+			if (GetVal(CountN) > GetVal(MxValN)) { MxValN = CountN; }
+		}
+		return MxValN;
+	}
+	// From the last count down, so a count is only moved onto bytes that are already copied 
+	void TCountV::Widen(const uint64& Count) {
+		int NewWidthB = WidthB;
+		while (Count > GetMx(NewWidthB)) { NewWidthB *= 2; }
+		const int OldWidthB = WidthB;
+		BfV.Reserve(CountsN*NewWidthB);
+		for (int ByteN = CountsN*OldWidthB; ByteN < CountsN*NewWidthB; ++ByteN) { BfV.Add(0); }
+		uchar* Bf = BfV.BegI();
+		for (int CountN = CountsN-1; CountN >= 0; --CountN) { Put(Bf, NewWidthB, CountN, Get(Bf, OldWidthB, CountN)); }
+		WidthB = (char) NewWidthB;
+	}
+
+	///////////////////////////////
+	// Adaptive-Windowing-Change-Detector
+	TAdwin::TAdwin(TSIn& SIn) : RowV(SIn) {
+		SIn.Load(Delta); SIn.Load(MxBucketsN); SIn.Load(ClockN); SIn.Load(MnWinLen);
+		SIn.Load(Width); SIn.Load(Total); SIn.Load(Variance); SIn.Load(TickN);
+	}
+	void TAdwin::Save(TSOut& SOut) const {
+		RowV.Save(SOut);
+		SOut.Save(Delta); SOut.Save(MxBucketsN); SOut.Save(ClockN); SOut.Save(MnWinLen);
+		SOut.Save(Width); SOut.Save(Total); SOut.Save(Variance); SOut.Save(TickN);
+	}
+	bool TAdwin::Add(const double& Val) {
+		if (RowV.Empty()) { RowV.Add(TVec<TFltPr>()); }
+		// Update the variance incrementally; see [Knuth, 1997] 
+		if (Width > 0) { Variance += Width*TMath::Sqr(Val-Total/Width)/(Width+1); }
+		++Width; Total += Val;
+		RowV[0].Add(TFltPr(Val, 0.0));
+		Compress();
+		if (++TickN < ClockN) { return false; }
+		TickN = 0;
+		return DetectChange();
+	}
+	void TAdwin::Clr() {
+		RowV.Clr(); Width = TickN = 0; Total = Variance = 0.0;
+	}
+	void TAdwin::Compress() {
+		for (int RowN = 0; RowN < RowV.Len() && RowV[RowN].Len() > MxBucketsN; ++RowN) {
+			if (RowN+1 == RowV.Len()) { RowV.Add(TVec<TFltPr>()); }
+			// Merge the two oldest buckets and move the result one row up; see [Chan et al., 1979] for combining variances 
+			const double N = 1.0*(1 << RowN);
+			const TFltPr Fst = RowV[RowN][0], Snd = RowV[RowN][1];
+			const double Var = Fst.Val2+Snd.Val2+N*TMath::Sqr(Fst.Val1/N-Snd.Val1/N)/2.0;
+			RowV[RowN].Del(0, 1);
+			RowV[RowN+1].Add(TFltPr(Fst.Val1+Snd.Val1, Var));
+		}
+	}
+	void TAdwin::DelLast() {
+		const int RowN = RowV.Len()-1;
+		const double N = 1.0*(1 << RowN);
+		const TFltPr Bucket = RowV[RowN][0];
+		Width -= (1 << RowN); Total -= Bucket.Val1;
+		if (Width > 0) {
+			Variance -= Bucket.Val2+N*Width*TMath::Sqr(Bucket.Val1/N-Total/Width)/(N+Width);
+		} else { Variance = 0.0; }
+		RowV[RowN].Del(0);
+		if (RowV[RowN].Empty()) { RowV.DelLast(); }
+	}
+	// Drop the oldest buckets while some split of the window into W0 (older) and W1 (newer) has significantly different means 
+	bool TAdwin::DetectChange() {
+		bool ChangeP = false, ReduceP = true;
+		while (ReduceP && Width > 2*MnWinLen) {
+			ReduceP = false;
+			double N0 = 0.0, N1 = Width, S0 = 0.0, S1 = Total;
+			const double V = Variance/Width;
+			const double DD = TMath::Log(2.0*TMath::Log(Width)/Delta);
+			for (int RowN = RowV.Len()-1; !ReduceP && RowN >= 0; --RowN) {
+				const double N = 1.0*(1 << RowN);
+				for (int BucketN = 0; !ReduceP && BucketN < RowV[RowN].Len() && N1-N >= MnWinLen; ++BucketN) {
+					N0 += N; N1 -= N;
+					S0 += RowV[RowN][BucketN].Val1; S1 -= RowV[RowN][BucketN].Val1;
+					if (N0 < MnWinLen) { continue; }
+					// eps_cut = \sqrt{2 m V \ln(2\ln(W)/\delta)}+\frac{2}{3} m \ln(2\ln(W)/\delta) 
+					const double M = 1.0/(N0-MnWinLen+1)+1.0/(N1-MnWinLen+1);
+					const double Eps = TMath::Sqrt(2.0*M*V*DD)+2.0/3.0*DD*M;
+					if (TFlt::Abs(S0/N0-S1/N1) > Eps) { ReduceP = ChangeP = true; }
+				}
+			}
+			if (ReduceP) { DelLast(); }
+		}
+		return ChangeP;
+	}
 
 	///////////////////////////////
 	// Bin
@@ -44,128 +192,135 @@ namespace TDatastream {
 	bool operator!=(const TBin& Bin1, const TBin& Bin2) {
 		return !(Bin1 == Bin2);
 	}
+	TBin::TBin(TSIn& SIn) {
+		double S_, Mean_, T; // the sum follows from Count*Mean; the file keeps it for older models 
+		SIn.Load(S_); SIn.Load(Mean_); SIn.Load(T); SIn.Load(Value); SIn.Load(Count); SIn.Load(Id); PartitionV = TCountV(SIn);
+		S = S_; Mean = Mean_;
+	}
+	void TBin::Save(TSOut& SOut) const {
+		SOut.Save((double) S); SOut.Save((double) Mean); SOut.Save(GetSum()); SOut.Save(Value); SOut.Save(Count); SOut.Save(Id); PartitionV.Save(SOut);
+	}
 	double TBin::Entropy() const {
 		return TMisc::Entropy(PartitionV, Count);
 	}
+	// Regression statistics combine as in [Chan et al., 1979] 
+	void TBin::Merge(const TBin& Bin) {
+		const int64 AllN = Count+Bin.Count;
+		Value = AllN > 0 ? (1.0*Count*Value+1.0*Bin.Count*Bin.Value)/AllN : 0.5*(Value+Bin.Value);
+		while (PartitionV.Len() < Bin.PartitionV.Len()) { PartitionV.Add(0); }
+		for (int LabelN = 0; LabelN < Bin.PartitionV.Len(); ++LabelN) { PartitionV.Inc(LabelN, Bin.PartitionV[LabelN]); }
+		if (AllN > 0) {
+			const double Delta = Bin.Mean-Mean;
+			S += Bin.S+Delta*Delta*Count*Bin.Count/AllN;
+			Mean += Delta*Bin.Count/AllN;
+		}
+		Count = AllN;
+		// The older bin's ID, so that examples counted in either bin are forgotten correctly; -1 marks a bin without ID yet 
+		if (Id == -1 || (Bin.Id != -1 && Bin.Id < Id)) { Id = Bin.Id; }
+	}
 
 	///////////////////////////////
 	// Histogram
 	// Per-class distribution for examples with attribute 
 	// NOTE: This function must ensure the Example->BinId is set to the maximum ID of the bins containing the example 
 	void THist::IncCls(PExample Example, const int& AttrIdx, PIdGen IdGen) {
-		int Idx = 0, BinN = 0;
-		double CurrDist = 0.0, PrevDist = 0.0;
-		const double Val = Example->AttributesV.GetVal(AttrIdx).Num;
+		const double Val = Example->GetNum(AttrIdx);
 		const int Label = Example->Label;
-		// Add new bin, initialized with Val, if the number of bins didn't reach the treshold 
-		if ((Idx = BinsV.SearchBin(Val)) == -1 && BinsV.Len() < BinsN) {
-			const int CrrBinId = IdGen->GetNextBinId();
-			const int CrrIdx = BinsV.AddSorted(TBin(Val, CrrBinId), true);
-			BinsV.GetVal(CrrIdx).Inc(Label);
-			Example->SetBinId(TMath::Mx<int>(Example->BinId, CrrBinId));
-		} else { // Find the closest bin 
-			if (Idx != -1) { // Bin initialized with this very value 
-				BinsV.GetVal(Idx).Inc(Label);
-				Example->SetBinId(TMath::Mx<int>(Example->BinId, BinsV.GetVal(Idx).Id));
-			} else { // Otherwise, increment the closest bin 
-				Idx = 0;
-				PrevDist = CurrDist = abs(Val - BinsV.GetVal(0).GetVal());
-				// NOTE: We could use binary search because of the ordering invariant; but the number of bins rarely exeecds 100 (hardcoded constant)
-				// While distance starts increasing, stop --- our bin is the one before the current one 
-				for (BinN = 1; BinN < BinsV.Len(); ++BinN) {
-					PrevDist = CurrDist;
-					if ((CurrDist = abs(Val - BinsV.GetVal(BinN).GetVal())) > PrevDist) {
-						Idx = BinN-1; break;
-					}
-				}
-				if (BinN == BinsV.Len()) { Idx = BinN-1; }
-				BinsV.GetVal(Idx).Inc(Label);
-				Example->SetBinId(TMath::Mx<int>(Example->BinId, BinsV.GetVal(Idx).Id));
-			}
+		int Idx = BinsV.SearchBin(Val);
+		if (Idx == -1) { // New bin, initialized with Val; the ID is assigned only if the bin is not merged into an older one 
+			Idx = BinsV.AddSorted(TBin(Val, -1), true);
+			BinsV.GetVal(Idx).Inc(Label);
+			if (BinsV.Len() > MxBinsN) { Idx = MergeClosest(Idx); }
+			if (BinsV.GetVal(Idx).Id == -1) { BinsV.GetVal(Idx).Id = IdGen->GetNextBinId(); }
+		} else { // Bin initialized with this very value 
+			BinsV.GetVal(Idx).Inc(Label);
 		}
+		++AllN;
+		Example->SetBinId(TMath::Mx<int>(Example->BinId, BinsV.GetVal(Idx).Id));
 	}
 	// NOTE: This function must ensure the example is removed from the bins that existed at the time of its arrival 
+	// A merged bin keeps the smaller ID, so the bin that absorbed the example still qualifies; once bins merge, the example is 
+	// removed from the closest qualifying bin with its label, which is exact as long as no merge happened 
 	void THist::DecCls(PExample Example, const int& AttrIdx) {
-		int Idx = 0, BinN = 0, PrevIdx = 0;
-		double CurrDist = 0.0, PrevDist = 0.0;
-		const double Val = Example->AttributesV.GetVal(AttrIdx).Num;
+		const double Val = Example->GetNum(AttrIdx);
 		const int Label = Example->Label;
-		// Idx = BinsV.SearchBin(Val); // Binary search for Val 
-		if ((Idx = BinsV.SearchBin(Val)) == -1 && BinsV.Len() < BinsN) {
-			printf("Searching for value: %f\n", Val);
-			Print();
-			FailR("By construction, the value cannot be missing."); // NOTE: For deubgging purposes 
-		} else { // Find the closest bin 
-			if (Idx != -1 && BinsV.GetVal(Idx).Id <= Example->BinId) { // Bin initialized with this very value 
-				BinsV.GetVal(Idx).Dec(Label);
-			} else { // Otherwise, decrement the closest bin that WAS NOT created after the example was accumulated 
-				Idx = 0;
-				// NOTE: We can't take the first bin as it may have been created AFTER the example was accumulated; instead we find the first suitable bin 
-				for (BinN = 0; BinN < BinsV.Len() && BinsV.GetVal(BinN).Id > Example->BinId; ++BinN);
-				AssertR(BinN < BinsV.Len(), "No suitable bin --- impossible."); // NOTE: For debugging purposes 
-				PrevIdx = Idx = BinN; // First suitable bin 
-				PrevDist = CurrDist = abs(Val - BinsV.GetVal(BinN).GetVal());
-				// The order is preserved even though new bins might have been created between the old ones 
-				for (; BinN < BinsV.Len(); ++BinN) {
-					if (BinsV.GetVal(BinN).Id <= Example->BinId) {
-						PrevDist = CurrDist;
-						if ((CurrDist = abs(Val - BinsV.GetVal(BinN).GetVal())) > PrevDist) {
-							Idx = PrevIdx; break;
-						} else { PrevIdx = BinN; }
-					}
-				}
-				if (BinN == BinsV.Len() && Idx != PrevIdx) { Idx = PrevIdx; }
-				BinsV.GetVal(Idx).Dec(Label);
+		int Idx = BinsV.SearchBin(Val);
+		if (Idx == -1 || BinsV.GetVal(Idx).Id > Example->BinId || !BinsV.GetVal(Idx).Has(Label)) {
+			Idx = -1;
+			double MnDist = TFlt::Mx;
+			// NOTE: The number of bins is small, hence linear search 
+			for (int BinN = 0; BinN < BinsV.Len(); ++BinN) {
+				const TBin& Bin = BinsV.GetVal(BinN);
+				if (Bin.Id > Example->BinId || !Bin.Has(Label)) { continue; } // bin created after the example arrived 
+				const double Dist = TFlt::Abs(Val-Bin.GetVal());
+				if (Dist < MnDist) { MnDist = Dist; Idx = BinN; }
 			}
 		}
+		if (Idx != -1) { BinsV.GetVal(Idx).Dec(Label); --AllN; }
 	}
 	void THist::IncReg(const PExample Example, const int& AttrIdx) {
-		int Idx = 0, BinN = 0;
-		double CurrDist = 0.0, PrevDist = 0.0;
-		const double Val = Example->AttributesV.GetVal(AttrIdx).Num; // Numeric attribute value 
+		const double Val = Example->GetNum(AttrIdx); // Numeric attribute value 
 		const double RegValue = Example->Value; // Value of the target variable 
-		if (BinsV.Len() < BinsN && (Idx = BinsV.SearchForw(Val, 0)) == -1) { // BinsV.SearchBin(Val)) == -1) {
-			const int TmpIdx = BinsV.AddSorted(TBin(Val), true);
-			BinsV.GetVal(TmpIdx).Inc(RegValue);
-		} else { // Find the closest bin 
-			if (Idx != -1) { // Bin initialized with this very value 
-				BinsV.GetVal(Idx).Inc(RegValue);
-			} else { // Otherwise, increment the closest bin 
-				Idx = 0;
-				CurrDist = PrevDist = abs(Val - BinsV.GetVal(0).GetVal());
-				for (BinN = 1; BinN < BinsV.Len(); ++BinN) {
-					PrevDist = CurrDist;
-					// We are fine, because bins are ordered inside the vector by the initialization values 
-					if ((CurrDist = abs(Val - BinsV.GetVal(BinN).GetVal())) > PrevDist) {
-						Idx = BinN - 1;
-						break;
-					}
-				}
-				if(BinN == BinsV.Len()) { Idx = BinN-1; }
-				BinsV.GetVal(Idx).Inc(RegValue);
+		int Idx = BinsV.SearchBin(Val);
+		if (Idx == -1) {
+			Idx = BinsV.AddSorted(TBin(Val), true);
+			BinsV.GetVal(Idx).Inc(RegValue);
+			if (BinsV.Len() > MxBinsN) { MergeClosest(); }
+		} else { // Bin initialized with this very value 
+			BinsV.GetVal(Idx).Inc(RegValue);
+		}
+		++AllN;
+	}
+	// Bins are ordered by value, so the closest pair is adjacent 
+	int THist::MergeClosest(const int& BinN) {
+		Assert(BinsV.Len() > 1);
+		int MnIdx = 0;
+		double MnGap = TFlt::Mx;
+		for (int CrrIdx = 0; CrrIdx+1 < BinsV.Len(); ++CrrIdx) {
+			const double Gap = BinsV.GetVal(CrrIdx+1).GetVal()-BinsV.GetVal(CrrIdx).GetVal();
+			if (Gap < MnGap) { MnGap = Gap; MnIdx = CrrIdx; }
+		}
+		BinsV.GetVal(MnIdx).Merge(BinsV.GetVal(MnIdx+1));
+		BinsV.Del(MnIdx+1);
+		return BinN > MnIdx ? BinN-1 : BinN;
+	}
+	void THist::Merge(const THist& Hist) {
+		TBinV MergedV(BinsV.Len()+Hist.BinsV.Len(), 0);
+		int BinN1 = 0, BinN2 = 0;
+		while (BinN1 < BinsV.Len() || BinN2 < Hist.BinsV.Len()) {
+			if (BinN2 == Hist.BinsV.Len() || (BinN1 < BinsV.Len() && BinsV.GetVal(BinN1) < Hist.BinsV.GetVal(BinN2))) {
+				MergedV.Add(BinsV.GetVal(BinN1++));
+			} else if (BinN1 == BinsV.Len() || Hist.BinsV.GetVal(BinN2) < BinsV.GetVal(BinN1)) {
+				MergedV.Add(Hist.BinsV.GetVal(BinN2++));
+			} else { // same value 
+				MergedV.Add(BinsV.GetVal(BinN1++));
+				MergedV.Last().Merge(Hist.BinsV.GetVal(BinN2++));
 			}
 		}
+		BinsV = MergedV;
+		AllN += Hist.AllN;
+		while (BinsV.Len() > MxBinsN) { MergeClosest(); }
 	}
 	// Find best split 
 	double THist::InfoGain(double& SplitVal) const {
-		int HiCount = 0, LoCount = 0, CurrCount = 0, MxIdx = 0;
+		int64 HiCount = 0, LoCount = 0, CurrCount = 0;
+		int MxIdx = 0;
 		double Val = 0.0, MxGain = 0.0, CurrGain = 0.0;
 		double LoImp = 0.0, HiImp = 0.0;
-		TIntV LoV, HiV;
-		double* GArr = new double[sizeof(double)*BinsV.Len()]();
-		int* NArr = new int[sizeof(int)*BinsV.Len()]();
+		TVec<int64> LoV, HiV;
+		double* GArr = new double[BinsV.Len()]();
+		int64* NArr = new int64[BinsV.Len()]();
 		// Compute initial split 
 		LoCount = 0; // BinsV.GetVal(0).Count;
 		// LoV = BinsV.GetVal(0).PartitionV;
 		HiCount = 0;
 		for (int BinN = 0; BinN < BinsV.Len(); ++BinN) {
-			TIntV TmpV = BinsV.GetVal(BinN).PartitionV;
-			TMisc::AddVec(1, TmpV, HiV); // HiV = HiV+TmpV
+			TMisc::AddVec(1, BinsV.GetVal(BinN).PartitionV, HiV); // HiV = HiV+PartitionV
 			HiCount += BinsV.GetVal(BinN).Count;
 			GArr[BinN] = TMisc::Entropy(HiV, HiCount); // h_i := H(B_1\cup B_2\cup \ldots\cup B_i)
 			NArr[BinN] = HiCount; // n_i := |B_1|+\ldots+|B_i|
 		}
-		const int AllN = HiCount;
+		const int64 AllN = HiCount;
 		const double H = TMisc::Entropy(HiV, AllN);
 		// printf("H = %f\n", H);
 		// Now find the best split 
@@ -177,16 +332,15 @@ namespace TDatastream {
 			LoCount += CurrCount;
 			HiCount = NArr[BinN];
 			HiImp = GArr[BinN];
-			TIntV TmpV = BinsV.GetVal(BinN+1).PartitionV;
-			TMisc::AddVec(1, TmpV, LoV);
+			TMisc::AddVec(1, BinsV.GetVal(BinN+1).PartitionV, LoV);
 			LoImp = TMisc::Entropy(LoV, LoCount);
 			if ((CurrGain = H - LoCount*LoImp/AllN - HiCount*HiImp/AllN) > MxGain) {
 				MxGain = CurrGain;
 				MxIdx = BinN;
 			}
 		}
-		delete GArr;
-		delete NArr;
+		delete [] GArr;
+		delete [] NArr;
 		if (MxIdx > 0) {
 			SplitVal = BinsV.GetVal(MxIdx).GetVal();
 			return MxGain;
@@ -195,42 +349,65 @@ namespace TDatastream {
 		}
 	}
 
+	// Same scan as InfoGain, with Gini impurity in place of entropy; the split goes after the best bin 
 	double THist::GiniGain(double& SpltVal) const {
-		EFailR("Implementation in progress.");
-		return 0.0;
+		TVec<int64> LoV, HiV;
+		int64 LoCount = 0, HiCount = 0;
+		for (int BinN = 0; BinN < BinsV.Len(); ++BinN) {
+			TMisc::AddVec(1, BinsV.GetVal(BinN).PartitionV, HiV);
+			HiCount += BinsV.GetVal(BinN).Count;
+		}
+		const int64 AllN = HiCount;
+		if (AllN == 0) { return 0.0; }
+		const double G = TMisc::Gini(HiV, AllN);
+		double MxGain = 0.0;
+		int MxIdx = -1;
+		for (int BinN = 0; BinN+1 < BinsV.Len(); ++BinN) {
+			const TCountV& PartV = BinsV.GetVal(BinN).PartitionV;
+			TMisc::AddVec(1, PartV, LoV); // LoV = LoV+PartV
+			TMisc::AddVec(-1, PartV, HiV); // HiV = HiV-PartV
+			LoCount += BinsV.GetVal(BinN).Count;
+			HiCount -= BinsV.GetVal(BinN).Count;
+			const double CrrGain = G-LoCount*TMisc::Gini(LoV, LoCount)/AllN-HiCount*TMisc::Gini(HiV, HiCount)/AllN;
+			if (CrrGain > MxGain) { MxGain = CrrGain; MxIdx = BinN; }
+		}
+		if (MxIdx == -1) { return 0.0; }
+		SpltVal = BinsV.GetVal(MxIdx).GetVal();
+		return MxGain;
 	}
 
 	// See [Knuth, 1997] and [Chan et al., 1979] for details regarding updating formulas for variance 
 	// (Wikipedia link: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance, accessed on 7 Jun 2013)
 	double THist::StdGain(double& SpltVal) const { // for regression 
-		int HiCnt, LoCnt, CrrCnt;
+		if (BinsV.Empty()) { return 0; } // no values seen yet; nothing to split 
+		int64 HiCnt, LoCnt, CrrCnt;
 		int MxIdx;
 		double MxGain, CrrGain;
 		double LoS, HiS, LoT, HiT;
-		double* SArr = new double[BinsN](); // Define VarArr[i] := n*Var(B_1\cup B_2\cup ...\cup B_i) 
-		double* TArr = new double[BinsN](); // Define AvgArr[i] := x_1+x_2+...+x_i
+		double* SArr = new double[MxBinsN](); // Define VarArr[i] := n*Var(B_1\cup B_2\cup ...\cup B_i) 
+		double* TArr = new double[MxBinsN](); // Define AvgArr[i] := x_1+x_2+...+x_i
 		// Compute initial split 
 		LoCnt = HiCnt = 0; // BinsV.GetVal(0).Count;
 		SArr[0] = TArr[0] = 0;
 		for (int BinN = 0; BinN < BinsV.Len(); ++BinN) {
-			const TBin CrrBin = BinsV.GetVal(BinN);
+			const TBin& CrrBin = BinsV.GetVal(BinN);
 			const double PrevS = BinN > 0 ? SArr[BinN-1] : 0;
 			const double PrevT = BinN > 0 ? TArr[BinN-1] : 0;
-			TArr[BinN] = PrevT + CrrBin.T;
+			TArr[BinN] = PrevT + CrrBin.GetSum();
 			CrrCnt = BinsV.GetVal(BinN).Count;
 			SArr[BinN] = PrevS+CrrBin.S;
 			if (CrrCnt > 0 && HiCnt > 0) {
-				SArr[BinN] += TMath::Sqr(CrrCnt*PrevT/HiCnt-CrrBin.T)*HiCnt/(CrrCnt*(CrrCnt+HiCnt));
+				SArr[BinN] += TMath::Sqr(CrrCnt*PrevT/HiCnt-CrrBin.GetSum())*HiCnt/(CrrCnt*(CrrCnt+HiCnt));
 			}
 			HiCnt += CrrCnt;
 		}
-		const int AllN = HiCnt;
+		const int64 AllN = HiCnt;
 		const double S = SArr[BinsV.Len()-1];
-		// printf("AllN = %d; S = %f\n", AllN, S);
+		// printf("AllN = %lld; S = %f\n", AllN, S);
 		HiS = CrrGain = MxGain = 0.0;
 		MxIdx = 0;
 		LoS = BinsV.Last().S;
-		LoT = BinsV.Last().T;
+		LoT = BinsV.Last().GetSum();
 		LoCnt = BinsV.Last().Count;
 		HiCnt -= LoCnt;
 		// Compute expected variance reduction, as defined by [Ikonomovska, 2012] and [Ikonomovska et al., 2011]
@@ -248,13 +425,13 @@ namespace TDatastream {
 			// printf("CurrGain = %f\n", CrrGain); getchar();
 			// Update variance 
 			const double CrrS = BinsV.GetVal(BinN).S; // S_2
-			const double CrrT = BinsV.GetVal(BinN).T;
+			const double CrrT = BinsV.GetVal(BinN).GetSum();
 			CrrCnt = BinsV.GetVal(BinN).Count; // n
 			LoS += CrrS;
 			if (LoCnt > 0 && CrrCnt > 0) {
 				LoS += TMath::Sqr(CrrCnt*LoT/LoCnt-CrrT)*LoCnt/(CrrCnt*(CrrCnt+LoCnt));
 			}
-			LoT += BinsV.GetVal(BinN).T;
+			LoT += BinsV.GetVal(BinN).GetSum();
 			LoCnt += CrrCnt;
 			HiCnt -= CrrCnt;
 		}
@@ -271,7 +448,7 @@ namespace TDatastream {
 
 	void THist::Print() const {
 		for (auto It = BinsV.BegI(); It != BinsV.EndI(); ++It) {
-			printf("%f (%d)\t", It->GetVal(), It->Count);
+			printf("%f (%lld)\t", It->GetVal(), (long long) It->Count);
 		}
 		putchar('\n');
 	}
@@ -279,40 +456,138 @@ namespace TDatastream {
 	///////////////////////////////
 	// Attribute
 	
-	///////////////////////////////
-	// Attribute-Managment
-	TAttrMan::TAttrMan(const THash<TStr, TInt>& AttrH_, const THash<TInt, TStr>& InvAttrH_,
-		const int& Id_, const TStr& Nm_, const TAttrType& Type_)
-		: AttrH(AttrH_), InvAttrH(InvAttrH_), Id(Id_), Nm(Nm_), Type(Type_) {
-			AttrH.GetDatV(ValueV); // Possible values; there is a single value for numeric attributes 
-	}
-	
 	///////////////////////////////
 	// Example
 	TExample& TExample::operator=(const TExample& Example) {
 		if(*this != Example) {
 			AttributesV = Example.AttributesV;	BinId = Example.BinId;
 			Label = Example.Label; LeafId = Example.LeafId;	Value = Example.Value;
+			SparseP = Example.SparseP;
 		}
 		return *this;
 	}
 
+	/////////////////////////////////
+	// Node-Pool
+	thread_local bool TNodePool::TLocal::GoneP = false;
+	std::mutex TNodePool::SpareLock;
+	void* TNodePool::SpareSlot = nullptr;
+	std::atomic<uint64> TNodePool::SpareN(0);
+	std::atomic<uint64> TNodePool::ChunksN(0);
+	std::atomic<uint64> TNodePool::SlotsN(0);
+	std::atomic<uint64> TNodePool::FreeN(0);
+
+	TNodePool::TLocal::~TLocal() {
+		std::lock_guard<std::mutex> Guard(SpareLock);
+		uint64 SlotN = 0;
+		for (; ChunkPos < ChunkSlotsN; ++ChunkPos, ++SlotN) { // unused slots become free ones 
+			void* Slot = Chunk+ChunkPos*sizeof(TNode);
+			*static_cast<void**>(Slot) = FreeSlot;
+			FreeSlot = Slot;
+		}
+		SlotsN += SlotN; FreeN += SlotN;
+		while (FreeSlot != nullptr) {
+			void* Slot = FreeSlot;
+			FreeSlot = *static_cast<void**>(Slot);
+			*static_cast<void**>(Slot) = SpareSlot;
+			SpareSlot = Slot;
+			++SpareN;
+		}
+		GoneP = true;
+	}
+	void* TNodePool::Alloc() {
+		if (TLocal::GoneP) {
+			void* Slot = AllocSpare();
+			if (Slot != nullptr) { return Slot; }
+			++SlotsN; // a lone slot when a thread allocates after its pool is gone; it ends up on the spare list 
+			return ::operator new(sizeof(TNode));
+		}
+		TLocal& Local = GetLocal();
+		if (Local.FreeSlot != nullptr) { // reuse the most recently freed slot 
+			void* Slot = Local.FreeSlot;
+			Local.FreeSlot = *static_cast<void**>(Slot);
+			--FreeN;
+			return Slot;
+		}
+		if (Local.ChunkPos == ChunkSlotsN) {
+			if (SpareN > 0) {
+				void* Slot = AllocSpare();
+				if (Slot != nullptr) { return Slot; }
+			}
+			Local.Chunk = static_cast<char*>(::operator new(ChunkSlotsN*sizeof(TNode)));
+			Local.ChunkPos = 0;
+			++ChunksN;
+		}
+		++SlotsN;
+		return Local.Chunk+(Local.ChunkPos++)*sizeof(TNode);
+	}
+	void TNodePool::Free(void* Slot) {
+		if (Slot == nullptr) { return; }
+		if (TLocal::GoneP) { FreeSpare(Slot); return; }
+		TLocal& Local = GetLocal();
+		*static_cast<void**>(Slot) = Local.FreeSlot;
+		Local.FreeSlot = Slot;
+		++FreeN;
+	}
+	void* TNodePool::AllocSpare() {
+		std::lock_guard<std::mutex> Guard(SpareLock);
+		if (SpareSlot == nullptr) { return nullptr; }
+		void* Slot = SpareSlot;
+		SpareSlot = *static_cast<void**>(Slot);
+		--SpareN; --FreeN;
+		return Slot;
+	}
+	void TNodePool::FreeSpare(void* Slot) {
+		std::lock_guard<std::mutex> Guard(SpareLock);
+		*static_cast<void**>(Slot) = SpareSlot;
+		SpareSlot = Slot;
+		++SpareN; ++FreeN;
+	}
+	uint64 TNodePool::GetMemUsed() {
+		return ChunksN*ChunkSlotsN*sizeof(TNode);
+	}
+
 	/////////////////////////////////
 	// Node
 	// Copy constructor 
 	TNode::TNode(const TNode& Node)
-		: CndAttrIdx(Node.CndAttrIdx), ExamplesN(Node.ExamplesN), UsedAttrs(Node.UsedAttrs),
+		: CndAttrIdx(Node.CndAttrIdx), ExamplesN(Node.ExamplesN), DirtyN(Node.DirtyN), UsedAttrs(Node.UsedAttrs),
 		Avg(Node.Avg), VarSum(Node.VarSum), Err(Node.Err), TestModeN(Node.TestModeN), Id(Node.Id),
-		Correct(Node.Correct), All(Node.All), PartitionV(Node.PartitionV), HistH(Node.HistH),
-		Type(Node.Type), Val(Node.Val), ExamplesV(Node.ExamplesV) { }
+		Correct(Node.Correct), All(Node.All), LostN(Node.LostN), PartitionV(Node.PartitionV), HistH(Node.HistH),
+		Type(Node.Type), Val(Node.Val), ExamplesV(Node.ExamplesV), Adwin(Node.Adwin), SubspaceV(Node.SubspaceV) { }
+	TNode::TNode(TSIn& SIn) {
+		double Avg_, VarSum_;
+		SIn.Load(CndAttrIdx); SIn.Load(ExamplesN); SIn.Load(Val); SIn.Load(Avg_); SIn.Load(VarSum_); SIn.Load(Err); SIn.Load(TestModeN);
+		Avg = Avg_; VarSum = VarSum_;
+		char TypeCh; SIn.Load(TypeCh); Type = (TNodeType) TypeCh;
+		ExamplesV.Load(SIn);
+#if GLIB_OK
+		SeenH.Load(SIn);
+#endif
+		CountH.Load(SIn); PartitionV = TCountV(SIn); ChildrenV.Load(SIn); UsedAttrs.Load(SIn); HistH.Load(SIn); AltTreesV.Load(SIn);
+		SIn.Load(Id); SIn.Load(Correct); SIn.Load(All);
+		Adwin = TAdwin(SIn); SubspaceV.Load(SIn); SIn.Load(LostN);
+		DirtyN = ExamplesN;
+	}
+	void TNode::Save(TSOut& SOut) const {
+		SOut.Save(CndAttrIdx); SOut.Save(ExamplesN); SOut.Save(Val); SOut.Save((double) Avg); SOut.Save((double) VarSum); SOut.Save(Err); SOut.Save(TestModeN);
+		SOut.Save((char) Type);
+		ExamplesV.Save(SOut);
+#if GLIB_OK
+		SeenH.Save(SOut);
+#endif
+		CountH.Save(SOut); PartitionV.Save(SOut); ChildrenV.Save(SOut); UsedAttrs.Save(SOut); HistH.Save(SOut); AltTreesV.Save(SOut);
+		SOut.Save(Id); SOut.Save(Correct); SOut.Save(All);
+		Adwin.Save(SOut); SubspaceV.Save(SOut); SOut.Save(LostN);
+	}
 	// Assignment operator 
 	TNode& TNode::operator=(const TNode& Node) {
 		if (*this != Node) {
 			//Clr(); // Delete old elements 
 			All = Node.All; AltTreesV = Node.AltTreesV;
 			Avg = Node.Avg; ChildrenV = Node.ChildrenV;
-			CndAttrIdx = Node.CndAttrIdx; Correct = Node.Correct;
-			Counts = Node.Counts; Err = Node.Err; ExamplesN = Node.ExamplesN;
+			CndAttrIdx = Node.CndAttrIdx; Correct = Node.Correct; LostN = Node.LostN;
+			CountH = Node.CountH; Err = Node.Err; ExamplesN = Node.ExamplesN; DirtyN = Node.DirtyN;
 			ExamplesV = Node.ExamplesV; HistH = Node.HistH; Id = Node.Id;
 			PartitionV = Node.PartitionV;
 #ifdef GLIB_OK
@@ -321,13 +596,14 @@ namespace TDatastream {
 			seen_h = Node.seen_h;
 #endif
 			TestModeN = Node.TestModeN; Type = Node.Type;
+			UsedAttrs = Node.UsedAttrs; Adwin = Node.Adwin; SubspaceV = Node.SubspaceV;
 			Val = Node.Val; VarSum = Node.VarSum;
 		}
 		return *this;
 	}
 	bool TNode::operator==(const TNode& Node) const {
 		return CndAttrIdx == Node.CndAttrIdx && Type == Node.Type && ExamplesV == Node.ExamplesV &&
-			Counts == Node.Counts && PartitionV == Node.PartitionV && Id == Node.Id &&
+			CountH == Node.CountH && PartitionV == Node.PartitionV && Id == Node.Id &&
 			ChildrenV == Node.ChildrenV && UsedAttrs == Node.UsedAttrs;
 	}
 	// Training set entropy 
@@ -336,19 +612,19 @@ namespace TDatastream {
 	}
 	double TNode::ComputeGini() const {
 		double g = 1.0, p = 0.0;
-		for(auto It = PartitionV.BegI(); It != PartitionV.EndI(); It++) {
-			p = 1.0*(*It)/ExamplesN;
+		for (int LabelN = 0; LabelN < PartitionV.Len(); ++LabelN) {
+			p = 1.0*PartitionV[LabelN]/ExamplesN;
 			g -= p*p;
 		}
 		return g;
 	}
 	// Compute inforation gain from sufficient statistics 
-	double TNode::InfoGain(const int& AttrIndex, const TAttrManV& AttrManV) const {
+	double TNode::InfoGain(const int& AttrIndex, const TSchema& Schema) const {
 		double h = 0, hj = 0, p = 0, pj = 0;
-		int SubExamplesN = 0; // Number of examples x with A(x)=a_j for j=1,2,...,ValsN
-		const int LabelsN = AttrManV.GetVal(AttrManV.Len()-1).ValueV.Len();
-		TAttrMan AttrMan(AttrManV.GetVal(AttrIndex));
-		const int ValsN = AttrMan.ValueV.Len();
+		int64 SubExamplesN = 0; // Number of examples x with A(x)=a_j for j=1,2,...,ValsN
+		const int LabelsN = Schema.GetLabelsN();
+		const int ValsN = Schema.GetValsN(AttrIndex);
+		TVec<int64> CountV; GetCountV(AttrIndex, ValsN, LabelsN, CountV);
 		// Compute entropy H(E) 
 		h = TMisc::Entropy(PartitionV, ExamplesN);
 		// Compute information gain 
@@ -356,20 +632,14 @@ namespace TDatastream {
 			SubExamplesN = 0;
 			// Compute |E_j|
 			for (int i = 0; i < LabelsN; ++i) {
-				TTriple<TInt, TInt, TInt> TmpTriple(AttrIndex, j, i);
-				if(Counts.IsKey(TmpTriple)) {
-					SubExamplesN += Counts.GetDat(TmpTriple);
-				}
+				SubExamplesN += CountV[j*LabelsN+i];
 			}
 			hj = 0;
 			// Compute H(E_j)
 			for (int i = 0; i < LabelsN; ++i) {
-				TTriple<TInt, TInt, TInt> TmpTriple(AttrIndex, j, i);
-				if (Counts.IsKey(TmpTriple)) {
-					pj = SubExamplesN > 0 ? 1.0*Counts.GetDat(TmpTriple)/SubExamplesN : 0; // Prevent divison by zero 
-					if (pj > 0) { // Ensure Log2(pj) exists 
-						hj -= pj*TMath::Log2(pj);
-					}
+				pj = SubExamplesN > 0 ? 1.0*CountV[j*LabelsN+i]/SubExamplesN : 0; // Prevent divison by zero 
+				if (pj > 0) { // Ensure Log2(pj) exists 
+					hj -= pj*TMath::Log2(pj);
 				}
 			}
 			p = ExamplesN > 0 ? 1.0*SubExamplesN/ExamplesN : 0;
@@ -379,32 +649,26 @@ namespace TDatastream {
 		return h;
 	}
 	// Compute Gini index from sufficient statistics 
-	double TNode::GiniGain(const int& AttrIndex, const TVec<TAttrMan>& AttrManV) const {
+	double TNode::GiniGain(const int& AttrIndex, const TSchema& Schema) const {
 		double g = 1.0, gj = 0.0, p = 0, pj = 0;
-		int SubExamplesN = 0; // Number of examples x with A(x)=a_j for j=1,2,...,ValsN
-		const int LabelsN = AttrManV.GetVal(AttrManV.Len()-1).ValueV.Len();
-		TAttrMan AttrMan(AttrManV.GetVal(AttrIndex));
-		const int ValsN = AttrMan.ValueV.Len();
-		for (auto It = PartitionV.BegI(); It != PartitionV.EndI(); ++It) {
-			p = ExamplesN > 0 ? 1.0*(*It)/ExamplesN : 0; // Prevent division by zero 
+		int64 SubExamplesN = 0; // Number of examples x with A(x)=a_j for j=1,2,...,ValsN
+		const int LabelsN = Schema.GetLabelsN();
+		const int ValsN = Schema.GetValsN(AttrIndex);
+		TVec<int64> CountV; GetCountV(AttrIndex, ValsN, LabelsN, CountV);
+		for (int LabelN = 0; LabelN < PartitionV.Len(); ++LabelN) {
+			p = ExamplesN > 0 ? 1.0*PartitionV[LabelN]/ExamplesN : 0; // Prevent division by zero 
 			g -= p*p;
 		}
 		for (int j = 0; j < ValsN; ++j) {
 			SubExamplesN = 0;
 			// Compute |E_j|
 			for (int i = 0; i < LabelsN; ++i) {
-				TTriple<TInt, TInt, TInt> TmpTriple(AttrIndex, j, i);
-				if (Counts.IsKey(TmpTriple)) {
-					SubExamplesN += Counts.GetDat(TmpTriple);
-				}
+				SubExamplesN += CountV[j*LabelsN+i];
 			}
 			gj = 1.0;
 			for (int i = 0; i < LabelsN; ++i) {
-				TTriple<TInt, TInt, TInt> TmpTriple(AttrIndex, j, i);
-				if (Counts.IsKey(TmpTriple)) {
-					pj = SubExamplesN > 0 ? 1.0*Counts.GetDat(TmpTriple)/SubExamplesN : 0; // Prevent divison by zero 
-					gj -= pj*pj;
-				}
+				pj = SubExamplesN > 0 ? 1.0*CountV[j*LabelsN+i]/SubExamplesN : 0; // Prevent divison by zero 
+				gj -= pj*pj;
 			}
 			p = ExamplesN > 0 ? 1.0*SubExamplesN/ExamplesN : 0;
 			g -= p*gj;
@@ -412,11 +676,10 @@ namespace TDatastream {
 		// Return information gain GiniGain(A) 
 		return g;
 	}
-	double TNode::StdGain(const int& AttrIdx, const TAttrManV& AttrManV) const {
+	double TNode::StdGain(const int& AttrIdx, const TSchema& Schema) const {
 		// NOTE: Compute variances Var(S_i) for all possible values attribute A_i can take 
-		const TAttrType AttrType = AttrManV.GetVal(AttrIdx).Type;
-		EAssertR(AttrType == TAttrType::DISCRETE, "This function works with nominal attributes.");
-		const int ValsN = AttrManV.GetVal(AttrIdx).ValueV.Len();
+		EAssertR(!Schema.IsNumeric(AttrIdx), "This function works with nominal attributes.");
+		const int ValsN = Schema.GetValsN(AttrIdx);
 		TVec<TTriple<TFlt, TFlt, TInt> > VarV; // Vector of (mean, variance, n) pairs 
 		// TODO: Avoid iterating over the vector twice --- is there a faster way to initialize the thing?
 		for (int ValN = 0; ValN < ValsN; ++ValN) {
@@ -424,7 +687,7 @@ namespace TDatastream {
 		}
 		// Incrementally compute variances 
 		for (int ValN = 0; ValN < ExamplesV.Len(); ++ValN) {
-			const int CrrIdx = ExamplesV.GetVal(ValN)->AttributesV.GetVal(AttrIdx).Value;
+			const int CrrIdx = ExamplesV.GetVal(ValN)->GetVal(AttrIdx);
 			const double CrrVal = ExamplesV.GetVal(ValN)->Value;
 			TTriple<TFlt, TFlt, TInt>& CrrTriple = VarV.GetVal(CrrIdx);
 			// See [Knuth, 1997] for details regarding incremental algorithms for variance 
@@ -443,28 +706,99 @@ namespace TDatastream {
 		}
 		return CrrStd;
 	}
-	TBstAttr TNode::BestAttr(const TAttrManV& AttrManV, const TTaskType& TaskType) {
-		if (TaskType == TTaskType::CLASSIFICATION) {
-			return BestClsAttr(AttrManV);
+	// Counts leaves out the default value 0 of discrete attributes (sparse examples do not list it), so its count is 
+	// whatever remains of the label's examples 
+	int64 TNode::GetCount(const int& AttrN, const int& ValN, const int& Label, const int& ValsN) const {
+		if (ValN != 0) {
+			const int KeyId = CountH.GetKeyId(AttrN);
+			if (KeyId == -1) { return 0; }
+			const TCountV& CountV = CountH[KeyId];
+			const int LabelsN = CountV.Len()/ValsN;
+			return Label < LabelsN ? CountV[ValN*LabelsN+Label] : 0;
+		}
+		int64 Cnt = Label < PartitionV.Len() ? PartitionV[Label] : 0;
+		for (int CrrValN = 1; CrrValN < ValsN; ++CrrValN) { Cnt -= GetCount(AttrN, CrrValN, Label, ValsN); }
+		return Cnt;
+	}
+	void TNode::GetValCountV(const int& AttrN, const int& ValN, const int& ValsN, const int& LabelsN, TVec<int64>& CountV) const {
+		CountV.Gen(LabelsN);
+		for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
+			CountV[LabelN] = ValN == 0 && LabelN < PartitionV.Len() ? PartitionV[LabelN] : 0;
+		}
+		const int KeyId = CountH.GetKeyId(AttrN);
+		if (KeyId == -1) { return; }
+		const TCountV& AttrCountV = CountH[KeyId];
+		const int CountLabelsN = AttrCountV.Len()/ValsN;
+		for (int LabelN = 0; LabelN < LabelsN && LabelN < CountLabelsN; ++LabelN) {
+			if (ValN != 0) { CountV[LabelN] = AttrCountV[ValN*CountLabelsN+LabelN]; continue; }
+			for (int CrrValN = 1; CrrValN < ValsN; ++CrrValN) { CountV[LabelN] -= AttrCountV[CrrValN*CountLabelsN+LabelN]; }
+		}
+	}
+	void TNode::GetCountV(const int& AttrN, const int& ValsN, const int& LabelsN, TVec<int64>& CountV) const {
+		CountV.Gen(ValsN*LabelsN);
+		for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
+			int64 DefCnt = LabelN < PartitionV.Len() ? PartitionV[LabelN] : 0;
+			for (int ValN = 1; ValN < ValsN; ++ValN) {
+				const int64 Cnt = GetCount(AttrN, ValN, LabelN, ValsN);
+				CountV[ValN*LabelsN+LabelN] = Cnt; DefCnt -= Cnt;
+			}
+			CountV[LabelN] = DefCnt;
+		}
+	}
+	// Sparse examples leave numeric attributes at 0.0 out of the histogram; what the node saw beyond the histogram 
+	// goes back in as a single bin at 0.0. For dense examples the histogram is complete and returned as it is 
+	const THist& TNode::GetHist(const int& AttrN, const bool& ClsP, THist& DefHist) const {
+		const THist& Hist = HistH.GetDat(AttrN);
+		const int64 DefN = ExamplesN-Hist.AllN;
+		if (DefN <= 0) { return Hist; }
+		TBin DefBin(0.0, -1);
+		if (ClsP) { // histograms may miss a few forgotten examples, so only positive remainders count 
+			TVec<int64> HistPartV(PartitionV.Len()); HistPartV.PutAll(0);
+			for (int BinN = 0; BinN < Hist.BinsV.Len(); ++BinN) {
+				const TBin& Bin = Hist.BinsV[BinN];
+				for (int LabelN = 0; LabelN < Bin.PartitionV.Len() && LabelN < HistPartV.Len(); ++LabelN) { HistPartV[LabelN] += Bin.PartitionV[LabelN]; }
+			}
+			for (int LabelN = 0; LabelN < PartitionV.Len(); ++LabelN) {
+				const int64 Cnt = PartitionV[LabelN]-HistPartV[LabelN];
+				DefBin.PartitionV.Add(Cnt > 0 ? Cnt : 0); DefBin.Count += Cnt > 0 ? Cnt : 0;
+			}
+		} else { // Regression; the node's statistics minus those of the histogram, see [Chan et al., 1979] 
+			TBin HistBin(0.0, -1);
+			for (int BinN = 0; BinN < Hist.BinsV.Len(); ++BinN) { HistBin.Merge(Hist.BinsV[BinN]); }
+			DefBin.Count = DefN;
+			DefBin.Mean = (Avg*ExamplesN-HistBin.GetSum())/DefN;
+			const double Delta = HistBin.Mean-DefBin.Mean;
+			DefBin.S = TMath::Mx<double>(0.0, VarSum-HistBin.S-Delta*Delta*HistBin.Count*DefN/ExamplesN);
+		}
+		if (DefBin.Count == 0) { return Hist; }
+		DefHist = Hist;
+		THist Def(DefHist.MxBinsN); Def.BinsV.Add(DefBin); Def.AllN = DefBin.Count;
+		DefHist.Merge(Def);
+		return DefHist;
+	}
+	TBstAttr TNode::BestAttr(const TSchema& Schema) {
+		if (Schema.IsCls()) {
+			return BestClsAttr(Schema);
 		} else {
-			return BestRegAttr(AttrManV);
+			return BestRegAttr(Schema);
 		}
 	}
-	TBstAttr TNode::BestRegAttr(const TAttrManV& AttrManV) { // Regression 
-		const int AttrsN = AttrManV.Len()-1; // AttrsManV includes attribute manager for the label 
+	TBstAttr TNode::BestRegAttr(const TSchema& Schema) { // Regression 
+		const int AttrsN = Schema.GetAttrsN();
 		double CrrSdr, Mx1, Mx2;
 		int Idx1, Idx2;
 		CrrSdr = Mx1 = Mx2 = 0;
 		Idx1 = Idx2 = 0;
 		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
-			const TAttrType AttrType = AttrManV.GetVal(AttrN).Type;
-			if (AttrType == TAttrType::DISCRETE) { // Discrete 
+			if (!SubspaceV.Empty() && !SubspaceV.IsInBin(AttrN)) { continue; }
+			if (!Schema.IsNumeric(AttrN)) { // Discrete 
 				if (UsedAttrs.SearchForw(AttrN, 0) < 0) {
 					// Compute standard deviation reduction 
-					CrrSdr = StdGain(AttrN, AttrManV);
+					CrrSdr = StdGain(AttrN, Schema);
 				}
 			} else { // Continuous 
-				CrrSdr = HistH.GetDat(AttrN).StdGain(Val);
+				THist DefHist;
+				CrrSdr = GetHist(AttrN, false, DefHist).StdGain(Val);
 				// printf("SplitVal = %f\n", CrrSdr);
 			}
 			if (CrrSdr > Mx1) {
@@ -476,67 +810,86 @@ namespace TDatastream {
 		const double Ratio = Mx2/Mx1;
 		return TBstAttr(TPair<TInt, TFlt>(Idx1, Mx1), TPair<TInt, TFlt>(Idx2, Mx2), Ratio);
 	}
-	TBstAttr TNode::BestClsAttr(const TAttrManV& AttrManV, const TIntV& BannedAttrV) { // Classification
-		int Idx1, Idx2;
-		double Mx1, Mx2, Crr, SplitVal;
-		const int AttrsN = AttrManV.Len()-1;
-		Crr = Mx1 = Mx2 = 0;
-		Idx1 = Idx2 = -1;
+	TBstAttr TNode::BestClsAttr(const TSchema& Schema, const TIntV& BannedAttrV) { // Classification
+		return BestClsAttrT<TInfoGainHeur, true, true>(Schema, BannedAttrV);
+	}
+	// NOTE: Only leaves remember the split value of the best numeric attribute; drift checks on internal nodes must not move their tests 
+	template <class THeur, bool DiscP, bool NumP>
+	TBstAttr TNode::BestClsAttrT(const TSchema& Schema, const TIntV& BannedAttrV) {
+		int Idx1 = -1, Idx2 = -1;
+		double Mx1 = 0.0, Mx2 = 0.0, SplitVal = 0.0, BstSplitVal = Val;
+		const int AttrsN = Schema.GetAttrsN();
+		// Attributes are visited in order, so ties go the same way in every kernel; in the mixed kernel the next numeric 
+		// attribute is tracked with a cursor into NumAttrV 
+		const TIntV& NumAttrV = Schema.GetNumAttrV();
+		int NumN = 0;
 		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			const bool NumAttrP = NumP && (!DiscP || (NumN < NumAttrV.Len() && NumAttrV[NumN] == AttrN));
+			if (DiscP && NumAttrP) { ++NumN; }
 			// NOTE: BannedAttrV almost never contains more than two indices 
 			if (BannedAttrV.IsIn(AttrN)) { continue; }
-			if (AttrManV.GetVal(AttrN).Type == TAttrType::DISCRETE) {
-				if (UsedAttrs.SearchForw(AttrN, 0) < 0) {
-					Crr = InfoGain(AttrN, AttrManV);
-				}
+			if (!SubspaceV.Empty() && !SubspaceV.IsInBin(AttrN)) { continue; }
+			double Crr = 0.0;
+			if (!NumAttrP) {
+				if (UsedAttrs.SearchForw(AttrN, 0) < 0) { Crr = THeur::Discrete(*this, AttrN, Schema); }
 			} else { // Numeric attribute 
-				Crr = HistH.GetDat(AttrN).InfoGain(SplitVal);
-				// HistH.GetDat(AttrN).Print();
-				// getchar();
-				Val = SplitVal;
+				THist DefHist;
+				Crr = THeur::Numeric(GetHist(AttrN, true, DefHist), SplitVal);
 			}
 			if (Crr > Mx1) {
 				Idx2 = Idx1; Idx1 = AttrN; Mx2 = Mx1; Mx1 = Crr;
+				if (NumAttrP) { BstSplitVal = SplitVal; }
 			} else if (Crr > Mx2) {
 				Idx2 = AttrN; Mx2 = Crr;
 			}
 		}
+		if (CndAttrIdx == -1) { Val = BstSplitVal; }
 		const double Diff = Mx1 - Mx2;
 		return TBstAttr(TPair<TInt, TFlt>(Idx1, Mx1), TPair<TInt, TFlt>(Idx2, Mx2), Diff);
 	}
 	// See [Domingos and Hulten, 2000] and [Hulten et al., 2001] for explanation
-	double TNode::ComputeTreshold(const double& Delta, const int& LabelsN) const {
-		const double R = TMath::Log2(LabelsN); // Range of the random variable for information gain 
+	double TNode::ComputeTreshold(const double& Delta, const int& LabelsN, const TAttrHeuristic& AttrHeuristic) const {
+		// Range of the random variable; log2(LabelsN) for information gain, 1 for Gini gain 
+		const double R = AttrHeuristic == TAttrHeuristic::GINI_GAIN ? TGiniGainHeur::Range(LabelsN) : TInfoGainHeur::Range(LabelsN);
 		// EAssertR(!ExamplesN > 0, "This node has no examples.\n");
 		return TMath::Sqrt(R*R*TMath::Log(1.0/Delta)/(2.0*ExamplesN)); // t = \sqrt{ \frac{R^2 * log(1/delta)}{2n} }
 	}
-	void TNode::Split(const int& AttrIdx, const TAttrManV& AttrManV, PIdGen IdGen) {
+	void TNode::Split(const int& AttrIdx, const TSchema& Schema, PIdGen IdGen, const int& HistBinsN) {
 		// (i) Mark attribute, if discrete, as used
 		// New child for each value of AttrIdx attribute 
 		CndAttrIdx = AttrIdx;
-		const TAttrType AttrType = AttrManV.GetVal(AttrIdx).Type;
-		int ValsN = AttrManV.GetVal(AttrIdx).ValueV.Len();
-		if (AttrType == TAttrType::DISCRETE) { // Categorial attributes can only be used once 
+		int ValsN = Schema.GetValsN(AttrIdx);
+		if (!Schema.IsNumeric(AttrIdx)) { // Categorial attributes can only be used once 
 			UsedAttrs.Add(AttrIdx);
 		} else {
 			ValsN = 2;
-			printf("[DEBUG] Splitting on continuous value %f\n", Val);
 		}
 		// UsedAttrs.Add(CondAttrIndex);
-		const int LabelsN = AttrManV.GetVal(AttrManV.Len()-1).ValueV.Len();
+		const int LabelsN = Schema.GetLabelsN();
 		for (int ValN = 0; ValN < ValsN; ++ValN) {
-			ChildrenV.Add(TNode::New(LabelsN, UsedAttrs, AttrManV, IdGen->GetNextLeafId())); // Leaf node 
+			ChildrenV.Add(TNode::New(LabelsN, UsedAttrs, Schema, IdGen->GetNextLeafId(), TNodeType::LEAF, HistBinsN)); // Leaf node 
 		}
 		if(Type != TNodeType::ROOT) { Type = TNodeType::INTERNAL; }
 	}
 	void TNode::Clr() { // Forget training examples 
-		ExamplesV.Clr(); PartitionV.Clr(); Counts.Clr();
+		ExamplesV.Clr(); PartitionV.Clr(); CountH.Clr();
 		HistH.Clr(true); AltTreesV.Clr(); UsedAttrs.Clr();
 #ifdef GLIB_OK
 		SeenH.Clr(true);
 #endif
 	}
 	// See page 232 of Knuth's TAOCP, Vol. 2: Seminumeric Algorithms [Knuth, 1997] for details
+	uint64 TNode::GetMemUsed() const {
+		uint64 MemUsed = sizeof(TNode)+CountH.GetMemUsed()+PartitionV.GetMemUsed()+ChildrenV.GetMemUsed()+
+			UsedAttrs.GetMemUsed()+AltTreesV.GetMemUsed()+SubspaceV.GetMemUsed()+HistH.GetMemUsed();
+		for (auto It = CountH.BegI(); It != CountH.EndI(); ++It) { MemUsed += It.GetDat().GetMemUsed(); }
+		for (auto It = HistH.BegI(); It != HistH.EndI(); ++It) {
+			const TBinV& BinsV = It.GetDat().BinsV;
+			MemUsed += BinsV.GetMemUsed();
+			for (int BinN = 0; BinN < BinsV.Len(); ++BinN) { MemUsed += BinsV[BinN].PartitionV.GetMemUsed(); }
+		}
+		return MemUsed;
+	}
 	void TNode::UpdateStats(PExample Example) {
 		++ExamplesN;
 		const double CrrValue = Example->Value;
@@ -549,94 +902,297 @@ namespace TDatastream {
 		Err = Loss+Alpha*Err;
 		if (++TestModeN > 500) { TestModeN = 0; }
 	}
-	void TNode::Init(const TAttrManV& AttrManV) {
-		for (int AttrN = 0; AttrN < AttrManV.Len(); ++AttrN) {
-			if (AttrManV.GetVal(AttrN).Type == TAttrType::CONTINUOUS) {
-				// const int LabelsN = AttrManV.GetVal(AttrN).ValueV.Last();
-				HistH.AddDat(AttrN, THist());
+	void TNode::Init(const TSchema& Schema, const int& HistBinsN) {
+		const TIntV& NumAttrV = Schema.GetNumAttrV();
+		for (int NumN = 0; NumN < NumAttrV.Len(); ++NumN) {
+			HistH.AddDat(NumAttrV[NumN], THist(HistBinsN));
+		}
+	}
+
+	/////////////////////////////////
+	// Tree-Snapshot
+	TTreeView::TTreeView(const THoeffdingTree& Tree, const uint64& Version_) : LabelsN(0), Version(Version_) {
+		const TSchema& Schema = *Tree.Schema;
+		const int AttrsN = Schema.GetAttrsN();
+		const bool ClsP = Schema.IsCls();
+		LabelsN = ClsP ? Schema.GetLabelsN() : 0;
+		int StatLen = 1+LabelsN;
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			const bool NumP = Schema.IsNumeric(AttrN);
+			NumericV.Add(NumP);
+			AttrOffV.Add(NumP || !ClsP ? -1 : StatLen);
+			if (!NumP && ClsP) { StatLen += Schema.GetValsN(AttrN)*LabelsN; }
+		}
+		TQQueue<PNode> NodeQ;
+		NodeQ.Push(Tree.Root);
+		int NextN = 1;
+		while (!NodeQ.Empty()) {
+			PNode Node = NodeQ.Top(); NodeQ.Pop();
+			CndAttrV.Add(Node->CndAttrIdx);
+			if (Node->CndAttrIdx != -1) {
+				FstChildV.Add(NextN); ValV.Add(Node->Val); StatOffV.Add(-1);
+				NextN += Node->ChildrenV.Len();
+				for (auto It = Node->ChildrenV.BegI(); It != Node->ChildrenV.EndI(); ++It) { NodeQ.Push(*It); }
+			} else {
+				FstChildV.Add(-1); ValV.Add(Node->Avg);
+				StatOffV.Add(ClsP ? StatV.Len() : -1);
+				if (!ClsP) { continue; }
+				StatV.Add(Node->ExamplesN);
+				for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
+					StatV.Add(LabelN < Node->PartitionV.Len() ? Node->PartitionV[LabelN] : 0);
+				}
+				TVec<int64> CountV;
+				for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+					if (AttrOffV[AttrN] == -1) { continue; }
+					Node->GetCountV(AttrN, Schema.GetValsN(AttrN), LabelsN, CountV);
+					StatV.AddV(CountV);
+				}
 			}
 		}
 	}
+	int TTreeView::GetLeaf(PExample Example) const {
+		int NodeN = 0;
+		while (CndAttrV[NodeN] != -1) {
+			const int AttrN = CndAttrV[NodeN];
+			NodeN = FstChildV[NodeN]+(NumericV[AttrN] ? (Example->GetNum(AttrN) <= ValV[NodeN] ? 0 : 1) : Example->GetVal(AttrN));
+		}
+		return NodeN;
+	}
+	TLabel TTreeView::Classify(PExample Example) const {
+		const int StatOff = StatOffV[GetLeaf(Example)];
+		const int64 ExamplesN = StatV[StatOff];
+		const int AttrsN = AttrOffV.Len();
+		// n(x_k) for k=0,1,...,AttrsN-1; see THoeffdingTree::NaiveBayes 
+		TVec<int64> SubExamplesN(AttrsN);
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+			SubExamplesN[AttrN] = 0;
+			if (AttrOffV[AttrN] == -1) { continue; }
+			const int Off = StatOff+AttrOffV[AttrN]+Example->GetVal(AttrN)*LabelsN;
+			for (int LabelN = 0; LabelN < LabelsN; ++LabelN) { SubExamplesN[AttrN] += StatV[Off+LabelN]; }
+		}
+		int MxLabel = 0;
+		double MxProb = 0.0;
+		for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
+			const double pc = (StatV[StatOff+1+LabelN]+1.0)/(ExamplesN+LabelsN);
+			double pk = pc;
+			for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
+				if (AttrOffV[AttrN] == -1) { continue; }
+				const int64 Cnt = StatV[StatOff+AttrOffV[AttrN]+Example->GetVal(AttrN)*LabelsN+LabelN];
+				if (Cnt > 0) { pk *= (2.0*pc+Cnt)/(pc*(2+SubExamplesN[AttrN])); }
+			}
+			if (MxProb < pk) { MxProb = pk; MxLabel = LabelN; }
+		}
+		return MxLabel;
+	}
+	double TTreeView::Predict(PExample Example) const {
+		return ValV[GetLeaf(Example)];
+	}
 
 	/////////////////////////////////
-	// Hoeffding-Tree
-	double THoeffdingTree::Predict(PExample Example) const { // Regression
-		PNode CrrNode = Root;
-		while (CrrNode->CndAttrIdx != -1) {
-			const TAttrType AttrType = AttrManV.GetVal(CrrNode->CndAttrIdx).Type;
-			if (AttrType == TAttrType::DISCRETE) {
-				CrrNode = CrrNode->ChildrenV.GetVal(Example->AttributesV.GetVal(CrrNode->CndAttrIdx).Value);
-			} else { // Numeric attribute 
-				const double Val = Example->AttributesV.GetVal(CrrNode->CndAttrIdx).Num;
-				const int Idx = Val <= CrrNode->Val;
-				CrrNode = CrrNode->ChildrenV.GetVal(Idx);
+	// Epoch-Based-Snapshot-Publication
+	TViewPub::TViewPub(const int& MxReadersN) : SlotsN(MxReadersN), CrrView(nullptr), Epoch(1) {
+		SlotV = new TSlot[SlotsN];
+	}
+	TViewPub::~TViewPub() {
+		// NOTE: Readers must be gone by now 
+		delete CrrView.load();
+		for (auto It = RetiredV.begin(); It != RetiredV.end(); ++It) { delete It->second; }
+		delete [] SlotV;
+	}
+	void TViewPub::Publish(TTreeView* View) {
+		TTreeView* OldView = CrrView.exchange(View);
+		// Readers that pin from now on see the new view 
+		const uint64 RetireEpoch = Epoch.fetch_add(1)+1;
+		if (OldView != nullptr) { RetiredV.push_back(std::make_pair(RetireEpoch, OldView)); }
+		Reclaim();
+	}
+	int TViewPub::Register() {
+		for (int SlotN = 0; SlotN < SlotsN; ++SlotN) {
+			bool UsedP = false;
+			if (SlotV[SlotN].UsedP.compare_exchange_strong(UsedP, true)) { return SlotN; }
+		}
+		throw TDtExcept::New("Too many snapshot readers.");
+	}
+	void TViewPub::Unregister(const int& SlotN) {
+		SlotV[SlotN].PinEpoch.store(0);
+		SlotV[SlotN].UsedP.store(false);
+	}
+	const TTreeView* TViewPub::Pin(const int& SlotN) {
+		SlotV[SlotN].PinEpoch.store(Epoch.load());
+		return CrrView.load();
+	}
+	// A view replaced in epoch E can only be held by readers that pinned before E 
+	void TViewPub::Reclaim() {
+		uint64 MnEpoch = Epoch.load();
+		for (int SlotN = 0; SlotN < SlotsN; ++SlotN) {
+			const uint64 PinEpoch = SlotV[SlotN].PinEpoch.load();
+			if (PinEpoch != 0 && PinEpoch < MnEpoch) { MnEpoch = PinEpoch; }
+		}
+		int KeepN = 0;
+		for (int RetiredN = 0; RetiredN < (int)RetiredV.size(); ++RetiredN) {
+			if (RetiredV[RetiredN].first <= MnEpoch) {
+				delete RetiredV[RetiredN].second;
+			} else { RetiredV[KeepN++] = RetiredV[RetiredN]; }
+		}
+		RetiredV.resize(KeepN);
+	}
+
+	/////////////////////////////////
+	// Sweep-Pool
+	TSweepPool::TSweepPool(const int& WorkersN) : Job(nullptr), JobN(0), WantN(0), BusyN(0), StopP(false) {
+		for (int WorkerN = 0; WorkerN < WorkersN; ++WorkerN) { WorkerV.push_back(std::thread(&TSweepPool::Work, this)); }
+	}
+	TSweepPool::~TSweepPool() {
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			StopP = true;
+		}
+		WorkCond.notify_all();
+		for (auto It = WorkerV.begin(); It != WorkerV.end(); ++It) { It->join(); }
+	}
+	void TSweepPool::Run(const std::function<void()>& Job_, const int& ThreadsN) {
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Job = &Job_; ++JobN; ErrStr.clear();
+			WantN = TMath::Mn<int>(ThreadsN-1, (int)WorkerV.size());
+		}
+		WorkCond.notify_all();
+		std::string RunErrStr; // workers may still run the job, so an error waits for them 
+		try {
+			Job_();
+		} catch (PExcept Except) {
+			RunErrStr = Except->GetMsgStr().CStr();
+		}
+		std::unique_lock<std::mutex> Lock(Mutex);
+		WantN = 0; // the work is handed out by now; late workers would find nothing 
+		DoneCond.wait(Lock, [this] { return BusyN == 0; });
+		Job = nullptr;
+		if (RunErrStr.empty()) { RunErrStr.swap(ErrStr); }
+		if (!RunErrStr.empty()) { throw TDtExcept::New(RunErrStr.c_str()); }
+	}
+	void TSweepPool::Work() {
+		uint64 DoneJobN = 0;
+		std::unique_lock<std::mutex> Lock(Mutex);
+		while (true) {
+			WorkCond.wait(Lock, [this, DoneJobN] { return StopP || (JobN != DoneJobN && WantN > 0); });
+			if (StopP) { return; }
+			DoneJobN = JobN; --WantN; ++BusyN;
+			const std::function<void()>* CrrJob = Job;
+			Lock.unlock();
+			std::string JobErrStr;
+			try {
+				(*CrrJob)();
+			} catch (PExcept Except) {
+				JobErrStr = Except->GetMsgStr().CStr();
 			}
+			Lock.lock();
+			if (!JobErrStr.empty() && ErrStr.empty()) { ErrStr = JobErrStr; }
+			if (--BusyN == 0) { DoneCond.notify_one(); }
 		}
+	}
+
+	/////////////////////////////////
+	// Hoeffding-Tree
+	double THoeffdingTree::Predict(PExample Example) const { // Regression
 		// Ikonomovska [Ikonomovska, 2012] trains perceptron in the leaves 
-		return CrrNode->Avg;
+		return GetLeaf(Root(), *Example)->Avg;
 	}
 	TLabel THoeffdingTree::Classify(PNode Node, PExample Example) const {
-		PNode CrrNode = Node;
-		while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
-		return Majority(CrrNode);
+		return GetLeaf(Node(), *Example)->PartitionV.GetMxValN();
 	}
 	TLabel THoeffdingTree::Classify(PExample Example) const { // Classification 
-		PNode CrrNode = Root;
-		while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
+		HT_PROFILE(Profiler, TPhase::CLASSIFY);
 		// return Majority(CrrNode);
-		return NaiveBayes(CrrNode, Example);
+		return NaiveBayes(GetLeaf(Root(), *Example), Example);
 	}
-	void THoeffdingTree::IncCounts(PNode Node, PExample Example) const {
-		Node->PartitionV.GetVal(Example->Label)++;
-		Node->ExamplesN++;
-		int AttrN = 0;
-		for (auto It = Example->AttributesV.BegI(); It != Example->AttributesV.EndI(); ++It) {
-			switch (AttrManV.GetVal(It->Id).Type) {
-			case TAttrType::DISCRETE: {
-				TTriple<TInt, TInt, TInt> Idx(It->Id, It->Value, Example->Label);
-				if (Node->Counts.IsKey(Idx)) {
-					Node->Counts.GetDat(Idx)++;
-				} else {
-					Node->Counts.AddDat(Idx, 1);
-				}
-				break;										}
-			case TAttrType::CONTINUOUS:
-				Node->HistH.GetDat(AttrN).IncCls(Example, AttrN, IdGen);
-				break;
-			default:
-				EFailR("Attribute type not supported.");
+	template <bool DiscP, bool NumP>
+	void THoeffdingTree::IncCountsT(PNode Node, PExample Example) const {
+		Node->PartitionV.Inc(Example->Label);
+		Node->ExamplesN++; Node->DirtyN++;
+		// Only the listed attributes; default values of discrete attributes are counted implicitly, see TNode::GetCountV 
+		const int AttrsN = Example->AttributesV.Len();
+		if (DiscP && NumP && AttrsN == Schema->GetAttrsN()) { // every attribute is listed, at its own index 
+			const TIntV& DiscAttrV = Schema->GetDiscAttrV();
+			for (int DiscN = 0; DiscN < DiscAttrV.Len(); ++DiscN) { IncDiscCount(Node, Example, Example->AttributesV[DiscAttrV[DiscN]]); }
+			const TIntV& NumAttrV = Schema->GetNumAttrV();
+			for (int NumN = 0; NumN < NumAttrV.Len(); ++NumN) { Node->HistH.GetDat(NumAttrV[NumN]).IncCls(Example, NumAttrV[NumN], IdGen); }
+			return;
+		}
+		for (int AttrIdx = 0; AttrIdx < AttrsN; ++AttrIdx) {
+			const TAttribute& Attr = Example->AttributesV[AttrIdx];
+			if (DiscP && (!NumP || !Schema->IsNumeric(Attr.Id))) {
+				IncDiscCount(Node, Example, Attr);
+			} else {
+				Node->HistH.GetDat(Attr.Id).IncCls(Example, Attr.Id, IdGen);
 			}
-			++AttrN;
 		}
 	}
-	void THoeffdingTree::DecCounts(PNode Node, PExample Example) const {
-		AssertR(Node->PartitionV.GetVal(Example->Label)-- >= 0, "Negative partition count.");
-		AssertR(--Node->ExamplesN >= 0, "Negative example count.");
-		int AttrN = 0;
-		for (auto It = Example->AttributesV.BegI(); It != Example->AttributesV.EndI(); ++It) {
-			switch (AttrManV.GetVal(It->Id).Type) {
-			case TAttrType::DISCRETE: {
-				TTriple<TInt, TInt, TInt> Idx(It->Id, It->Value, Example->Label);
-				if (Node->Counts.IsKey(Idx)) {
-					AssertR(Node->Counts.GetDat(Idx)-- >= 0, "Negative id-value-label triple count.");
-				} else {
-					Print(Example);
-					printf("Example ID: %d; Node ID: %d; Node examples: %d\n", Example->LeafId, Node->Id, Node->ExamplesN);
-					if(!IsLeaf(Node)) { printf("Node test attribute: %s\n", AttrManV.GetVal(Node->CndAttrIdx).Nm.CStr()); }
-					printf("Problematic attribute: %s = %s\n", AttrManV.GetVal(It->Id).Nm.CStr(), AttrManV.GetVal(It->Id).InvAttrH.GetDat(It->Value).CStr());
-					FailR("Corresponding id-value-label triple is missing in counts hashtable."); // NOTE: For dbugging purposes; this fail probably indicates serious problems 
-				}
-				break;										}
-			case TAttrType::CONTINUOUS:
-				Node->HistH.GetDat(AttrN).DecCls(Example, AttrN);
-				break;
-			default:
-				FailR("Attribute type not supported.");
+	void THoeffdingTree::IncDiscCount(PNode Node, PExample Example, const TAttribute& Attr) const {
+		if (Attr.Value == 0) { return; }
+		const int LabelsN = Schema->GetLabelsN();
+		TCountV& CountV = Node->CountH.AddDat(Attr.Id);
+		if (CountV.Empty()) { CountV.Gen(Schema->GetValsN(Attr.Id)*LabelsN); }
+		CountV.Inc(Attr.Value*LabelsN+Example->Label);
+	}
+	template <bool DiscP, bool NumP>
+	void THoeffdingTree::DecCountsT(PNode Node, PExample Example) const {
+		Node->PartitionV.Dec(Example->Label);
+		--Node->ExamplesN; // outside of the assertion, which release builds drop 
+		AssertR(Node->ExamplesN >= 0, "Negative example count.");
+		Node->DirtyN++;
+		const int AttrsN = Example->AttributesV.Len();
+		if (DiscP && NumP && AttrsN == Schema->GetAttrsN()) { // every attribute is listed, at its own index 
+			const TIntV& DiscAttrV = Schema->GetDiscAttrV();
+			for (int DiscN = 0; DiscN < DiscAttrV.Len(); ++DiscN) { DecDiscCount(Node, Example, Example->AttributesV[DiscAttrV[DiscN]]); }
+			const TIntV& NumAttrV = Schema->GetNumAttrV();
+			for (int NumN = 0; NumN < NumAttrV.Len(); ++NumN) { Node->HistH.GetDat(NumAttrV[NumN]).DecCls(Example, NumAttrV[NumN]); }
+			return;
+		}
+		for (int AttrIdx = 0; AttrIdx < AttrsN; ++AttrIdx) {
+			const TAttribute& Attr = Example->AttributesV[AttrIdx];
+			if (DiscP && (!NumP || !Schema->IsNumeric(Attr.Id))) {
+				DecDiscCount(Node, Example, Attr);
+			} else {
+				Node->HistH.GetDat(Attr.Id).DecCls(Example, Attr.Id);
 			}
-			++AttrN;
 		}
 	}
-	bool THoeffdingTree::IsAltSplitIdx(PNode Node, const int& AttrIdx) const {
+	void THoeffdingTree::DecDiscCount(PNode Node, PExample Example, const TAttribute& Attr) const {
+		if (Attr.Value == 0) { return; }
+		const int KeyId = Node->CountH.GetKeyId(Attr.Id);
+		if (KeyId != -1) {
+			Node->CountH[KeyId].Dec(Attr.Value*Schema->GetLabelsN()+Example->Label);
+		} else {
+			Print(Example);
+			printf("Example ID: %d; Node ID: %d; Node examples: %s\n", Example->LeafId, Node->Id, TUInt64::GetStr(Node->ExamplesN).CStr());
+			if(!IsLeaf(Node)) { printf("Node test attribute: %s\n", Schema->GetAttrNm(Node->CndAttrIdx).CStr()); }
+			printf("Problematic attribute: %s = %s\n", Schema->GetAttrNm(Attr.Id).CStr(), Schema->GetValNm(Attr.Id, Attr.Value).CStr());
+			FailR("Counts of the attribute are missing in the node."); // NOTE: For dbugging purposes; this fail probably indicates serious problems 
+		}
+	}
+	// Pick the kernel instantiations for the schema and the heuristic 
+	void THoeffdingTree::InitKernels() {
+		const bool DiscP = Schema->GetDiscAttrsN() > 0, NumP = Schema->GetNumAttrsN() > 0;
+		const bool GiniP = AttrHeuristic == TAttrHeuristic::GINI_GAIN;
+		if (!NumP) {
+			IncCountsFun = &THoeffdingTree::IncCountsT<true, false>;
+			DecCountsFun = &THoeffdingTree::DecCountsT<true, false>;
+			BestClsAttrFun = GiniP ? &TNode::BestClsAttrT<TGiniGainHeur, true, false> : &TNode::BestClsAttrT<TInfoGainHeur, true, false>;
+		} else if (!DiscP) {
+			IncCountsFun = &THoeffdingTree::IncCountsT<false, true>;
+			DecCountsFun = &THoeffdingTree::DecCountsT<false, true>;
+			BestClsAttrFun = GiniP ? &TNode::BestClsAttrT<TGiniGainHeur, false, true> : &TNode::BestClsAttrT<TInfoGainHeur, false, true>;
+		} else {
+			IncCountsFun = &THoeffdingTree::IncCountsT<true, true>;
+			DecCountsFun = &THoeffdingTree::DecCountsT<true, true>;
+			BestClsAttrFun = GiniP ? &TNode::BestClsAttrT<TGiniGainHeur, true, true> : &TNode::BestClsAttrT<TInfoGainHeur, true, true>;
+		}
+	}
+	TBstAttr THoeffdingTree::BestAttr(PNode Leaf, const TIntV& BannedAttrV) const {
+		if (TaskType == TTaskType::REGRESSION) { return Leaf->BestRegAttr(*Schema); }
+		return (Leaf()->*BestClsAttrFun)(*Schema, BannedAttrV);
+	}
+	bool THoeffdingTree::IsAltSplitIdx(const TNode* Node, const int& AttrIdx) const {
 		for (auto It = Node->AltTreesV.BegI(); It != Node->AltTreesV.EndI(); ++It) {
 			if ((*It)->CndAttrIdx == AttrIdx) { // || IsAltSplitIdx((*It)->Root, AttrIdx)) {
 				return true;
@@ -644,41 +1200,140 @@ namespace TDatastream {
 		}
 		return false;
 	}
+	void THoeffdingTree::SetRecheck(const int& RecheckN_, const int& ThreadsN) {
+		EAssertR(RecheckN_ >= 0 && ThreadsN >= 0, "Recheck period and the number of threads must be nonnegative.");
+		RecheckN = RecheckN_;
+		SweepThreadsN = ThreadsN > 0 ? ThreadsN : TMath::Mx<int>(1, (int) std::thread::hardware_concurrency());
+		if (SweepPool != nullptr && SweepPool->GetThreadsN() == SweepThreadsN) { return; }
+		delete SweepPool;
+		SweepPool = SweepThreadsN > 1 ? new TSweepPool(SweepThreadsN-1) : nullptr;
+	}
+	void THoeffdingTree::SetAltBudget(const int& MxNodeAltsN_, const int& MxAltsN_, const uint64& MxAltMemB_, const int& MxAltLostN_) {
+		EAssertR(MxNodeAltsN_ >= 0 && MxAltsN_ >= 0 && MxAltLostN_ >= 0, "Alternate tree limits must be nonnegative.");
+		MxNodeAltsN = MxNodeAltsN_; MxAltsN = MxAltsN_; MxAltMemB = MxAltMemB_; MxAltLostN = MxAltLostN_;
+	}
+	// Only alternates hanging off the main tree are evicted, each with everything below it; the worst go first: most rounds 
+	// lost in a row, then lowest accuracy in the current round, then largest 
+	void THoeffdingTree::EnforceAltBudget() {
+		struct TAltInfo {
+			TNode* Parent; TNode* Alt; int LostN; double Acc; uint64 MemUsed;
+			bool operator<(const TAltInfo& Info) const {
+				if (LostN != Info.LostN) { return LostN > Info.LostN; }
+				if (Acc != Info.Acc) { return Acc < Info.Acc; }
+				return MemUsed > Info.MemUsed;
+			}
+		};
+		std::vector<TAltInfo> AltV;
+		uint64 AltMemUsed = 0;
+		int AltsN = 0;
+		std::vector<std::pair<TNode*, bool> > NodeS; // node, in an alternate tree 
+		NodeS.push_back(std::make_pair(Root(), false));
+		while (!NodeS.empty()) {
+			TNode* CrrNode = NodeS.back().first; const bool InAltP = NodeS.back().second; NodeS.pop_back();
+			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) { NodeS.push_back(std::make_pair((*It)(), InAltP)); }
+			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) {
+				++AltsN;
+				NodeS.push_back(std::make_pair((*It)(), true));
+				if (InAltP || MxAltMemB == 0) { continue; }
+				TNode* Alt = (*It)();
+				TAltInfo Info = { CrrNode, Alt, Alt->LostN, (Alt->Correct+1.0)/(Alt->All+2.0), GetSubtreeMemUsed(Alt) };
+				AltV.push_back(Info);
+				AltMemUsed += Info.MemUsed;
+			}
+		}
+		AltTreesN = AltsN;
+		if (MxAltMemB == 0 || AltMemUsed <= MxAltMemB) { return; }
+		std::sort(AltV.begin(), AltV.end());
+		for (auto It = AltV.begin(); It != AltV.end() && AltMemUsed > MxAltMemB; ++It) {
+			TVec<PNode>& AltTreesV = It->Parent->AltTreesV;
+			for (int AltN = 0; AltN < AltTreesV.Len(); ++AltN) {
+				if (AltTreesV[AltN]() != It->Alt) { continue; }
+				HT_TRACE(TTraceEvent::ALT_DROP, It->Parent->Id, It->Alt->Id, -1.0);
+				AltTreesV.Del(AltN);
+				break;
+			}
+			AltMemUsed -= It->MemUsed;
+		}
+		// recount; evicted alternates took their nested alternates with them 
+		AltsN = 0;
+		TSStack<PNode> AltS; AltS.Push(Root);
+		while (!AltS.Empty()) {
+			PNode CrrNode = AltS.Top(); AltS.Pop();
+			AltsN += CrrNode->AltTreesV.Len();
+			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) { AltS.Push(*It); }
+			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) { AltS.Push(*It); }
+		}
+		AltTreesN = AltsN;
+	}
+	uint64 THoeffdingTree::GetSubtreeMemUsed(const TNode* Node) {
+		uint64 MemUsed = 0;
+		TSStack<const TNode*> NodeS;
+		NodeS.Push(Node);
+		while (!NodeS.Empty()) {
+			const TNode* CrrNode = NodeS.Top(); NodeS.Pop();
+			MemUsed += CrrNode->GetMemUsed();
+			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) { NodeS.Push((*It)()); }
+			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) { NodeS.Push((*It)()); }
+		}
+		return MemUsed;
+	}
+	// NOTE: Only nodes with RecheckN updates since their last check are evaluated. Evaluations only read node statistics 
+	// (BestClsAttrT moves the split value of leaves only), so they run in parallel on raw pointers; alternate trees are 
+	// grown afterwards, in traversal order 
 	void THoeffdingTree::CheckSplitValidityCls() { // Classification 
-		PNode CrrNode = Root;
-		TSStack<PNode> NodeS;
-		const int AttrsN = AttrManV.Len()-1; // Need -1 because AttrManV also manages class labels 
-		NodeS.Push(CrrNode);
-		// Depth-first tree traversal 
+		HT_PROFILE(Profiler, TPhase::DRIFT_CHECK);
+		HT_TRACE(TTraceEvent::DRIFT_CHECK, Root->Id, AltTreesN, 0.0);
+		EnforceAltBudget();
+		TVec<TNode*> CheckNodeV;
+		TSStack<TNode*> NodeS;
+		NodeS.Push(Root());
+		// Depth-first tree traversal, alternate trees included 
 		while (!NodeS.Empty()) {
-			CrrNode = NodeS.Top(); NodeS.Pop();
-			// Check split validity in the alternate trees 
+			TNode* CrrNode = NodeS.Top(); NodeS.Pop();
 			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) {
-				if (!IsLeaf(*It)) { NodeS.Push(*It); }
+				if ((*It)->CndAttrIdx != -1) { NodeS.Push((*It)()); }
 			}
-			// Push non-leaf children on the stack 
 			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) {
-				if (!IsLeaf(*It)) { NodeS.Push(*It); }
-			}
-			// Find the best two attributes among the remaining attributes --- must not use CrrSplitAttrIdx 
-			const int CrrSpltAttrIdx = CrrNode->CndAttrIdx;
-			TVec<TInt> CrrBannedAttrV; CrrBannedAttrV.Add(CrrSpltAttrIdx);
-			TBstAttr SpltAttr = CrrNode->BestClsAttr(AttrManV, CrrBannedAttrV);
-			CrrBannedAttrV.Clr(); CrrBannedAttrV.Add(SpltAttr.Val1.Val1);
-			TBstAttr AltAttr = CrrNode->BestClsAttr(AttrManV, CrrBannedAttrV);
-			const double EstG = SpltAttr.Val1.Val2 - AltAttr.Val1.Val2;
+				if ((*It)->CndAttrIdx != -1) { NodeS.Push((*It)()); }
+			}
+			if (CrrNode->CndAttrIdx != -1 && CrrNode->DirtyN >= RecheckN) { CheckNodeV.Add(CrrNode); CrrNode->DirtyN = 0; }
+		}
+		// Find the best two attributes among the remaining attributes --- must not use the current split attribute 
+		TVec<TBstAttr> SpltAttrV(CheckNodeV.Len()), AltAttrV(CheckNodeV.Len());
+		std::atomic<int> NextNodeN(0);
+		const std::function<void()> CheckNodes = [&]() {
+			TIntV BannedAttrV(1, 0);
+			for (int NodeN = NextNodeN++; NodeN < CheckNodeV.Len(); NodeN = NextNodeN++) {
+				TNode* CrrNode = CheckNodeV[NodeN];
+				BannedAttrV.Clr(false); BannedAttrV.Add(CrrNode->CndAttrIdx);
+				SpltAttrV[NodeN] = (CrrNode->*BestClsAttrFun)(*Schema, BannedAttrV);
+				BannedAttrV.Clr(false); BannedAttrV.Add(SpltAttrV[NodeN].Val1.Val1);
+				AltAttrV[NodeN] = (CrrNode->*BestClsAttrFun)(*Schema, BannedAttrV);
+			}
+		};
+		// NOTE: Threads pay off only for larger sweeps 
+		const int ThreadsN = TMath::Mn<int>(SweepThreadsN, CheckNodeV.Len()/16);
+		if (ThreadsN > 1 && SweepPool != nullptr) {
+			SweepPool->Run(CheckNodes, ThreadsN);
+		} else {
+			CheckNodes();
+		}
+		for (int NodeN = 0; NodeN < CheckNodeV.Len(); ++NodeN) {
+			TNode* CrrNode = CheckNodeV[NodeN];
+			const TBstAttr& SpltAttr = SpltAttrV[NodeN];
+			const double EstG = SpltAttr.Val1.Val2 - AltAttrV[NodeN].Val1.Val2;
 			// Does it make sense to split on this one?
+			if (MxAltsN > 0 && AltTreesN >= MxAltsN) { break; }
+			if (MxNodeAltsN > 0 && CrrNode->AltTreesV.Len() >= MxNodeAltsN) { continue; }
 			if (EstG >= 0 && SpltAttr.Val1.Val1 != -1 && SpltAttr.Val2.Val1 != -1 && !IsAltSplitIdx(CrrNode, SpltAttr.Val1.Val1)) {
 				// Hoeffding test
-				const double Eps = CrrNode->ComputeTreshold(SplitConfidence, AttrManV.GetVal(AttrsN).ValueV.Len());
+				const double Eps = CrrNode->ComputeTreshold(SplitConfidence, Schema->GetLabelsN(), AttrHeuristic);
 				if (EstG > Eps || (Eps < TieBreaking && EstG >= TieBreaking/2)) { // EstG >= TieBreaking/2 ?
 					// Grow alternate tree 
-					Print('-');
-					printf("Starting alternate tree for node splitting on `%s' with `%s' at root ; tie = %d\n", AttrManV.GetVal(CrrNode->CndAttrIdx).Nm.CStr(), AttrManV.GetVal(SpltAttr.Val1.Val1).Nm.CStr(), EstG <= Eps);
-					// Export("exports/titanic-"+TInt(ExportN++).GetStr()+".gv", TExportType::DOT);
-					const int LabelsN = AttrManV.GetVal(AttrManV.Len()-1).ValueV.Len();
-					PNode AltHt = TNode::New(LabelsN, CrrNode->UsedAttrs, AttrManV, IdGen->GetNextLeafId());
-					AltHt->Split(SpltAttr.Val1.Val1, AttrManV, IdGen);
+					HT_TRACE(TTraceEvent::ALT_START, CrrNode->Id, SpltAttr.Val1.Val1, EstG);
+					const int LabelsN = Schema->GetLabelsN();
+					PNode AltHt = TNode::New(LabelsN, CrrNode->UsedAttrs, *Schema, IdGen->GetNextLeafId(), TNodeType::LEAF, BinsN);
+					AltHt->Split(SpltAttr.Val1.Val1, *Schema, IdGen, BinsN);
 					CrrNode->AltTreesV.Add(AltHt);
 					++AltTreesN;
 				}
@@ -686,6 +1341,8 @@ namespace TDatastream {
 		}
 	}
 	void THoeffdingTree::ForgetCls(PExample Example) const { // Classification 
+		HT_PROFILE(Profiler, TPhase::FORGET);
+		HT_TRACE(TTraceEvent::FORGET, Example->LeafId, Example->BinId, 0.0);
 		PNode CrrNode = Root;
 		TSStack<PNode> NodeS;
 		NodeS.Push(CrrNode);
@@ -710,60 +1367,191 @@ namespace TDatastream {
 		}
 	}
 	void THoeffdingTree::ProcessLeafReg(PNode Leaf, PExample Example) { // Regression
-		Leaf->UpdateStats(Example);
-		// Leaf->ExamplesV.Add(Example);
-		const int AttrsN = Example->AttributesV.Len();
-		for (int AttrN = 0; AttrN < AttrsN; AttrN++) {
-			if (AttrManV.GetVal(AttrN).Type == TAttrType::CONTINUOUS) {
-				// TODO: Find an efficient way to compute s(A) from s(A1) and s(A2) if A1 and A2 parition A
-				Leaf->HistH.GetDat(AttrN).IncReg(Example, AttrN);
-				// EFailR("Current regression discretization is deprecated.");
+		{
+			HT_PROFILE(Profiler, TPhase::LEAF_UPDATE);
+			Leaf->UpdateStats(Example);
+			if (SubspaceN > 0 && Leaf->SubspaceV.Empty()) { InitSubspace(Leaf); }
+			// Leaf->ExamplesV.Add(Example);
+			const int AttrsN = Example->AttributesV.Len();
+			for (int AttrIdx = 0; AttrIdx < AttrsN; AttrIdx++) {
+				const int AttrN = Example->AttributesV[AttrIdx].Id;
+				if (Schema->GetType(AttrN) == TAttrType::CONTINUOUS) {
+					// TODO: Find an efficient way to compute s(A) from s(A1) and s(A2) if A1 and A2 parition A
+					Leaf->HistH.GetDat(AttrN).IncReg(Example, AttrN);
+					// EFailR("Current regression discretization is deprecated.");
+				}
 			}
 		}
 		if (Leaf->ExamplesN % GracePeriod == 0 && Leaf->Std() > 0) { // Regression
 			// See if we can get variance reduction 
-			TBstAttr SplitAttr = Leaf->BestAttr(AttrManV, TaskType);
+			TBstAttr SplitAttr;
+			{
+				HT_PROFILE(Profiler, TPhase::SPLIT_EVAL);
+				SplitAttr = BestAttr(Leaf);
+			}
 			// Pass 2, because TMath::Log2(2) = 1; since r lies in [0,1], we have R=1; see also PhD thesis [Ikonomovska, 2012] and [Ikonomovska et al., 2011]
 			const double Eps = Leaf->ComputeTreshold(SplitConfidence, 2);
 			const double EstG = SplitAttr.Val3;
-			printf("EstG = %f\n", EstG);
 			if ((EstG < 1.0-Eps /*|| Eps < TieBreaking*/) && Leaf->UsedAttrs.SearchForw(SplitAttr.Val1.Val1, 0) < 0) {
-				printf("[DEBUG] Selected split attribute: %d\n", SplitAttr.Val1.Val1);
-				Leaf->Split(SplitAttr.Val1.Val1, AttrManV, IdGen);
+				HT_TRACE(TTraceEvent::SPLIT, Leaf->Id, SplitAttr.Val1.Val1, EstG);
+				HT_PROFILE(Profiler, TPhase::SPLIT);
+				Leaf->Split(SplitAttr.Val1.Val1, *Schema, IdGen, BinsN);
+				StructChangeP = true;
 			}
 		}
 	}
 	void THoeffdingTree::ProcessLeafCls(PNode Leaf, PExample Example) { // Classification 
 		const int AttrsN = Example->AttributesV.Len();
-		IncCounts(Leaf, Example);
+		{
+			HT_PROFILE(Profiler, TPhase::LEAF_UPDATE);
+			IncCounts(Leaf, Example);
+			if (SubspaceN > 0 && Leaf->SubspaceV.Empty()) { InitSubspace(Leaf); }
+		}
 		if (Leaf->ExamplesN % GracePeriod == 0 && Leaf->ComputeEntropy() > 0.65) {
-			TBstAttr SplitAttr = Leaf->BestAttr(AttrManV, TaskType);
+			TBstAttr SplitAttr;
+			{
+				HT_PROFILE(Profiler, TPhase::SPLIT_EVAL);
+				SplitAttr = BestAttr(Leaf);
+			}
 			const double EstG = SplitAttr.Val3;
-			const double Eps = Leaf->ComputeTreshold(SplitConfidence, AttrManV.GetVal(AttrsN).ValueV.Len());
+			const double Eps = Leaf->ComputeTreshold(SplitConfidence, Schema->GetLabelsN(), AttrHeuristic);
 			if (SplitAttr.Val1.Val1 != -1 && (EstG > Eps || (EstG <= Eps && Eps < TieBreaking))) {
-				printf("[DEBUG] best = %d :: tie = %d\n", EstG > Eps, EstG <= Eps && Eps < TieBreaking);
-				printf("[DEBUG] t = %f :: n = %d\n", Eps, Leaf->ExamplesN);
-				printf("[DEBUG] Splitting at %d examples on attribute `%s' with confidence %f\n", Leaf->ExamplesN, AttrManV.GetVal(SplitAttr.Val1.Val1).Nm.CStr(), 1.0-SplitConfidence);
-				if (Leaf->UsedAttrs.Len() > 0) {
-					printf("[DEBUG] Previous attribute = %d; so far used %d attributes on this path.\n", Leaf->UsedAttrs.Last(), Leaf->UsedAttrs.LastValN()+1);
+				HT_TRACE(TTraceEvent::SPLIT, Leaf->Id, SplitAttr.Val1.Val1, EstG);
+				HT_PROFILE(Profiler, TPhase::SPLIT);
+				Leaf->Split(SplitAttr.Val1.Val1, *Schema, IdGen, BinsN);
+				StructChangeP = true;
+			}
+		}
+	}
+	double THoeffdingTree::Process(PExample Example, const bool& PredP) {
+		HT_PROFILE(Profiler, TPhase::PROCESS);
+		// The evaluator scores the example with the same prediction, so evaluation costs no extra traversal 
+		double Pred = 0.0;
+		double* PredPt = PredP || !Eval.Empty() ? &Pred : nullptr;
+		if (TaskType == TTaskType::CLASSIFICATION) {
+			ProcessCls(Example, PredPt);
+			if (!Eval.Empty()) { Eval->AddCls(Example->Label, (int) Pred); }
+		} else {
+			ProcessReg(Example, PredPt);
+			if (!Eval.Empty()) { Eval->AddReg(Example->Value, Pred); }
+		}
+		if (!Eval.Empty() && Eval->IsReportDue()) { Eval->Report(GetNodesN(), GetMemUsed()); }
+		if (!ViewPub.Empty() && (StructChangeP || (PubPeriod > 0 && ++PubExamplesN >= PubPeriod))) { Publish(); }
+		return Pred;
+	}
+	// NOTE: Leaf counts and split points come out the same as with one example at a time, since every leaf sees its examples
+	// in stream order and checks for a split at the same counts; a split only changes where the rest of the leaf's group goes.
+	// In test mode the examples are scored before the batch is learned, which only matters for the root's unused accuracy 
+	void THoeffdingTree::ProcessBatch(const TVec<PExample>& ExampleV) {
+		// Regression ignores CVFDT, so only its classification needs the window; a leaf draws its subspace when it learns its
+		// first example, and the bins of numeric attributes take their IDs, which forgetting compares, in the order of updates 
+		const bool CvfdtP = TaskType == TTaskType::CLASSIFICATION && DriftMode == TDriftMode::CVFDT;
+		if (!Eval.Empty() || SubspaceN > 0 || DriftMode == TDriftMode::HAT || (CvfdtP && Schema->GetNumAttrsN() > 0)) {
+			for (int ExampleN = 0; ExampleN < ExampleV.Len(); ++ExampleN) { Process(ExampleV[ExampleN], false); }
+			return;
+		}
+		HT_PROFILE(Profiler, TPhase::PROCESS);
+		if (CvfdtP) {
+			ProcessBatchCvfdt(ExampleV);
+		} else {
+			std::vector<std::pair<TNode*, int> > LeafV; // leaf, example 
+			LeafV.reserve(ExampleV.Len());
+			{
+				HT_PROFILE(Profiler, TPhase::ROUTE);
+				for (int ExampleN = 0; ExampleN < ExampleV.Len(); ++ExampleN) {
+					if (TaskType == TTaskType::CLASSIFICATION && TestMode(Root)) { SelfEval(Root, ExampleV[ExampleN]); continue; }
+					LeafV.push_back(std::make_pair(GetLeaf(Root(), *ExampleV[ExampleN]), ExampleN));
+				}
+				// Examples of a leaf stay in stream order, and leaves come in the order of their first example 
+				std::sort(LeafV.begin(), LeafV.end());
+			}
+			std::vector<std::pair<int, int> > GroupV; // first example, first pair 
+			for (int PairN = 0; PairN < (int) LeafV.size(); ++PairN) {
+				if (PairN == 0 || LeafV[PairN].first != LeafV[PairN-1].first) { GroupV.push_back(std::make_pair(LeafV[PairN].second, PairN)); }
+			}
+			std::sort(GroupV.begin(), GroupV.end());
+			for (auto It = GroupV.begin(); It != GroupV.end(); ++It) {
+				TNode* Leaf = LeafV[It->second].first;
+				for (int PairN = It->second; PairN < (int) LeafV.size() && LeafV[PairN].first == Leaf; ++PairN) {
+					const PExample& Example = ExampleV[LeafV[PairN].second];
+					TNode* CrrLeaf = GetLeaf(Leaf, *Example); // the leaf may have split on an earlier example of the group 
+					if (TaskType == TTaskType::CLASSIFICATION) { ProcessLeafCls(CrrLeaf, Example); }
+					else { ProcessLeafReg(CrrLeaf, Example); }
+				}
+			}
+		}
+		if (!ViewPub.Empty() && (StructChangeP || (PubPeriod > 0 && (PubExamplesN += ExampleV.Len()) >= PubPeriod))) { Publish(); }
+	}
+	// NOTE: The window, forgetting, internal nodes, alternate trees, and self-evaluation go one example at a time as in 
+	// ProcessCls; only the updates of main-tree leaves are queued, per leaf. A leaf learns its queue before it is forgotten 
+	// from, and as soon as the queue reaches its next split check, so it splits (and takes node IDs) at the same position 
+	// in the stream. A node about to self-evaluate or swap reads or drops whole subtrees, so all the queues are learned first 
+	void THoeffdingTree::ProcessBatchCvfdt(const TVec<PExample>& ExampleV) {
+		std::map<TNode*, std::vector<int> > LeafQ; // leaf, queued examples in stream order 
+		auto FlushLeaf = [&](TNode* Leaf) {
+			auto It = LeafQ.find(Leaf);
+			if (It == LeafQ.end()) { return; }
+			for (auto ExampleIt = It->second.begin(); ExampleIt != It->second.end(); ++ExampleIt) { ProcessLeafCls(Leaf, ExampleV[*ExampleIt]); }
+			LeafQ.erase(It);
+		};
+		auto FlushAll = [&]() {
+			for (auto It = LeafQ.begin(); It != LeafQ.end(); ++It) {
+				for (auto ExampleIt = It->second.begin(); ExampleIt != It->second.end(); ++ExampleIt) { ProcessLeafCls(It->first, ExampleV[*ExampleIt]); }
+			}
+			LeafQ.clear();
+		};
+		for (int ExampleN = 0; ExampleN < ExampleV.Len(); ++ExampleN) {
+			const PExample& Example = ExampleV[ExampleN];
+			ExampleQ.Push(Example);
+			if (ExampleQ.Len() > WindowSize) { // INVARIANT: ExampleQ.Len() <= WindowSize+1
+				PExample LastExample = ExampleQ.Top();
+				ExampleQ.Pop(); // Delete it from the window 
+				FlushLeaf(GetLeaf(Root(), *LastExample)); // the only leaf of the main tree it can be forgotten from 
+				ForgetCls(LastExample); // Update sufficient statistics 
+			}
+			int MxId = 0;
+			TSStack<PNode> NodeS;
+			NodeS.Push(Root);
+			PNode MainNode = Root; // next node on the path of the main tree 
+			while (!NodeS.Empty()) {
+				PNode CrrNode = NodeS.Top(); NodeS.Pop();
+				if (IsLeaf(CrrNode)) { // Leaf node
+					MxId = TMath::Mx<int>(MxId, CrrNode->Id);
+					if (CrrNode != MainNode) { ProcessLeafCls(CrrNode, Example); continue; } // alternate trees learn at once 
+					std::vector<int>& QueueV = LeafQ[CrrNode()];
+					QueueV.push_back(ExampleN);
+					if ((CrrNode->ExamplesN+(int64) QueueV.size()) % GracePeriod == 0) { FlushLeaf(CrrNode()); } // the last one checks for a split 
+				} else {
+					if (CrrNode->All > 0 || CrrNode->TestModeN >= 10000) { FlushAll(); } // TestMode may self-evaluate or swap 
+					if (TestMode(CrrNode)) {
+						SelfEval(CrrNode, Example);
+					} else {
+						IncCounts(CrrNode, Example); // Update sufficient statistics 
+						PNode NextNode = GetNextNodeCls(CrrNode, Example);
+						if (CrrNode == MainNode) { MainNode = NextNode; }
+						NodeS.Push(NextNode);
+						for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) {
+							NodeS.Push(*It);
+						}
+					}
 				}
-				Leaf->Split(SplitAttr.Val1.Val1, AttrManV, IdGen);
+			}
+			Example->SetLeafId(TMath::Mx<int>(MxId, Example->LeafId));
+			if (Root->HistH.Empty()) { Example->SetBinId(IdGen->GetNextBinId()); } /* Hack */
+			if (++DriftExamplesN >= DriftCheck) { // the check reads internal nodes only 
+				DriftExamplesN = 0;
+				CheckSplitValidityCls();
 			}
 		}
+		FlushAll();
 	}
-	void THoeffdingTree::ProcessCls(PExample Example) {
-		//////
-		//TStr FNm = ConceptDriftP ? "err-cvfdt.dat" : "err-vfdt.dat";
-		//Salpha = 0.995*Salpha+(Example->Label != Classify(Example));
-		//Nalpha = 0.995*Nalpha+1;
-		//if (Root->TestModeN == 9999) {
-		//	PSOut FOut = TFOut::New(FNm, true);
-		//	FOut->PutFlt(Salpha/Nalpha); FOut->PutLn();
-		//}
-		//////
+	void THoeffdingTree::ProcessCls(PExample Example, double* Pred) {
 		PNode CrrNode = Root;
 		int MxId = 0;
-		if (ConceptDriftP) {
+		if (DriftMode == TDriftMode::HAT) {
+			ProcessHat(Root, Example, false, Pred);
+			if (++DriftExamplesN >= DriftCheck) { DriftExamplesN = 0; EnforceAltBudget(); } // swaps drop nested alternates uncounted 
+		} else if (DriftMode == TDriftMode::CVFDT) {
 			ExampleQ.Push(Example);
 			if (ExampleQ.Len() > WindowSize) { // INVARIANT: ExampleQ.Len() <= WindowSize+1
 				PExample LastExample = ExampleQ.Top();
@@ -772,17 +1560,22 @@ namespace TDatastream {
 			}
 			TSStack<PNode> NodeS;
 			NodeS.Push(CrrNode);
+			PNode MainNode = Root; // next node on the path of the main tree; alternate trees don't predict 
 			while (!NodeS.Empty()) {
 				CrrNode = NodeS.Top(); NodeS.Pop();
 				if (IsLeaf(CrrNode)) { // Leaf node
 					MxId = TMath::Mx<int>(MxId, CrrNode->Id);
+					if (Pred != nullptr && CrrNode == MainNode) { *Pred = NaiveBayes(CrrNode, Example); }
 					ProcessLeafCls(CrrNode, Example);
 				} else {
 					if (TestMode(CrrNode)) { // Don't update counts --- sacrifice the next 2000 or so examples for internal evaluation 
+						if (Pred != nullptr && CrrNode == MainNode) { *Pred = NaiveBayes(GetLeaf(CrrNode(), *Example), Example); }
 						SelfEval(CrrNode, Example);
 					} else { // Everything goes as usual
 						IncCounts(CrrNode, Example); // Update sufficient statistics 
-						NodeS.Push(GetNextNodeCls(CrrNode, Example));
+						PNode NextNode = GetNextNodeCls(CrrNode, Example);
+						if (CrrNode == MainNode) { MainNode = NextNode; }
+						NodeS.Push(NextNode);
 						for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) {
 							NodeS.Push(*It);
 						}
@@ -797,19 +1590,160 @@ namespace TDatastream {
 			}
 		} else { // No concept drift detection 
 			if (!TestMode(CrrNode)) {
-				while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
+				{
+					HT_PROFILE(Profiler, TPhase::ROUTE);
+					CrrNode = GetLeaf(Root(), *Example);
+				}
+				if (Pred != nullptr) { *Pred = NaiveBayes(CrrNode, Example); }
 				ProcessLeafCls(CrrNode, Example);
 			} else {
+				if (Pred != nullptr) { *Pred = NaiveBayes(GetLeaf(CrrNode(), *Example), Example); } // as Classify does 
 				SelfEval(CrrNode, Example);
 			}
 		}
 	}
-	void THoeffdingTree::ProcessReg(PExample Example) {
-		PNode CrrNode = Root;
-		while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
+	void THoeffdingTree::ProcessReg(PExample Example, double* Pred) {
+		if (DriftMode == TDriftMode::HAT) {
+			MnRegVal = TMath::Mn<double>(MnRegVal, Example->Value);
+			MxRegVal = TMath::Mx<double>(MxRegVal, Example->Value);
+			ProcessHat(Root, Example, false, Pred);
+			if (++DriftExamplesN >= DriftCheck) { DriftExamplesN = 0; EnforceAltBudget(); } // swaps drop nested alternates uncounted 
+			return;
+		}
+		PNode CrrNode;
+		{
+			HT_PROFILE(Profiler, TPhase::ROUTE);
+			CrrNode = GetLeaf(Root(), *Example);
+		}
+		if (Pred != nullptr) { *Pred = CrrNode->Avg; }
 		ProcessLeafReg(CrrNode, Example);
 	}
+	// Hoeffding adaptive tree [Bifet and Gavalda, 2009]; every node monitors the error of its subtree with ADWIN, 
+	// so no examples are stored or forgotten 
+	double THoeffdingTree::ProcessHat(PNode Node, PExample Example, const bool& AltP, double* Pred) {
+		double Loss = 0.0;
+		if (IsLeaf(Node)) {
+			// Test first, then train 
+			const double LeafPred = TaskType == TTaskType::CLASSIFICATION ? (double) NaiveBayes(Node, Example) : Node->Avg;
+			Loss = GetLoss(LeafPred, Example);
+			if (Pred != nullptr) { *Pred = LeafPred; }
+			if (TaskType == TTaskType::CLASSIFICATION) {
+				ProcessLeafCls(Node, Example);
+			} else {
+				ProcessLeafReg(Node, Example);
+			}
+		} else {
+			Loss = ProcessHat(GetNextNodeCls(Node, Example), Example, AltP, Pred);
+		}
+		for (auto It = Node->AltTreesV.BegI(); It != Node->AltTreesV.EndI(); ++It) {
+			ProcessHat(*It, Example, true);
+		}
+		const double PrevErr = Node->Adwin.GetEst();
+		const bool ChangeP = Node->Adwin.Add(Loss);
+		if (ChangeP && Node->Adwin.GetEst() > PrevErr && !AltP && !IsAlt && !IsLeaf(Node) && Node->AltTreesV.Empty() &&
+			(MxAltsN == 0 || AltTreesN < MxAltsN)) {
+			// Error increased; grow an alternate tree that may use all attributes not used by the predecessors 
+			TIntV UsedAttrV = Node->UsedAttrs;
+			UsedAttrV.DelIfIn(Node->CndAttrIdx);
+			const int LabelsN = Schema->GetLabelsN();
+			Node->AltTreesV.Add(TNode::New(LabelsN, UsedAttrV, *Schema, IdGen->GetNextLeafId(), TNodeType::LEAF, BinsN));
+			++AltTreesN;
+			HT_TRACE(TTraceEvent::ALT_START, Node->Id, -1, Node->Adwin.GetEst());
+		} else if (!Node->AltTreesV.Empty()) {
+			PNode AltHt = Node->AltTreesV[0];
+			const int OrigN = Node->Adwin.GetWidth(), AltN = AltHt->Adwin.GetWidth();
+			if (OrigN >= HatMnWinLen && AltN >= HatMnWinLen) {
+				const double Diff = Node->Adwin.GetEst()-AltHt->Adwin.GetEst();
+				const double Bound = TMath::Sqrt(2.0*Node->Adwin.GetVariance()*TMath::Log(2.0/HatConfidence)*(1.0/OrigN+1.0/AltN));
+				if (Diff > Bound) { // Alternate tree is significantly better 
+					HT_TRACE(TTraceEvent::SWAP, Node->Id, AltHt->Id, Diff);
+					if (Node->Type == TNodeType::ROOT) { AltHt->Type = TNodeType::ROOT; }
+					*Node = *AltHt;
+					--AltTreesN;
+					StructChangeP = true;
+				} else if (-Diff > Bound) { // Alternate tree is significantly worse 
+					HT_TRACE(TTraceEvent::ALT_DROP, Node->Id, AltHt->Id, Diff);
+					Node->AltTreesV.Del(0);
+					--AltTreesN;
+				}
+			}
+		}
+		return Loss;
+	}
+	double THoeffdingTree::GetLoss(PNode Leaf, PExample Example) const {
+		return GetLoss(TaskType == TTaskType::CLASSIFICATION ? (double) NaiveBayes(Leaf, Example) : Leaf->Avg, Example);
+	}
+	double THoeffdingTree::GetLoss(const double& Pred, PExample Example) const {
+		if (TaskType == TTaskType::CLASSIFICATION) {
+			return Example->Label == (int) Pred ? 0.0 : 1.0;
+		}
+		// Absolute error, normalized by the range of the target variable 
+		const double Range = MxRegVal-MnRegVal;
+		return Range > 0 ? TMath::Mn<double>(1.0, TFlt::Abs(Example->Value-Pred)/Range) : 0.0;
+	}
+	// Draw a random subset of SubspaceN attributes (partial Fisher-Yates shuffle) 
+	void THoeffdingTree::InitSubspace(PNode Leaf) {
+		const int AttrsN = Schema->GetAttrsN();
+		const int SubN = TMath::Mn<int>(SubspaceN, AttrsN);
+		TIntV AttrV(AttrsN, 0);
+		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) { AttrV.Add(AttrN); }
+		for (int AttrN = 0; AttrN < SubN; ++AttrN) {
+			AttrV.Swap(AttrN, AttrN+Rnd.GetUniDevInt(AttrsN-AttrN));
+		}
+		AttrV.Trunc(SubN);
+		AttrV.Sort();
+		Leaf->SubspaceV = AttrV;
+	}
+	void THoeffdingTree::SetBinsN(const int& BinsN_) {
+		EAssertR(BinsN_ > 1, "Histograms need at least two bins.");
+		EAssertR(IsLeaf(Root) && Root->ExamplesN == 0, "Set the number of bins before the first example.");
+		BinsN = BinsN_;
+		Root = TNode::New(Schema->GetLabelsN(), TVec<TInt>(), *Schema, Root->Id, TNodeType::ROOT, BinsN);
+	}
+	void THoeffdingTree::EnableSnapshots(const int& MxReadersN, const int& PubPeriod_) {
+		ViewPub = TViewPub::New(MxReadersN);
+		PubPeriod = PubPeriod_;
+		Publish();
+	}
+	void THoeffdingTree::EnableEval(const TStr& CurveFNm, const int& ReportEvery, const int& WindowN) {
+		const int LabelsN = Schema->GetLabelsN();
+		Eval = TPreqEval::New(TaskType == TTaskType::CLASSIFICATION, LabelsN, FadingFactor, WindowN, ReportEvery, CurveFNm);
+	}
+	int THoeffdingTree::GetNodesN() const {
+		int NodesN = 0;
+		TSStack<PNode> NodeS;
+		NodeS.Push(Root);
+		while (!NodeS.Empty()) {
+			PNode CrrNode = NodeS.Top(); NodeS.Pop();
+			++NodesN;
+			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) { NodeS.Push(*It); }
+			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) { NodeS.Push(*It); }
+		}
+		return NodesN;
+	}
+	// Approximate; counts node statistics and the window of stored examples 
+	uint64 THoeffdingTree::GetMemUsed() const {
+		uint64 MemUsed = sizeof(THoeffdingTree);
+		TSStack<PNode> NodeS;
+		NodeS.Push(Root);
+		while (!NodeS.Empty()) {
+			PNode CrrNode = NodeS.Top(); NodeS.Pop();
+			MemUsed += CrrNode->GetMemUsed();
+			for (auto It = CrrNode->ChildrenV.BegI(); It != CrrNode->ChildrenV.EndI(); ++It) { NodeS.Push(*It); }
+			for (auto It = CrrNode->AltTreesV.BegI(); It != CrrNode->AltTreesV.EndI(); ++It) { NodeS.Push(*It); }
+		}
+		if (!ExampleQ.Empty()) {
+			MemUsed += (uint64) ExampleQ.Len()*(sizeof(TExample)+ExampleQ.Top()->AttributesV.Len()*sizeof(TAttribute));
+		}
+		return MemUsed;
+	}
+	void THoeffdingTree::Publish() {
+		ViewPub->Publish(new TTreeView(*this, ++ViewVersion));
+		StructChangeP = false;
+		PubExamplesN = 0;
+	}
 	void THoeffdingTree::SelfEval(PNode Node, PExample Example) const {
+		HT_PROFILE(Profiler, TPhase::SELF_EVAL);
 #ifdef GLIB_OK
 		Node->SeenH.AddDat(*Example, true);
 #else
@@ -817,15 +1751,11 @@ namespace TDatastream {
 #endif
 		// Update classification error for alternate trees 
 		for (auto It = Node->AltTreesV.BegI(); It != Node->AltTreesV.EndI(); ++It) {
-			PNode CrrNode = *It;
-			while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
-			(*It)->Correct += Example->Label == NaiveBayes(CrrNode, Example);
+			(*It)->Correct += Example->Label == NaiveBayes(GetLeaf((*It)(), *Example), Example);
 			++(*It)->All;
 		}
 		// Update classfication error for the main subtree 
-		PNode CrrNode = Node;
-		while (!IsLeaf(CrrNode)) { CrrNode = GetNextNodeCls(CrrNode, Example); }
-		Node->Correct += Example->Label == NaiveBayes(CrrNode, Example);
+		Node->Correct += Example->Label == NaiveBayes(GetLeaf(Node(), *Example), Example);
 		++Node->All;
 	}
 	bool THoeffdingTree::TestMode(PNode Node) {
@@ -834,23 +1764,27 @@ namespace TDatastream {
 			PNode BestAlt = Node;
 			const double Acc = 1.0*BestAlt->Correct/BestAlt->All; // Classification accuracy 
 			for (auto It = Node->AltTreesV.BegI(); It != Node->AltTreesV.EndI(); ++It) {
-				if (1.0*(*It)->Correct/(*It)->All > 1.0*BestAlt->Correct/BestAlt->All) { BestAlt = *It; }
+				const double AltAcc = 1.0*(*It)->Correct/(*It)->All;
+				(*It)->LostN = AltAcc > Acc ? 0 : (*It)->LostN+1;
+				if (AltAcc > 1.0*BestAlt->Correct/BestAlt->All) { BestAlt = *It; }
 				else { (*It)->All = (*It)->Correct = 0; } // Reset 
 			}
 			if (BestAlt != Node) {
-				printf("[DEBUG] Swapping node with an alternate tree.\n");
+				HT_TRACE(TTraceEvent::SWAP, Node->Id, BestAlt->Id, 1.0*BestAlt->Correct/BestAlt->All-Acc);
 				// Export("exports/titanic-"+TInt(ExportN++).GetStr()+".gv", TExportType::DOT);
 				if(Node->Type == TNodeType::ROOT) { BestAlt->Type = TNodeType::ROOT; }
+				AltTreesN -= Node->AltTreesV.Len(); // BestAlt keeps its own; nested alternates of the old subtree are recounted at the next drift check 
 				*Node = *BestAlt;
+				StructChangeP = true;
+			} else if (MxAltLostN > 0) { // Prune alternates that keep losing 
+				for (int AltN = Node->AltTreesV.Len()-1; AltN >= 0; --AltN) {
+					if (Node->AltTreesV[AltN]->LostN < MxAltLostN) { continue; }
+					HT_TRACE(TTraceEvent::ALT_DROP, Node->Id, Node->AltTreesV[AltN]->Id, (double) Node->AltTreesV[AltN]->LostN);
+					Node->AltTreesV.Del(AltN);
+					--AltTreesN;
+				}
 			}
 			Node->All = Node->Correct = 0; // Reset 
-			/*
-			if(Node->Type == TNodeType::ROOT) {
-				TStr FNm = ConceptDriftP ? "err-cvfdt.dat" : "err-vfdt.dat";
-				PSOut FOut = TFOut::New(FNm, true);
-				FOut->PutFlt(1.0-Acc); FOut->PutLn();
-			}
-			*/
 			return false;
 		} else if (Node->All == 0 && Node->TestModeN >= 10000) {
 			// printf("Entering test mode...\n");
@@ -861,46 +1795,89 @@ namespace TDatastream {
 		return false;
 	}
 	PExample THoeffdingTree::Preprocess(const TStr& Line, const TCh& Delimiter) const {
-		TStrV LineV; TVec<TAttribute> AttributesV;
-		Line.SplitOnAllCh(Delimiter, LineV);
-		int ValN;
-		EAssertR(AttrsHashV.Len() == LineV.Len(), "Number of attributes in the dataset doesn't match the number of attributes in the configuration file.");
-		const int AttrsN = LineV.Len()-1;
-		for (int CountN = 0; CountN < AttrsN; ++CountN) {
-			// (1) Get appropriate hash table
-			// (2) Get appropriate raw value from input attribute vector 
-			// (3) Map raw attribute value to TInt with hash table 
-			switch (AttrManV.GetVal(CountN).Type) {
-			case TAttrType::DISCRETE:
-				if (LineV.GetVal(CountN)  == "?") {
-					// EFailR("Missing values are not allowed.");
-					// printf("[WARNING] Missing value; assuming default.\n");
-					ValN = 0;
+		HT_PROFILE(Profiler, TPhase::PARSE);
+		return Parse(Line, Delimiter);
+	}
+	// Fields are read straight from the line; discrete values and labels are looked up by their bytes in the schema's value
+	// dictionaries, and unknown values are errors 
+	PExample THoeffdingTree::Parse(const char* LineBf, const int& LineLen, const TCh& Delimiter) const {
+		if (SparseP) {
+			TStrV LineV;
+			TStr(std::string(LineBf, LineLen).c_str()).SplitOnAllCh(Delimiter, LineV);
+			return PreprocessSparse(LineV);
+		}
+		const int AttrsN = Schema->GetAttrsN();
+		TAttributeV AttributesV(AttrsN, 0);
+		const char* LineEnd = LineBf+LineLen;
+		const char* FieldBf = LineBf;
+		for (int AttrN = 0; AttrN <= AttrsN; ++AttrN) {
+			const char* FieldEnd = FieldBf;
+			while (FieldEnd < LineEnd && *FieldEnd != Delimiter.Val) { ++FieldEnd; }
+			EAssertR((AttrN < AttrsN) == (FieldEnd < LineEnd),
+				"Number of attributes in the dataset doesn't match the number of attributes in the configuration file.");
+			const int FieldLen = (int) (FieldEnd-FieldBf);
+			if (Schema->IsNumeric(AttrN)) {
+				char* NumEnd = NULL;
+				const double Num = strtod(FieldBf, &NumEnd);
+				EAssertR(FieldLen > 0 && NumEnd == FieldEnd, "Not a number: `" + TStr(std::string(FieldBf, FieldLen).c_str()) +
+					"' (attribute `" + Schema->GetAttrNm(AttrN) + "').");
+				if (AttrN < AttrsN) {
+					AttributesV.Add(TAttribute(AttrN, Num));
 				} else {
-					ValN = AttrsHashV.GetVal(CountN).GetDat(LineV.GetVal(CountN));
+					return TExample::New(AttributesV, Num);
+				}
+			} else {
+				const int ValN = Schema->GetValN(AttrN, FieldBf, FieldLen);
+				EAssertR(ValN != -1, "Unknown value `" + TStr(std::string(FieldBf, FieldLen).c_str()) +
+					"' of attribute `" + Schema->GetAttrNm(AttrN) + "'.");
+				if (AttrN < AttrsN) {
+					AttributesV.Add(TAttribute(AttrN, ValN));
+				} else {
+					return TExample::New(AttributesV, ValN);
 				}
-				AttributesV.Add(TAttribute(CountN, ValN));
-				break;
-			case TAttrType::CONTINUOUS:
-				AttributesV.Add(TAttribute(CountN, LineV.GetVal(CountN).GetFlt()));
-				break;
-			default:
-				EFailR("Unsupported attribute type.");
+			}
+			FieldBf = FieldEnd+1;
+		}
+		return nullptr; // not reached; the label field returns
+	}
+	// index:value,index:value,...,label; indices count from zero in the order of the configuration file and must increase. 
+	// Attributes that are not listed, and listed ones at their default, are left out of the example 
+	PExample THoeffdingTree::PreprocessSparse(const TStrV& LineV) const {
+		EAssertR(LineV.Len() > 0, "Empty line.");
+		const int AttrsN = Schema->GetAttrsN();
+		TAttributeV AttributesV(LineV.Len()-1, 0);
+		int PrevAttrN = -1;
+		for (int FieldN = 0; FieldN+1 < LineV.Len(); ++FieldN) {
+			TStr IdxStr, ValStr;
+			LineV[FieldN].SplitOnCh(IdxStr, ':', ValStr);
+			int AttrN = -1;
+			EAssertR(IdxStr.IsInt(AttrN) && AttrN > PrevAttrN && AttrN < AttrsN,
+				"Sparse attribute indices must be increasing and within the configuration: " + LineV[FieldN]);
+			PrevAttrN = AttrN;
+			if (Schema->IsNumeric(AttrN)) {
+				const double Num = ValStr.GetFlt();
+				if (Num != 0.0) { AttributesV.Add(TAttribute(AttrN, Num)); }
+			} else {
+				const int ValN = Schema->GetValN(AttrN, ValStr.CStr(), ValStr.Len());
+				EAssertR(ValN != -1, "Unknown value `" + ValStr + "' of attribute `" + Schema->GetAttrNm(AttrN) + "'.");
+				if (ValN != 0) { AttributesV.Add(TAttribute(AttrN, ValN)); }
 			}
 		}
 		if (TaskType == TTaskType::CLASSIFICATION) {
-			return TExample::New(AttributesV, AttrsHashV.GetVal(AttrsN).GetDat(LineV.GetVal(AttrsN)));
+			const int Label = Schema->GetValN(AttrsN, LineV.Last().CStr(), LineV.Last().Len());
+			EAssertR(Label != -1, "Unknown label `" + LineV.Last() + "'.");
+			return TExample::New(AttributesV, Label, true);
 		} else {
-			return TExample::New(AttributesV, LineV.Last().GetFlt());
+			return TExample::New(AttributesV, LineV.Last().GetFlt(), true);
 		}
 	}
 	PNode THoeffdingTree::GetNextNodeCls(PNode Node, PExample Example) const {
 		if (!IsLeaf(Node)) {
-			const TAttrType AttrType = AttrManV.GetVal(Node->CndAttrIdx).Type;
+			const TAttrType AttrType = Schema->GetType(Node->CndAttrIdx);
 			if (AttrType == TAttrType::DISCRETE) {
-				return Node->ChildrenV.GetVal(Example->AttributesV.GetVal(Node->CndAttrIdx).Value);
+				return Node->ChildrenV.GetVal(Example->GetVal(Node->CndAttrIdx));
 			} else { // Numeric attribute 
-				const double Num = Example->AttributesV.GetVal(Node->CndAttrIdx).Num;
+				const double Num = Example->GetNum(Node->CndAttrIdx);
 				const int Idx = Num <= Node->Val ? 0 : 1;
 				return Node->ChildrenV.GetVal(Idx);
 			}
@@ -934,7 +1911,7 @@ namespace TDatastream {
 		switch (ExportType) {
 		case TExportType::XML:
 			FOut.PutStrLn("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>");
-			FOut.PutStrFmtLn("<dt classes=%d>", LabelH.Len());
+			FOut.PutStrFmtLn("<dt classes=%d>", Schema->GetLabelsN());
 			PrintXML(Root, 1, FOut);
 			FOut.PutStrFmtLn("</dt>");
 			break;
@@ -951,29 +1928,51 @@ namespace TDatastream {
 		FOut.Flush();
 	}
 
+	const int THoeffdingTree::FormatVersion = 3;
+	void THoeffdingTree::Save(TSOut& SOut) const {
+		SOut.Save(FormatVersion);
+		SOut.Save(GracePeriod); SOut.Save(SplitConfidence); SOut.Save(TieBreaking); SOut.Save(DriftCheck); SOut.Save(WindowSize);
+		SOut.Save(IsAlt); SOut.Save(FadingFactor);
+		SOut.Save(BinsN); SOut.Save(MxId); SOut.Save(AltTreesN); SOut.Save(DriftExamplesN); SOut.Save((char) DriftMode);
+		SOut.Save(MnRegVal); SOut.Save(MxRegVal); SOut.Save(SubspaceN); Rnd.Save(SOut);
+		SOut.Save((char) AttrHeuristic); SOut.Save(SparseP); SOut.Save(ExportN); SOut.Save(RecheckN);
+		SOut.Save(MxNodeAltsN); SOut.Save(MxAltsN); SOut.Save(MxAltMemB); SOut.Save(MxAltLostN);
+		IdGen->Save(SOut); ExampleQ.Save(SOut); Root.Save(SOut);
+	}
+	PHoeffdingTree THoeffdingTree::Load(TSIn& SIn, const PSchema& Schema, PIdGen IdGen) {
+		int Version; SIn.Load(Version);
+		EAssertR(Version == FormatVersion, "Tree saved in an unsupported format; retrain the model.");
+		int GracePeriod, DriftCheck, WindowSize; double SplitConfidence, TieBreaking, FadingFactor; bool IsAlt;
+		SIn.Load(GracePeriod); SIn.Load(SplitConfidence); SIn.Load(TieBreaking); SIn.Load(DriftCheck); SIn.Load(WindowSize);
+		SIn.Load(IsAlt); SIn.Load(FadingFactor);
+		PHoeffdingTree Tree = new THoeffdingTree(Schema, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, IsAlt, FadingFactor, IdGen, true);
+		char Ch;
+		SIn.Load(Tree->BinsN); SIn.Load(Tree->MxId); SIn.Load(Tree->AltTreesN); SIn.Load(Tree->DriftExamplesN);
+		SIn.Load(Ch); Tree->DriftMode = (TDriftMode) Ch;
+		SIn.Load(Tree->MnRegVal); SIn.Load(Tree->MxRegVal); SIn.Load(Tree->SubspaceN); Tree->Rnd = TRnd(SIn);
+		SIn.Load(Ch); Tree->AttrHeuristic = (TAttrHeuristic) Ch;
+		SIn.Load(Tree->SparseP); SIn.Load(Tree->ExportN); SIn.Load(Tree->RecheckN);
+		SIn.Load(Tree->MxNodeAltsN); SIn.Load(Tree->MxAltsN); SIn.Load(Tree->MxAltMemB); SIn.Load(Tree->MxAltLostN);
+		PIdGen SavedIdGen = TIdGen::Load(SIn);
+		if (Tree->IdGen.Empty()) { Tree->IdGen = SavedIdGen; }
+		Tree->ExampleQ = TQQueue<PExample>(SIn);
+		Tree->Root = PNode(SIn);
+		Tree->InitKernels();
+		Tree->StructChangeP = true;
+		return Tree;
+	}
+	const TPhaseProfiler& THoeffdingTree::GetProfiler() const {
+		static const TPhaseProfiler EmptyProfiler;
+		return Profiler != nullptr ? *Profiler : EmptyProfiler;
+	}
+	void THoeffdingTree::SetProfiling(const bool& ProfileP) {
+		if (ProfileP && Profiler == nullptr) { Profiler = new TPhaseProfiler(); }
+		if (!ProfileP) { delete Profiler; Profiler = nullptr; }
+	}
 	void THoeffdingTree::Init() {
-		AttrsHashV = Params.AttrsHV;
-		InvAttrsHashV = Params.InvAttrsHV;
-		LabelH = Params.DataFormatH;
-		InvLabelH = Params.InvDataFormatH;
-		// Create attribute manager object for each attribute 
-		// NOTE: Label is also ``attribute-managed''
-		const int AttrsN = AttrsHashV.Len();
-		for (int CountN = 0; CountN < AttrsN; ++CountN) {
-			if (AttrsHashV.GetVal(CountN).Len() == 1) { // Continuous attributes have, in a sense, `single' value 
-				AttrManV.Add(TAttrMan(AttrsHashV.GetVal(CountN), InvAttrsHashV.GetVal(CountN), CountN, InvLabelH.GetDat(CountN), TAttrType::CONTINUOUS));
-			} else {
-				AttrManV.Add(TAttrMan(AttrsHashV.GetVal(CountN), InvAttrsHashV.GetVal(CountN), CountN, InvLabelH.GetDat(CountN), TAttrType::DISCRETE));
-			}
-		}
-		const TAttrType PredType = AttrManV.Last().Type;
-		// EAssert(PredType == TAttrType::DISCRETE);
-		if (PredType == TAttrType::DISCRETE) {
-			TaskType = TTaskType::CLASSIFICATION;
-		} else {
-			TaskType = TTaskType::REGRESSION;
-		}
-		Root = TNode::New(LabelH.Len(), TVec<TInt>(), AttrManV, IdGen->GetNextLeafId(), TNodeType::ROOT); // Initialize the root node 
+		TaskType = Schema->GetTaskType();
+		InitKernels();
+		Root = TNode::New(Schema->GetLabelsN(), TVec<TInt>(), *Schema, IdGen->GetNextLeafId(), TNodeType::ROOT, BinsN); // Initialize the root node 
 	}
 
 	// Pre-order depth-first tree traversal 
@@ -989,7 +1988,7 @@ namespace TDatastream {
 		const int ChildrenN = Node->ChildrenV.Len();
 		for (int ChildN = 0; ChildN < ChildrenN; ++ChildN) {
 			FOut.PutStr(Indent);
-			if (AttrManV.GetVal(Node->CndAttrIdx).Type == TAttrType::DISCRETE) {
+			if (Schema->GetType(Node->CndAttrIdx) == TAttrType::DISCRETE) {
 				ValNm = GetNodeValueNm(Node, ChildN);
 			} else {
 				ValNm = (ChildN ? ">" : "<=");
@@ -1027,7 +2026,7 @@ namespace TDatastream {
 			for (int NodeN = 0; NodeN < CrrNode->ChildrenV.Len(); ++NodeN) {
 				++NodeId;
 				PNode TmpNode = CrrNode->ChildrenV[NodeN];
-				if (AttrManV.GetVal(CrrNode->CndAttrIdx).Type == TAttrType::DISCRETE) {
+				if (Schema->GetType(CrrNode->CndAttrIdx) == TAttrType::DISCRETE) {
 					ValueNm = GetNodeValueNm(CrrNode, NodeN);
 				} else {
 					ValueNm = NodeN == 0 ? "<= " : "> ";
@@ -1071,7 +2070,7 @@ namespace TDatastream {
 		double SplitVal;
 		// Find the first numeric attribute if any 
 		// for(TAttrManV::TIter It = AttrManV.BegI(); It != AttrManV.EndI(); ++It) {
-		TAttrManV::TIter It = AttrManV.BegI(); ++It; ++It;
+		TAttrManV::TIter It = Schema->GetAttrManV().BegI(); ++It; ++It;
 			if (It->Type == TAttrType::CONTINUOUS) {
 				const int AttrN = It->Id;
 				printf("Numeric distribution for '%s' attribute.\n", It->Nm.CStr());
@@ -1095,13 +2094,14 @@ namespace TDatastream {
 	}
 	void THoeffdingTree::Print(PExample Example) const {
 		for (auto It = Example->AttributesV.BegI(); It != Example->AttributesV.EndI(); ++It) {
-			switch (AttrManV.GetVal(It->Id).Type) {
+			if (Example->IsSparse()) { printf("%d:", It->Id.Val); }
+			switch (Schema->GetType(It->Id)) {
 				case TAttrType::CONTINUOUS: {
 					printf("%f\t", It->Num);
 					break;
 				}
 				case TAttrType::DISCRETE: {
-					printf("%s\t", AttrManV.GetVal(It->Id).InvAttrH.GetDat(It->Value).CStr());
+					printf("%s\t", Schema->GetValNm(It->Id, It->Value).CStr());
 					break;
 				}
 			}
@@ -1115,60 +2115,62 @@ namespace TDatastream {
 		printf("\n");
 	}
 
-	// Naive bayes classifier 
-	TLabel THoeffdingTree::NaiveBayes(PNode Node, PExample Example) const {
-		const THash<TTriple<TInt, TInt, TInt>, TInt> Counts = Node->Counts;
-		const TIntV PartitionV = Node->PartitionV;
-		const int ExamplesN = Node->ExamplesN;
-		const int AttrsN = Example->AttributesV.Len();
-		const int LabelsN = AttrManV.Last().ValueV.Len();
-		double pk = 0.0, pc = 0.0;
-		int nk = 0, Maj = 0;
-		int MxLabel = 0;
-		double MxProb = 0;
-		TVec<TInt> SubExamplesN;
-		SubExamplesN.Reserve(AttrsN, AttrsN);
-		// Precompute n(x_k) for k=0,1,...,AttrsN-1
-		for (int AttrN = 0; AttrN < AttrsN; ++AttrN) {
-			SubExamplesN.GetVal(AttrN) = 0;
-			for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
-				TTriple<TInt, TInt, TInt> TmpTriple(AttrN, Example->AttributesV.GetVal(AttrN).Value, LabelN);
-				if (Counts.IsKey(TmpTriple) && Counts.GetDat(TmpTriple) > 0) {
-					SubExamplesN.GetVal(AttrN) += Counts.GetDat(TmpTriple);
-				}
+	// Naive bayes classifier; every discrete attribute x_k with n(x_k,c_i) > 0 multiplies P(c_i) by the m-estimate 
+	// (m*P(c_i)+n(x_k,c_i))/(P(c_i)*(m+n(x_k))) with m=2. The discrete attributes that a sparse example leaves at their 
+	// default and that the leaf has only seen at their default all count every example of the leaf, so they share one 
+	// factor, applied once as a power; only the attributes the leaf counted and those the example lists are visited 
+	TLabel THoeffdingTree::NaiveBayes(const TNode* Node, PExample Example) const {
+		const TCountV& PartitionV = Node->PartitionV;
+		const int64 ExamplesN = Node->ExamplesN;
+		const int LabelsN = Schema->GetLabelsN();
+		TVec<int64> CountV(LabelsN); // n(x_k, c_i) 
+		TFltV PriorV(LabelsN), ProbV(LabelsN);
+		for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
+			CountV[LabelN] = LabelN < PartitionV.Len() ? PartitionV[LabelN] : 0; // number of positive examples 
+			PriorV[LabelN] = (CountV[LabelN]+1.0)/(ExamplesN+LabelsN); // laplace estimate for P(c_i) 
+			ProbV[LabelN] = PriorV[LabelN];
+		}
+		if (Example->IsSparse()) {
+			int DefAttrsN = Schema->GetDiscAttrsN();
+			for (int KeyId = Node->CountH.FFirstKeyId(); Node->CountH.FNextKeyId(KeyId); ) {
+				const int AttrN = Node->CountH.GetKey(KeyId);
+				Node->GetValCountV(AttrN, Example->GetVal(AttrN), Schema->GetValsN(AttrN), LabelsN, CountV);
+				MulNaiveBayes(CountV, PriorV, 1, ProbV);
+				--DefAttrsN;
+			}
+			for (int AttrN = 0; AttrN < Example->AttributesV.Len(); ++AttrN) {
+				const TAttribute& Attr = Example->AttributesV[AttrN];
+				if (Schema->IsNumeric(Attr.Id) || Attr.Value == 0 || Node->CountH.IsKey(Attr.Id)) { continue; }
+				--DefAttrsN; // a value the leaf never saw; n(x_k, c_i) = 0 for every label 
+			}
+			for (int LabelN = 0; LabelN < LabelsN; ++LabelN) { CountV[LabelN] = LabelN < PartitionV.Len() ? PartitionV[LabelN] : 0; }
+			MulNaiveBayes(CountV, PriorV, DefAttrsN, ProbV);
+		} else {
+			for (int AttrN = 0; AttrN < Schema->GetAttrsN(); ++AttrN) {
+				if (Schema->IsNumeric(AttrN)) { continue; } // numeric attributes do not take part 
+				Node->GetValCountV(AttrN, Example->GetVal(AttrN), Schema->GetValsN(AttrN), LabelsN, CountV);
+				MulNaiveBayes(CountV, PriorV, 1, ProbV);
 			}
 		}
+		int MxLabel = 0;
+		double MxProb = 0;
 		for (int LabelN = 0; LabelN < LabelsN; ++LabelN) {
-			nk = PartitionV.GetVal(LabelN); // number of positive examples 
-			//printf("[DEBUG] #Examples = %d\n", nk);
-			pk = (nk+1.0)/(ExamplesN+LabelsN); // TProbEstimates::LaplaceEstiamte(nk, CurrNode->ExamplesN-nk, 2); 
-			//printf("[DEBUG] Current: %f\n", pk);
-			for (int i = 0; i < AttrsN; ++i) {
-				TTriple<TInt, TInt, TInt> TmpTriple(i, Example->AttributesV.GetVal(i).Value, LabelN);
-				if (Counts.IsKey(TmpTriple) && Counts.GetDat(TmpTriple) > 0) {
-					// p0 = 1.0*CurrNode->Counts(TmpTriple)/nk; // apriori probability 
-					// pk *= TProbEstimates::MEstimate(CurrNode->Counts(TmpTriple), nk, p0, 2); // compute conditional probability using m-estimate 
-					// pk *= 1.0*CurrNode->Counts(TmpTriple)/nk; 
-					// (m * P(c_i) + n(x_k,c_i))/(P(c_i) * (m + n(x_k)))
-					pc = (nk+1.0)/(ExamplesN+LabelsN); // laplace estimate for P(c_i) 
-					pk *= (2.0*pc+Counts.GetDat(TmpTriple))/(pc*(2+SubExamplesN.GetVal(i)));
-				}/* else {
-					printf("[DEBUG] Zero probability!\n");
-				}*/
-			}
-			if (MxProb < pk) {
-				MxProb = pk; MxLabel = LabelN;
-			}
-			//printf("[DEBUG] Class `%s' with `probability' %f\n", InvAttrsHashV.GetVal(AttrsN).GetDat(AttrManV.Last().ValueV.GetVal(LabelN)).CStr(), pk);
-		}
-		// Print('-', 120);
-		// printf("-----------------------\n");
-		// printf("[DEBUG] Bayes classified it as %s\n", InvAttrsHashV.GetVal(AttrsN).GetDat(AttrManV.Last().ValueV.GetVal(MxLabel)).CStr());
-		/* ----------- */
-		// printf("[DEBUG] CLASSIFYING:\n");
-		// for(int i = 0; i < PartitionV.Len(); ++i) {
-		//	printf("\t[DEBUG] #%s = %d\n", InvAttrsHashV.GetVal(AttrsN).GetDat(AttrManV.Last().ValueV.GetVal(i)).CStr(), PartitionV.GetVal(i));
-		// }
+			if (MxProb < ProbV[LabelN]) { MxProb = ProbV[LabelN]; MxLabel = LabelN; }
+		}
 		return MxLabel;
 	}
+	// Multiply by the factors of AttrsN attributes that all have the counts CountV 
+	void THoeffdingTree::MulNaiveBayes(const TVec<int64>& CountV, const TFltV& PriorV, const int& AttrsN, TFltV& ProbV) {
+		if (AttrsN <= 0) { return; }
+		int64 SubExamplesN = 0; // n(x_k) 
+		for (int LabelN = 0; LabelN < CountV.Len(); ++LabelN) {
+			if (CountV[LabelN] > 0) { SubExamplesN += CountV[LabelN]; }
+		}
+		for (int LabelN = 0; LabelN < CountV.Len(); ++LabelN) {
+			if (CountV[LabelN] <= 0) { continue; }
+			const double pc = PriorV[LabelN];
+			const double Factor = (2.0*pc+CountV[LabelN])/(pc*(2+SubExamplesN));
+			ProbV[LabelN] *= AttrsN == 1 ? Factor : TMath::Power(Factor, AttrsN);
+		}
+	}
 } // namespace TDatastream
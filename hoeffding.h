@@ -3,8 +3,20 @@
 
 #include <base.h>
 #include <mine.h>
-#include "parser.h"
+#include "schema.h"
+#include "profile.h"
+#include "trace.h"
+#include "eval.h"
+#include <algorithm>
+#include <cstdint>
 #include <map>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 
 #define ISINF(x) _finite(x)
 #define ISNAN(x) _isnan(x)
@@ -16,7 +28,6 @@ namespace TDatastream {
 	class TBin;
 	class TAttribute;
 	class TNode;
-	class TAttrMan;
 	ClassHdTP(TExample, PExample);
 	ClassHdTP(THoeffdingTree, PHoeffdingTree)
 	
@@ -26,23 +37,24 @@ namespace TDatastream {
 	typedef TVec<TBin> TBinV;
 	typedef TVec<TNode> TNodeV;
 	// typedef TVec<PExample> PExampleV;
-	typedef TVec<TAttrMan> TAttrManV;
 	// another option is struct { int Idx1, Idx2; double Mx1, Mx2, Diff; };
 	typedef TTriple<TPair<TInt, TFlt>, TPair<TInt, TFlt>, TFlt> TBstAttr;
 	
 	// numeric-attribute-discretization
 	const int BinsN = 100;
 
-	// learning task type
-	enum class TTaskType : char { CLASSIFICATION, REGRESSION };
-	// attribute value type 
-	enum class TAttrType : char { DISCRETE, CONTINUOUS };
 	// node type 
 	enum class TNodeType : char { ROOT, INTERNAL, LEAF };
 	// export type 
 	enum class TExportType : char { XML, JSON, DOT };
 	// attribute heuristic measures 
 	enum class TAttrHeuristic : char { INFO_GAIN, GINI_GAIN };
+	// concept-drift handling; CVFDT keeps a window of examples, HAT monitors error with ADWIN 
+	enum class TDriftMode : char { NONE, CVFDT, HAT };
+
+	// hoeffding-adaptive-tree; alternate tree competes with the original only after both estimators saw this many examples 
+	const int HatMnWinLen = 300;
+	const double HatConfidence = 0.05;
 
 	// Decision-Tree-Exception
 	class TDtExcept : public TExcept {
@@ -71,10 +83,13 @@ namespace TDatastream {
 	ClassTP(TIdGen, PIdGen) //{
 	public:
 		static PIdGen New() { return new TIdGen(); }
+		static PIdGen Load(TSIn& SIn) { return new TIdGen(SIn); }
+		void Save(TSOut& SOut) const { SOut.Save(CrrLeafId); SOut.Save(CrrBinId); }
 		inline int GetNextLeafId() { return CrrLeafId++; }
 		inline int GetNextBinId() { return CrrBinId++; }
 	private:
 		TIdGen() : CrrLeafId(1), CrrBinId(1) { };
+		explicit TIdGen(TSIn& SIn) { SIn.Load(CrrLeafId); SIn.Load(CrrBinId); }
 		int CrrLeafId;
 		int CrrBinId;
 	};
@@ -107,25 +122,151 @@ namespace TDatastream {
 
 	///////////////////////////////
 	// Helper-functions
+	class TCountV;
 	class TMisc {
 	public:
 		static void AddVec(const int& Scalar, TIntV& FstV, TIntV& SndV); // SndV = Scalar*FstV + SndV
+		static void AddVec(const int& Scalar, const TCountV& FstV, TVec<int64>& SndV);
 		static double Entropy(const TIntV& FreqV, const int& N); // N = sum(FreqV)
+		static double Entropy(const TVec<int64>& FreqV, const int64& N);
+		static double Entropy(const TCountV& FreqV, const int64& N);
+		static double Gini(const TVec<int64>& FreqV, const int64& N); // N = sum(FreqV)
 		// Compute variance from sufficient statistic: Sum of squared values, sum of values, and number of values
-		inline static double Variance(const double& SqSum, const double& Sum, const int& N) {
+		inline static double Variance(const double& SqSum, const double& Sum, const int64& N) {
 			return SqSum/N-TMath::Sqr(Sum/N);
 		}
-		inline static double StdDev(const double& SqSum, const double& Sum, const int& N) {
+		inline static double StdDev(const double& SqSum, const double& Sum, const int64& N) {
 			return TMath::Sqrt(Variance(SqSum, Sum, N));
 		}
 	};
 	
+	///////////////////////////////
+	// Adaptive-Windowing-Change-Detector
+	// ADWIN2 [Bifet and Gavalda, 2007]; keeps an exponential histogram of the window instead of the window itself, 
+	// so it needs O(MxBucketsN*log(W/MxBucketsN)) memory for a window of length W 
+	class TAdwin {
+	public:
+		TAdwin(const double& Delta_ = 0.002, const int& MxBucketsN_ = 5, const int& ClockN_ = 32, const int& MnWinLen_ = 10)
+			: Delta(Delta_), MxBucketsN(MxBucketsN_), ClockN(ClockN_), MnWinLen(MnWinLen_), Width(0), Total(0.0), Variance(0.0), TickN(0) { }
+		explicit TAdwin(TSIn& SIn);
+		void Save(TSOut& SOut) const;
+		bool Add(const double& Val); // returns true if the window shrank, i.e., change was detected 
+		inline double GetEst() const { return Width > 0 ? Total/Width : 0.0; }
+		inline int GetWidth() const { return Width; }
+		inline double GetVariance() const { return Width > 0 ? Variance/Width : 0.0; }
+		void Clr();
+	private:
+		void Compress(); // merge buckets so that each row holds at most MxBucketsN buckets 
+		void DelLast(); // drop the oldest bucket 
+		bool DetectChange();
+	private:
+		TVec<TVec<TFltPr> > RowV; // RowV[i] holds (sum, variance) of buckets of size 2^i; the oldest bucket comes first 
+		double Delta; // confidence parameter 
+		int MxBucketsN;
+		int ClockN; // check for change every ClockN insertions 
+		int MnWinLen; // minimal length of both subwindows 
+		int Width; // current window length 
+		double Total; // sum of the elements in the window 
+		double Variance; // sum of squared differences from the window mean 
+		int TickN;
+	};
+
+	///////////////////////////////
+	// Adaptive-Width-Counters
+	// Non-negative counts packed 1, 2, 4, or 8 bytes wide. A vector starts with one-byte counts; an increment that would 
+	// overflow widens the whole vector in place to the narrowest width that fits, so the many small counts of a tree 
+	// take a byte each and counts of very long streams never wrap around 
+	class TCountV {
+	public:
+		TCountV() : CountsN(0), WidthB(1) { }
+		explicit TCountV(const int& CountsN_) : CountsN(0), WidthB(1) { Gen(CountsN_); }
+		explicit TCountV(TSIn& SIn);
+		void Save(TSOut& SOut) const;
+		bool operator==(const TCountV& CountV) const;
+		void Gen(const int& CountsN_); // all zero, one byte wide 
+		void Clr() { BfV.Clr(); CountsN = 0; WidthB = 1; }
+		inline int Len() const { return CountsN; }
+		inline bool Empty() const { return CountsN == 0; }
+		inline int GetWidth() const { return WidthB; } // bytes per count 
+		inline int64 GetVal(const int& CountN) const {
+			AssertR(0 <= CountN && CountN < CountsN, "Count index out of range.");
+			return Get(BfV.BegI(), WidthB, CountN);
+		}
+		inline int64 operator[](const int& CountN) const { return GetVal(CountN); }
+		inline void Inc(const int& CountN, const int64& Delta = 1) {
+			const uint64 Count = (uint64) (GetVal(CountN)+Delta);
+			if (Count > GetMx(WidthB)) { Widen(Count); }
+			PutVal(CountN, Count);
+		}
+		inline void Dec(const int& CountN) {
+			const int64 Count = GetVal(CountN);
+			AssertR(Count > 0, "Negative count.");
+			if (Count > 0) { PutVal(CountN, Count-1); }
+		}
+		void Add(const int64& Count = 0); // append a count 
+		int GetMxValN() const; // index of the largest count 
+		uint64 GetMemUsed() const { return sizeof(TCountV)-sizeof(BfV)+BfV.GetMemUsed(); }
+	private:
+		static inline uint64 GetMx(const int& WidthB) { return WidthB == 8 ? ~0ULL : (1ULL << (8*WidthB))-1; }
+		inline void PutVal(const int& CountN, const uint64& Count) { Put(BfV.BegI(), WidthB, CountN, Count); }
+		static inline int64 Get(const uchar* Bf, const int& WidthB, const int& CountN) {
+			switch (WidthB) {
+			case 1: return Bf[CountN];
+			case 2: return ((const uint16_t*) Bf)[CountN];
+			case 4: return ((const uint32_t*) Bf)[CountN];
+			default: return (int64) ((const uint64*) Bf)[CountN];
+			}
+		}
+		static inline void Put(uchar* Bf, const int& WidthB, const int& CountN, const uint64& Count) {
+			switch (WidthB) {
+			case 1: Bf[CountN] = (uchar) Count; break;
+			case 2: ((uint16_t*) Bf)[CountN] = (uint16_t) Count; break;
+			case 4: ((uint32_t*) Bf)[CountN] = (uint32_t) Count; break;
+			default: ((uint64*) Bf)[CountN] = Count;
+			}
+		}
+		void Widen(const uint64& Count); // to the narrowest width that holds Count 
+	private:
+		TVec<uchar> BfV; // CountsN counts of WidthB bytes 
+		int CountsN;
+		char WidthB;
+	};
+
+	///////////////////////////////
+	// Regression-Moments
+	// With HT_FLOAT_STATS, the means and sums of squared deviations of bins and nodes are float32. Updates are still 
+	// computed in double. A sum of squared deviations only grows, so it carries the rounding error of every addition 
+	// into the next one [Kahan, 1965]; a mean moves by ever smaller steps and needs no compensation 
+#ifdef HT_FLOAT_STATS
+	typedef float TMomentFlt;
+	class TMomentSum {
+	public:
+		TMomentSum(const double& Val = 0.0) : Sum((float) Val), Comp(0.0f) { }
+		inline operator double() const { return (double) Sum-Comp; }
+		inline TMomentSum& operator+=(const double& Delta) {
+			const double Y = Delta-Comp;
+			const float NewSum = (float) (Sum+Y);
+			Comp = (float) (((double) NewSum-Sum)-Y);
+			Sum = NewSum;
+			return *this;
+		}
+	private:
+		float Sum;
+		float Comp; // rounding error of the last addition 
+	};
+#else
+	typedef double TMomentFlt;
+	typedef double TMomentSum;
+#endif
+
 	///////////////////////////////
 	// Bin (for handling numeric attributes) 
 	class TBin {
 	public:
 		TBin(const double& _Value = 0.0, const int& _Id = 0, const int& _Count = 0)
-			: Value(_Value), Id(_Id), Count(_Count), S(0.0), Mean(0.0), T(0.0) { }
+			: Value(_Value), Id(_Id), Count(_Count), S(0.0), Mean(0.0) { }
+		explicit TBin(TSIn& SIn);
+		void Save(TSOut& SOut) const;
 		// { printf("INIT = %f\n", Value); getchar(); }
 		
 		friend bool operator<=(const TBin& Bin1, const TBin& Bin2);
@@ -140,44 +281,48 @@ namespace TDatastream {
 		}
 		void Inc(const int& Label) {
 			while (Label >= PartitionV.Len()) { PartitionV.Add(0); }
-			PartitionV.GetVal(Label)++;
+			PartitionV.Inc(Label);
 			++Count;
 		}
 		void Dec(const int& Label) { // NOTE: Asserts serve debugging purposes 
 			AssertR(Label < PartitionV.Len(), "Should not happen, by construction.");
-			AssertR(PartitionV.GetVal(Label)-- >= 0, "Negative partition count in bin.");
-			AssertR(--Count >= 0, "Negative count.");
+			PartitionV.Dec(Label);
+			--Count; AssertR(Count >= 0, "Negative count.");
 		}
 		// NOTE: Here, ValueV.Len() is the number of examples in the leaf 
 		void Inc(const double& RegValue) { // Regression 
 			// ValueV.Add(RegValue);
 			++Count;
 			const double Delta = RegValue - Mean;
-			T += RegValue;
 			Mean += Delta/Count;
 			S += Delta*(RegValue - Mean);
 		}
+		inline double GetSum() const { return 1.0*Count*Mean; } // sum of the sample elements x1+x2+...+xn 
 		TBin& operator++() { ++Count; return *this; }
 		TBin& operator++(int) { Count++; return *this; }
 		double Entropy() const;
+		inline bool Has(const int& Label) const { return Label < PartitionV.Len() && PartitionV[Label] > 0; }
+		void Merge(const TBin& Bin); // absorb Bin; the value becomes the count-weighted mean of both values 
 		// int operator--() { Assert(Count); return --Count; }
 		// int operator--(int) { Assert(Count); return Count--; }
 	public:
-		TFltV ValueV; // for regression
-		double S; // sum of the squares of element and mean differences (x1-mean)^2+(x2-mean)^2+...+(xn-mean)^2
-		double Mean; // sample mean 
-		double T; // sum of the sample elements x1+x2+...+xn
+		TMomentSum S; // sum of the squares of element and mean differences (x1-mean)^2+(x2-mean)^2+...+(xn-mean)^2
+		TMomentFlt Mean; // sample mean 
 		double Value; // initialize bin with this value 
-		int	Count;
+		int64 Count;
 		int Id; // ID needed for forgetting 
-		TIntV PartitionV; // for classification 
+		TCountV PartitionV; // for classification 
 	};
 	
 	///////////////////////////////
 	// Histogram
+	// Streaming histogram of [Ben-Haim and Tom-Tov, 2010]: every unseen value gets its own bin and, once there are more 
+	// than MxBinsN bins, the two bins with the closest values merge; two histograms merge the same way 
 	class THist {
 	public:
-		THist(const int& BinsN_ = BinsN) { } // BinsV.Reserve(BinsN_, BinsN_); } 
+		THist(const int& BinsN_ = BinsN) : MxBinsN(BinsN_), AllN(0) { } // BinsV.Reserve(BinsN_, BinsN_); } 
+		explicit THist(TSIn& SIn) : BinsV(SIn) { SIn.Load(MxBinsN); SIn.Load(AllN); }
+		void Save(TSOut& SOut) const { BinsV.Save(SOut); SOut.Save(MxBinsN); SOut.Save(AllN); }
 		void IncCls(PExample Example, const int& AttrIdx, PIdGen IdGen); // classification
 		void DecCls(PExample Example, const int& AttrIdx); // classification 
 		void IncReg(PExample Example, const int& AttrIdx); // regression
@@ -185,25 +330,15 @@ namespace TDatastream {
 		double InfoGain(double& SpltVal) const; // classification 
 		double GiniGain(double& SpltVal) const; // classification 
 		double StdGain(double& SpltVal) const; // regression 
+		void Merge(const THist& Hist); // e.g., statistics of the same attribute gathered on different threads 
 		TBinV BinsV;
+		int MxBinsN; // maximal number of bins 
+		int64 AllN; // examples in the bins 
 		void Print() const;
+	private:
+		int MergeClosest(const int& BinN = -1); // returns the new index of bin BinN 
 	};
 
-	///////////////////////////////
-	// Attribute-Managment
-	class TAttrMan {
-	public:
-		TAttrMan(const THash<TStr, TInt>& AttrH_ = THash<TStr, TInt>(), const THash<TInt, TStr>& InvAttrH_ = THash<TInt, TStr>(),
-			const int& Id_ = -1, const TStr& Nm_ = "Anon", const TAttrType& Type_ = TAttrType::DISCRETE);
-		public:
-		THash<TStr, TInt> AttrH; // maps attribute value to id 
-		THash<TInt, TStr> InvAttrH; // maps id to attribute value, inverting AttrH
-		TIntV ValueV; // possible values 
-		TAttrType Type; // attribute type 
-		TStr Nm; // attribute name 
-		TInt Id; // attribute ID used internally 
-	};
-	
 	///////////////////////////////
 	// Attribute
 	class TAttribute {
@@ -214,6 +349,8 @@ namespace TDatastream {
 			: Id(Id_), Num(Num_), Value(-1) { }
 		TAttribute(const TAttribute& Attribute)
 			: Id(Attribute.Id), Value(Attribute.Value), Num(Attribute.Num) { }
+		explicit TAttribute(TSIn& SIn) : Id(SIn), Value(SIn), Num(SIn) { }
+		void Save(TSOut& SOut) const { Id.Save(SOut); Value.Save(SOut); Num.Save(SOut); }
 		// TAttribute& operator=(const TAttribute& Attribute);
 		inline bool operator==(const TAttribute& Attr) const {
 			return (Value != -1 && Value == Attr.Value) || Num == Attr.Num;
@@ -238,19 +375,26 @@ namespace TDatastream {
 	ClassTP(TExample, PExample) // {
 	public:
 		static PExample New() { return new TExample(); }
-		static PExample New(const TAttributeV& AttributesV, const int& Label) {
-			return new TExample(AttributesV, Label);
-		}
-		static PExample New(const TAttributeV& AttributesV, const double& Value) {
-			return new TExample(AttributesV, Value);
-		}
-		TExample() : LeafId(0), BinId(0), Label(-1), Value(0) { }
-		TExample(const TAttributeV& AttributesV_, const int& Label_)
-			: LeafId(0), BinId(0), AttributesV(AttributesV_), Label(Label_), Value(0) { }
-		TExample(const TAttributeV& AttributesV_, const double& Value_)
-			: LeafId(0), BinId(0), AttributesV(AttributesV_), Value(Value_), Label(-1) { }
+		static PExample New(const TAttributeV& AttributesV, const int& Label, const bool& SparseP = false) {
+			return new TExample(AttributesV, Label, SparseP);
+		}
+		static PExample New(const TAttributeV& AttributesV, const double& Value, const bool& SparseP = false) {
+			return new TExample(AttributesV, Value, SparseP);
+		}
+		static PExample New(const TExample& Example) { return new TExample(Example); }
+		static PExample Load(TSIn& SIn) { return new TExample(SIn); }
+		TExample() : LeafId(0), BinId(0), Label(-1), Value(0), SparseP(false) { }
+		TExample(const TAttributeV& AttributesV_, const int& Label_, const bool& SparseP_ = false)
+			: LeafId(0), BinId(0), AttributesV(AttributesV_), Label(Label_), Value(0), SparseP(SparseP_) { }
+		TExample(const TAttributeV& AttributesV_, const double& Value_, const bool& SparseP_ = false)
+			: LeafId(0), BinId(0), AttributesV(AttributesV_), Value(Value_), Label(-1), SparseP(SparseP_) { }
 		TExample(const TExample& Example_)
-			: LeafId(Example_.LeafId), BinId(Example_.BinId), AttributesV(Example_.AttributesV), Label(Example_.Label), Value(Example_.Value) { }
+			: LeafId(Example_.LeafId), BinId(Example_.BinId), AttributesV(Example_.AttributesV), Label(Example_.Label), Value(Example_.Value),
+			SparseP(Example_.SparseP) { }
+		explicit TExample(TSIn& SIn) : LeafId(SIn), BinId(SIn), AttributesV(SIn), Label(SIn), Value(SIn) { SIn.Load(SparseP); }
+		void Save(TSOut& SOut) const {
+			LeafId.Save(SOut); BinId.Save(SOut); AttributesV.Save(SOut); Label.Save(SOut); Value.Save(SOut); SOut.Save(SparseP);
+		}
 		TExample& operator=(const TExample& Example);
 		inline bool operator<(const TExample& Example) const { return Label < Example.Label; } /* *** */
 		inline bool operator==(const TExample& Example) const {
@@ -262,6 +406,31 @@ namespace TDatastream {
 		}
 		inline void SetLeafId(const int& LeafId_) { LeafId = LeafId_; }
 		inline void SetBinId(const int& BinId_) { BinId = BinId_; }
+		// A sparse example lists only the attributes that differ from their default, in increasing order of Id; 
+		// the default is the first value of a discrete attribute and 0.0 for a numeric one 
+		inline bool IsSparse() const { return SparseP; }
+		inline int GetVal(const int& AttrN) const { // discrete 
+			if (!SparseP) { return AttributesV[AttrN].Value; }
+			const int AttrIdx = GetAttrIdx(AttrN);
+			return AttrIdx != -1 ? (int) AttributesV[AttrIdx].Value : 0;
+		}
+		inline double GetNum(const int& AttrN) const { // numeric 
+			if (!SparseP) { return AttributesV[AttrN].Num; }
+			const int AttrIdx = GetAttrIdx(AttrN);
+			return AttrIdx != -1 ? (double) AttributesV[AttrIdx].Num : 0.0;
+		}
+		// position of attribute AttrN in AttributesV, -1 if a sparse example leaves it at the default 
+		inline int GetAttrIdx(const int& AttrN) const {
+			if (!SparseP) { return AttrN; }
+			int LoN = 0, HiN = AttributesV.Len()-1;
+			while (LoN <= HiN) {
+				const int MidN = (LoN+HiN)/2;
+				const int MidId = AttributesV[MidN].Id;
+				if (MidId == AttrN) { return MidN; }
+				if (MidId < AttrN) { LoN = MidN+1; } else { HiN = MidN-1; }
+			}
+			return -1;
+		}
 		inline int GetPrimHashCd() const { // NOTE: BAD way of combining HASH CODES!!!
 			return AttributesV.GetPrimHashCd()+Label.GetPrimHashCd()+Value.GetPrimHashCd()+LeafId.GetPrimHashCd()+BinId.GetPrimHashCd();
 		}
@@ -275,6 +444,46 @@ namespace TDatastream {
 		TAttributeV AttributesV;
 		TLabel Label; // Classification 
 		TFlt Value; // Regression only 
+		bool SparseP;
+	};
+
+	///////////////////////////////
+	// Node-Pool
+	// Slab allocator for tree nodes. Nodes are carved from chunks of ChunkSlotsN slots, so the children created by one
+	// split sit next to each other instead of being scattered over the heap. Slots of deleted nodes (subtrees dropped by
+	// TestMode swaps, Clr and HAT prunes) go to a free list and are reused before the pool grows; chunks are kept for the
+	// lifetime of the process. Every thread carves its own chunks and keeps its own free list, so ensemble workers and
+	// drift-check sweeps never wait on each other; a slot freed on another thread simply joins that thread's list. Slots
+	// of exited threads go to a spare list, the only part behind a mutex 
+	class TNodePool {
+	public:
+		static void* Alloc();
+		static void Free(void* Slot);
+		static uint64 GetSlotsN() { return SlotsN; } // slots handed out so far, including free ones 
+		static uint64 GetFreeN() { return FreeN; }
+		static uint64 GetMemUsed(); // bytes reserved by the chunks 
+	private:
+		class TLocal {
+		public:
+			TLocal() : Chunk(nullptr), ChunkPos(ChunkSlotsN), FreeSlot(nullptr) { }
+			~TLocal(); // hand the free and unused slots to the spare list 
+		public:
+			char* Chunk; // last chunk carved by the thread 
+			int ChunkPos; // next unused slot in Chunk 
+			void* FreeSlot; // head of the free list; a free slot holds the address of the next one 
+			static thread_local bool GoneP; // set once the thread's pool is destroyed; later calls use the spare list 
+		};
+		static TLocal& GetLocal() { static thread_local TLocal Local; return Local; }
+		static void* AllocSpare(); // null if there are no spare slots 
+		static void FreeSpare(void* Slot);
+	private:
+		static const int ChunkSlotsN = 1024;
+		static std::mutex SpareLock;
+		static void* SpareSlot; // head of the spare list 
+		static std::atomic<uint64> SpareN;
+		static std::atomic<uint64> ChunksN;
+		static std::atomic<uint64> SlotsN;
+		static std::atomic<uint64> FreeN;
 	};
 
 	///////////////////////////////
@@ -282,24 +491,33 @@ namespace TDatastream {
 	ClassTP(TNode, PNode) // { 
 		friend class THoeffdingTree;
 	public:
+		// nodes live in TNodePool; the size check keeps a derived class, should there ever be one, on the heap 
+		static void* operator new(size_t Size) { return Size == sizeof(TNode) ? TNodePool::Alloc() : ::operator new(Size); }
+		static void operator delete(void* Ptr, size_t Size) {
+			if (Size == sizeof(TNode)) { TNodePool::Free(Ptr); } else { ::operator delete(Ptr); }
+		}
 		static PNode New(const int& LabelsN = 2, const TIntV& UsedAttrs = TVec<TInt>(), const int& Id = 0, const TNodeType& Type = TNodeType::LEAF) {
 			return new TNode(LabelsN, UsedAttrs, Id, Type);
 		}
-		static PNode New(const int& LabelsN, const TIntV& UsedAttrV, const TAttrManV& AttrManV, const int& Id, const TNodeType& Type = TNodeType::LEAF) {
-			return new TNode(LabelsN, UsedAttrV, AttrManV, Id, Type);
+		static PNode New(const int& LabelsN, const TIntV& UsedAttrV, const TSchema& Schema, const int& Id, const TNodeType& Type = TNodeType::LEAF,
+			const int& HistBinsN = BinsN) {
+			return new TNode(LabelsN, UsedAttrV, Schema, Id, Type, HistBinsN);
 		}
 		// TODO: Initialize PartitionV class label distribution counts 
 		TNode(const int& LabelsN = 2, const TIntV& UsedAttrs_ = TIntV(), const int& Id_ = 0, const TNodeType& Type_ = TNodeType::LEAF)
-			: CndAttrIdx(-1), ExamplesN(0), UsedAttrs(UsedAttrs_), Avg(0), VarSum(0),
-			Err(0), TestModeN(0), Id(Id_), Correct(0), All(0), Type(Type_) {
-			PartitionV.Reserve(LabelsN, LabelsN);
+			: CndAttrIdx(-1), ExamplesN(0), DirtyN(0), UsedAttrs(UsedAttrs_), Avg(0), VarSum(0),
+			Err(0), TestModeN(0), Id(Id_), Correct(0), All(0), LostN(0), Type(Type_) {
+			PartitionV.Gen(LabelsN);
 		}
-		TNode(const int& LabelsN, const TIntV& UsedAttrs_, const TAttrManV& AttrManV, const int& Id_, const TNodeType& Type_)
-			: CndAttrIdx(-1), ExamplesN(0), UsedAttrs(UsedAttrs_), Avg(0), VarSum(0),
-				Err(0), TestModeN(0), Id(Id_), Correct(0), All(0), Type(Type_) {
-			PartitionV.Reserve(LabelsN, LabelsN); Init(AttrManV);
+		TNode(const int& LabelsN, const TIntV& UsedAttrs_, const TSchema& Schema, const int& Id_, const TNodeType& Type_, const int& HistBinsN = BinsN)
+			: CndAttrIdx(-1), ExamplesN(0), DirtyN(0), UsedAttrs(UsedAttrs_), Avg(0), VarSum(0),
+				Err(0), TestModeN(0), Id(Id_), Correct(0), All(0), LostN(0), Type(Type_) {
+			PartitionV.Gen(LabelsN); Init(Schema, HistBinsN);
 		}
 		TNode(const TNode& Node);
+		explicit TNode(TSIn& SIn); // the whole subtree, with alternate trees 
+		static PNode Load(TSIn& SIn) { return new TNode(SIn); }
+		void Save(TSOut& SOut) const;
 		~TNode() { Clr(); }
 		TNode& operator=(const TNode& Node);
 		inline bool operator==(const TNode& Node) const;
@@ -308,15 +526,23 @@ namespace TDatastream {
 		}
 		double ComputeEntropy() const;
 		double ComputeGini() const;
-		double InfoGain(const int& AttrIndex, const TVec<TAttrMan>& AttrManV) const; // classification 
-		double GiniGain(const int& AttrIndex, const TVec<TAttrMan>& AttrManV) const; // classification 
-		double StdGain(const int& AttrIndex, const TVec<TAttrMan>& AttrManV) const; // regression 
-		double ComputeTreshold(const double& Delta, const int& LabelsN) const;
-		void Split(const int& AttrIndex, const TAttrManV& AttrManV, PIdGen IdGen); // split the leaf on the AttrIndex attribute 
+		double InfoGain(const int& AttrIndex, const TSchema& Schema) const; // classification 
+		double GiniGain(const int& AttrIndex, const TSchema& Schema) const; // classification 
+		double StdGain(const int& AttrIndex, const TSchema& Schema) const; // regression 
+		// examples with AttrN = ValN and the label, including the implicit counts of the default value 0 
+		int64 GetCount(const int& AttrN, const int& ValN, const int& Label, const int& ValsN) const;
+		void GetCountV(const int& AttrN, const int& ValsN, const int& LabelsN, TVec<int64>& CountV) const; // CountV[ValN*LabelsN+Label] 
+		void GetValCountV(const int& AttrN, const int& ValN, const int& ValsN, const int& LabelsN, TVec<int64>& CountV) const; // CountV[Label] 
+		// histogram of a numeric attribute, completed in DefHist with the examples that left it at 0.0 if there are any 
+		const THist& GetHist(const int& AttrN, const bool& ClsP, THist& DefHist) const;
+		double ComputeTreshold(const double& Delta, const int& LabelsN, const TAttrHeuristic& AttrHeuristic = TAttrHeuristic::INFO_GAIN) const;
+		void Split(const int& AttrIndex, const TSchema& Schema, PIdGen IdGen, const int& HistBinsN = BinsN); // split the leaf on the AttrIndex attribute 
 		void Clr(); // forget accumulated examples 
-		TBstAttr BestAttr(const TAttrManV& AttrManV, const TTaskType& TaskType = TTaskType::CLASSIFICATION);
-		TBstAttr BestRegAttr(const TAttrManV& AttrManV); // regression 
-		TBstAttr BestClsAttr(const TAttrManV& AttrManV, const TIntV& BannedAttrV = TVec<TInt>()); // classification 
+		TBstAttr BestAttr(const TSchema& Schema);
+		TBstAttr BestRegAttr(const TSchema& Schema); // regression 
+		TBstAttr BestClsAttr(const TSchema& Schema, const TIntV& BannedAttrV = TVec<TInt>()); // classification, information gain 
+		// THeur is TInfoGainHeur or TGiniGainHeur; DiscP (NumP) is false if the schema has no discrete (numeric) attributes 
+		template <class THeur, bool DiscP, bool NumP> TBstAttr BestClsAttrT(const TSchema& Schema, const TIntV& BannedAttrV);
 		void UpdateStats(PExample Example); // regression 
 		inline double Std() const {
 			// NOTE: Unbiased variance estimator is VarSum/(ExamplesN-1)
@@ -326,14 +552,16 @@ namespace TDatastream {
 			return Avg;
 		}
 		void UpdateErr(const double& Loss, const double& Alpha);
+		uint64 GetMemUsed() const; // approximate, in bytes 
 	// private:
 	public:
-		void Init(const TAttrManV& AttrManV);
+		void Init(const TSchema& Schema, const int& HistBinsN = BinsN);
 		int CndAttrIdx; // attribute this node tests on; this is set to -1 in leaf nodes 
-		int ExamplesN; // count the number of examples we accumulated so far (needed for GracePeriod parameter) 
+		int64 ExamplesN; // count the number of examples we accumulated so far (needed for GracePeriod parameter) 
+		int64 DirtyN; // count updates since the last split validity check; not saved, loaded nodes start at ExamplesN 
 		double Val; // test for `numerical attribute' <= Val 
-		double Avg; // current mean (regression only)
-		double VarSum;
+		TMomentFlt Avg; // current mean (regression only)
+		TMomentSum VarSum;
 		double Err; // current error 
 		int TestModeN; // testing mode 
 		TNodeType Type;
@@ -344,8 +572,10 @@ namespace TDatastream {
 #else
 		std::map<TExample, bool> seen_h;
 #endif
-		THash<TTriple<TInt, TInt, TInt>, TInt> Counts; // sufficient statistics; <AttributeID, AttributeValue, Class> 
-		TIntV PartitionV; // number of examples with the same label 
+		// sufficient statistics of discrete attributes; attribute to ValsN x LabelsN counts at ValN*LabelsN+Label, 
+		// added with the first example that has a value other than the default 0 
+		THash<TInt, TCountV> CountH;
+		TCountV PartitionV; // number of examples with the same label 
 		TVec<PNode> ChildrenV;
 		TIntV UsedAttrs; // attributes we already used in predecessor nodes 
 		THash<TInt, THist> HistH; // for each numeric attribute; maps attribute index to histogram
@@ -354,25 +584,150 @@ namespace TDatastream {
 		int Id; // monotonically increasing ID, assigned to each node at creation 
 		int Correct;
 		int All;
+		int LostN; // evaluation rounds an alternate tree lost to the subtree it would replace, in a row 
+		TAdwin Adwin; // estimates the error of the subtree rooted at this node (Hoeffding adaptive tree only) 
+		TIntV SubspaceV; // sorted attributes this leaf may split on; empty means all attributes (random subspaces) 
+	};
+
+	///////////////////////////////
+	// Split-Heuristics
+	// Policies for the split-evaluation kernels; Range is R in the Hoeffding bound 
+	struct TInfoGainHeur {
+		static inline double Discrete(const TNode& Node, const int& AttrN, const TSchema& Schema) { return Node.InfoGain(AttrN, Schema); }
+		static inline double Numeric(const THist& Hist, double& SplitVal) { return Hist.InfoGain(SplitVal); }
+		static inline double Range(const int& LabelsN) { return TMath::Log2(LabelsN); }
+	};
+	struct TGiniGainHeur {
+		static inline double Discrete(const TNode& Node, const int& AttrN, const TSchema& Schema) { return Node.GiniGain(AttrN, Schema); }
+		static inline double Numeric(const THist& Hist, double& SplitVal) { return Hist.GiniGain(SplitVal); }
+		static inline double Range(const int& LabelsN) { return 1.0; }
+	};
+
+	///////////////////////////////
+	// Tree-Snapshot
+	// Immutable view of the main tree (alternate trees are left out) with the leaf statistics needed for prediction; 
+	// nodes are stored in breadth-first order, so the children of a node have consecutive indices 
+	class TTreeView {
+	public:
+		TTreeView(const THoeffdingTree& Tree, const uint64& Version_);
+		TLabel Classify(PExample Example) const; // naive Bayes at the leaf, same as THoeffdingTree::Classify 
+		double Predict(PExample Example) const; // leaf mean, same as THoeffdingTree::Predict 
+		inline int GetNodesN() const { return CndAttrV.Len(); }
+		inline uint64 GetVersion() const { return Version; }
+	private:
+		int GetLeaf(PExample Example) const;
+	private:
+		TIntV CndAttrV; // attribute the node tests on; -1 for leaves 
+		TIntV FstChildV; // index of the first child; -1 for leaves 
+		TFltV ValV; // split value for numeric tests; mean target value in regression leaves 
+		TIntV StatOffV; // offset of the leaf statistics in StatV; -1 for internal nodes 
+		TVec<int64> StatV; // for each leaf: ExamplesN, PartitionV, and ValsN x LabelsN counts for each discrete attribute 
+		TIntV AttrOffV; // offset of the attribute counts within the leaf statistics; -1 for numeric attributes 
+		TBoolV NumericV; // is the attribute numeric? 
+		int LabelsN;
+		uint64 Version;
+	};
+
+	///////////////////////////////
+	// Epoch-Based-Snapshot-Publication
+	// The training thread publishes views; any number of readers pin the latest view without locks. 
+	// A replaced view is deleted once every reader that could have seen it has unpinned [Fraser, 2004]. 
+	ClassTP(TViewPub, PViewPub) // {
+	public:
+		static PViewPub New(const int& MxReadersN = 64) { return new TViewPub(MxReadersN); }
+		~TViewPub();
+		void Publish(TTreeView* View); // training thread only; takes ownership of the view 
+		int Register(); // claim a reader slot; thread-safe 
+		void Unregister(const int& SlotN);
+		const TTreeView* Pin(const int& SlotN); // the view stays valid until Unpin 
+		inline void Unpin(const int& SlotN) { SlotV[SlotN].PinEpoch.store(0); }
+		inline int GetRetiredN() const { return (int)RetiredV.size(); }
+	private:
+		TViewPub(const int& MxReadersN);
+		void Reclaim(); // training thread only 
+	private:
+		struct TSlot {
+			TSlot() : PinEpoch(0), UsedP(false) { }
+			alignas(64) std::atomic<uint64> PinEpoch; // epoch in which the reader pinned its view; 0 when idle 
+			std::atomic<bool> UsedP;
+		};
+		TSlot* SlotV;
+		const int SlotsN;
+		std::atomic<TTreeView*> CrrView;
+		std::atomic<uint64> Epoch;
+		std::vector<std::pair<uint64, TTreeView*> > RetiredV; // replaced views with the epoch of their replacement 
+	};
+
+	// Pins the latest view for the lifetime of the guard; takes the raw publisher, as returned by 
+	// THoeffdingTree::GetViewPub, so that readers never touch the non-atomic PViewPub reference count 
+	class TViewGuard {
+	public:
+		explicit TViewGuard(TViewPub* ViewPub_, const int& SlotN_)
+			: ViewPub(ViewPub_), SlotN(SlotN_) { View = ViewPub->Pin(SlotN); }
+		~TViewGuard() { ViewPub->Unpin(SlotN); }
+		inline const TTreeView* operator->() const { return View; }
+		inline const TTreeView* GetView() const { return View; }
+	private:
+		TViewGuard(const TViewGuard&);
+		TViewGuard& operator=(const TViewGuard&);
+	private:
+		TViewPub* ViewPub;
+		const int SlotN;
+		const TTreeView* View;
+	};
+
+	///////////////////////////////
+	// Sweep-Pool
+	// Worker threads kept for the lifetime of a tree, so drift checks do not start threads. Run hands a job to up to
+	// ThreadsN-1 workers, runs it on the calling thread too, and returns once no worker runs it any more; the job splits
+	// the work itself (through an atomic counter), so workers that wake up late find nothing left and are not waited for 
+	class TSweepPool {
+	public:
+		TSweepPool(const int& WorkersN);
+		~TSweepPool();
+		void Run(const std::function<void()>& Job, const int& ThreadsN); // learning thread only 
+		inline int GetThreadsN() const { return (int)WorkerV.size()+1; }
+	private:
+		TSweepPool(const TSweepPool&);
+		TSweepPool& operator=(const TSweepPool&);
+		void Work(); // worker thread 
+	private:
+		std::mutex Mutex;
+		std::condition_variable WorkCond; // a new job, or stop 
+		std::condition_variable DoneCond; // a worker finished the job 
+		const std::function<void()>* Job;
+		uint64 JobN; // jobs started so far; a worker takes each job at most once 
+		int WantN; // workers the current job still takes 
+		int BusyN; // workers running the current job 
+		bool StopP;
+		std::string ErrStr; // first error of a worker in the current job 
+		std::vector<std::thread> WorkerV;
 	};
 
 	///////////////////////////////
 	// Hoeffding-Tree
 	ClassTP(THoeffdingTree, PHoeffdingTree) // {
 	public:
-		THoeffdingTree(const TStr& ConfigNm_, const int& GracePeriod_, const double& SplitConfidence_, const double& TieBreaking_,
+		THoeffdingTree(const PSchema& Schema_, const int& GracePeriod_, const double& SplitConfidence_, const double& TieBreaking_,
 			const int& DriftCheck_ = 100, const int& WindowSize_ = 10000, const bool& IsAlt_ = false, const double& FadingFactor_ = 0.9995,
 			PIdGen IdGen_ = nullptr)
-			: ConfigNm(ConfigNm_), GracePeriod(GracePeriod_), SplitConfidence(SplitConfidence_), TieBreaking(TieBreaking_), DriftExamplesN(0),
-			DriftCheck(DriftCheck_), WindowSize(WindowSize_), Params(ConfigNm_), BinsN(1000), MxId(1), IsAlt(IsAlt_), AltTreesN(0), FadingFactor(FadingFactor_),
-			CrrErr(1), Salpha(0), Nalpha(0), IdGen(IdGen_), ConceptDriftP(true), ExportN(0) {
+			: THoeffdingTree(Schema_, GracePeriod_, SplitConfidence_, TieBreaking_, DriftCheck_, WindowSize_, IsAlt_, FadingFactor_, IdGen_, false) {
 				if(IdGen() == nullptr) { IdGen = TIdGen::New(); }
 				Init();
 		}
+		static PHoeffdingTree New(const PSchema& Schema, const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking,
+			const int& DriftCheck = 100, const int& WindowSize = 10000, const bool& IsAlt = false, const double& FadingFactor = 0.9995, PIdGen IdGen = nullptr) {
+			return new THoeffdingTree(Schema, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, IsAlt, FadingFactor, IdGen);
+		}
 		static PHoeffdingTree New(const TStr& ConfigNm, const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking,
 			const int& DriftCheck = 100, const int& WindowSize = 10000, const bool& IsAlt = false, const double& FadingFactor = 0.9995, PIdGen IdGen = nullptr) {
-			return new THoeffdingTree(ConfigNm, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, IsAlt, FadingFactor, IdGen);
+			return New(TSchema::New(ConfigNm), GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, IsAlt, FadingFactor, IdGen);
 		}
+		~THoeffdingTree() { delete Profiler; delete SweepPool; }
+		// Learning state, parameters, and settings; the schema is not saved, and neither are snapshots, evaluation, and 
+		// profiling. If IdGen is given, the loaded tree draws IDs from it instead of its saved generator 
+		void Save(TSOut& SOut) const;
+		static PHoeffdingTree Load(TSIn& SIn, const PSchema& Schema, PIdGen IdGen = nullptr);
 		double Predict(PExample Example) const;
 		inline double Predict(const TStr& Line, const TCh& Delimiter = ',') const {
 			return Predict(Preprocess(Line, Delimiter));
@@ -382,9 +737,12 @@ namespace TDatastream {
 		inline TLabel Classify(const TStr& Line, const TCh& Delimiter = ',') const {
 			return Classify(Preprocess(Line, Delimiter));
 		}
-		void IncCounts(PNode Node, PExample Example) const;
-		void DecCounts(PNode Node, PExample Example) const;
-		bool IsAltSplitIdx(PNode Node, const int& AttrIdx) const;
+		// Leaf statistics and split selection run kernels specialized for the heuristic and for all-discrete, all-numeric, 
+		// or mixed schemas; InitKernels picks the instantiations, so the inner loops do not test attribute types 
+		inline void IncCounts(PNode Node, PExample Example) const { (this->*IncCountsFun)(Node, Example); }
+		inline void DecCounts(PNode Node, PExample Example) const { (this->*DecCountsFun)(Node, Example); }
+		TBstAttr BestAttr(PNode Leaf, const TIntV& BannedAttrV = TIntV()) const;
+		bool IsAltSplitIdx(const TNode* Node, const int& AttrIdx) const;
 		void CheckSplitValidityCls();
 		void ForgetCls(PExample Example) const; // classification 
 		void ProcessLeafReg(PNode Leaf, PExample Example); // regression 
@@ -394,37 +752,104 @@ namespace TDatastream {
 		void Process(const TStr& Line, const TCh& Delimiter = ',') {
 			Process(Preprocess(Line, Delimiter));
 		}
-		void Process(PExample Example) {
-			if(TaskType == TTaskType::CLASSIFICATION) {
-				ProcessCls(Example);
-			} else {
-				ProcessReg(Example);
-			}
-		}
-		void ProcessCls(PExample Example);
-		void ProcessReg(PExample Example);
+		void Process(PExample Example) { Process(Example, false); }
+		// Learns a batch with the same result as one example at a time: all examples are routed first, then each leaf learns
+		// its examples in one pass while its statistics are in cache, and checks for a split only at its grace period. 
+		// Under CVFDT only the leaf updates of the main tree are grouped; HAT, the evaluator, subspaces, and CVFDT on schemas 
+		// with numeric attributes need the stream order, so with any of them the examples are processed one by one 
+		void ProcessBatch(const TVec<PExample>& ExampleV);
+		void ProcessBatchCvfdt(const TVec<PExample>& ExampleV); // classification 
+		// Test-then-train in a single traversal: the prediction is taken at the leaf the example reaches during training, 
+		// before the leaf learns from it 
+		inline TLabel ProcessAndClassify(PExample Example) { return (int) Process(Example, true); }
+		inline TLabel ProcessAndClassify(const TStr& Line, const TCh& Delimiter = ',') {
+			return ProcessAndClassify(Preprocess(Line, Delimiter));
+		}
+		inline double ProcessAndPredict(PExample Example) { return Process(Example, true); }
+		inline double ProcessAndPredict(const TStr& Line, const TCh& Delimiter = ',') {
+			return ProcessAndPredict(Preprocess(Line, Delimiter));
+		}
+		// If Pred is not null, it receives the prediction (the label for classification) before the leaf is updated 
+		void ProcessCls(PExample Example, double* Pred = nullptr);
+		void ProcessReg(PExample Example, double* Pred = nullptr);
+		double ProcessHat(PNode Node, PExample Example, const bool& AltP = false, double* Pred = nullptr); // returns the loss of the subtree rooted at Node 
+		double GetLoss(PNode Leaf, PExample Example) const; // prediction loss in [0,1] 
+		double GetLoss(const double& Pred, PExample Example) const;
 		PExample Preprocess(const TStr& Line, const TCh& Delimiter = ',') const;
+		// Same as Preprocess, but touches nothing outside the new example, so other threads may parse concurrently 
+		inline PExample Parse(const TStr& Line, const TCh& Delimiter = ',') const { return Parse(Line.CStr(), Line.Len(), Delimiter); }
+		// The line need not end with a null, but numbers are read with strtod, so the buffer must end with one somewhere after it 
+		PExample Parse(const char* LineBf, const int& LineLen, const TCh& Delimiter = ',') const;
+		PExample PreprocessSparse(const TStrV& LineV) const; // split line in sparse format 
 		PNode GetNextNodeCls(PNode Node, PExample Example) const;
+		// Routing on raw pointers; unlike GetNextNodeCls, this does not touch reference counts 
+		inline TNode* GetChild(const TNode* Node, const TExample& Example) const {
+			const int AttrN = Node->CndAttrIdx;
+			const int ChildN = Schema->IsNumeric(AttrN) ? (Example.GetNum(AttrN) <= Node->Val ? 0 : 1) : Example.GetVal(AttrN);
+			return Node->ChildrenV[ChildN]();
+		}
+		inline TNode* GetLeaf(TNode* Node, const TExample& Example) const {
+			while (Node->CndAttrIdx != -1) { Node = GetChild(Node, Example); }
+			return Node;
+		}
 		void Clr(PNode Node, PNode SubRoot = nullptr);
 		void Export(const TStr& FileNm, const TExportType& ExportType = TExportType::XML) const;
-		TLabel NaiveBayes(PNode Node, PExample Example) const;
+		TLabel NaiveBayes(const TNode* Node, PExample Example) const;
+		inline TLabel NaiveBayes(PNode Node, PExample Example) const { return NaiveBayes(Node(), Example); }
 		inline TLabel Majority(PNode Node) const {
 			return Node->PartitionV.GetMxValN();
 		}
 		inline TStr GetNodeNm(PNode Node) const {
-			return AttrManV.GetVal(Node->CndAttrIdx).Nm.CStr();
+			return Schema->GetAttrNm(Node->CndAttrIdx);
 		}
 		inline TStr GetNodeValueNm(PNode Node, const int& ChildN) const {
 			Assert(ChildN >= 0);
-			return AttrManV.GetVal(Node->CndAttrIdx).InvAttrH.GetDat(ChildN);
+			return Schema->GetValNm(Node->CndAttrIdx, ChildN);
 		}
 		inline TStr GetMajorityNm(PNode Node) const {
-			return AttrManV.GetVal(AttrManV.Len()-1).InvAttrH.GetDat(Node->PartitionV.GetMxValN());
+			return Schema->GetLabelNm(Node->PartitionV.GetMxValN());
 		}
 		inline bool IsLeaf(PNode Node) const { return Node->CndAttrIdx == -1; }
 		void PrintHist(const TStr& FNm, const TCh& Ch = '#') const;
 		void Print(PExample Example) const; // print example in human-readable form 
-		void SetAdaptive(const bool& DriftP) { ConceptDriftP = DriftP; }
+		void SetAdaptive(const bool& DriftP) { DriftMode = DriftP ? TDriftMode::CVFDT : TDriftMode::NONE; }
+		void SetAdaptive(const TDriftMode& DriftMode_) { DriftMode = DriftMode_; }
+		inline TDriftMode GetDriftMode() const { return DriftMode; }
+		// Each leaf considers only SubspaceN_ randomly chosen attributes; see [Breiman, 2001] and [Gomes et al., 2017] 
+		void SetSubspace(const int& SubspaceN_, const int& Seed = 1) { SubspaceN = SubspaceN_; Rnd.PutSeed(Seed); }
+		// Histogram size for numeric attributes; resets the root, so call before the first example 
+		void SetBinsN(const int& BinsN_);
+		void SetAttrHeuristic(const TAttrHeuristic& AttrHeuristic_) { AttrHeuristic = AttrHeuristic_; InitKernels(); }
+		// Input lines list `index:value' pairs of the attributes that differ from their default, then the label; see TExample 
+		void SetSparse(const bool& SparseP_) { SparseP = SparseP_; }
+		inline bool IsSparse() const { return SparseP; }
+		// Drift checks skip internal nodes with fewer than RecheckN_ updates since their last check (0 checks all; the default 
+		// is the grace period) and evaluate the rest on ThreadsN threads (0 for one per core) 
+		void SetRecheck(const int& RecheckN_, const int& ThreadsN = 1);
+		// Alternate trees: at most MxNodeAltsN_ per node and MxAltsN_ in the whole tree; alternates that lose MxAltLostN_ 
+		// evaluation rounds in a row are pruned, and if alternates take more than MxAltMemB_ bytes, the worst ones are 
+		// evicted at the next drift check. 0 means no limit 
+		void SetAltBudget(const int& MxNodeAltsN_, const int& MxAltsN_, const uint64& MxAltMemB_ = 0, const int& MxAltLostN_ = 3);
+		inline int GetAltTreesN() const { return AltTreesN; }
+		inline TAttrHeuristic GetAttrHeuristic() const { return AttrHeuristic; }
+		void InitSubspace(PNode Leaf);
+		// Publish a snapshot after every structural change and, if PubPeriod_ > 0, every PubPeriod_ examples to refresh leaf statistics; 
+		// readers on other threads obtain a slot with GetViewPub()->Register() and score through TViewGuard 
+		void EnableSnapshots(const int& MxReadersN = 64, const int& PubPeriod_ = 0);
+		// PViewPub reference counts are not atomic, so readers take the raw pointer and never copy the handle; 
+		// the tree keeps the publisher alive and must outlive its readers 
+		inline TViewPub* GetViewPub() const { return ViewPub(); }
+		void Publish();
+		// Prequential evaluation of every processed example; see TPreqEval 
+		void EnableEval(const TStr& CurveFNm = TStr(), const int& ReportEvery = 1000, const int& WindowN = 1000);
+		inline PPreqEval GetEval() const { return Eval; }
+		int GetNodesN() const; // including alternate trees 
+		uint64 GetMemUsed() const; // bytes 
+		// Phase counters and latency histograms; empty unless profiling is on, and when compiled with HT_NPROFILE 
+		const TPhaseProfiler& GetProfiler() const;
+		inline void ClrProfiler() { if (Profiler != nullptr) { Profiler->Clr(); } }
+		// Profiling is off by default, since the profiler takes about 150 KB; it is allocated when turned on 
+		void SetProfiling(const bool& ProfileP);
 		inline static bool Sacrificed(PNode Node, PExample Example) {
 #if GLIB_OK
 			return Node->SeenH.IsKey(*Example);
@@ -442,36 +867,73 @@ namespace TDatastream {
 		//}
 	public:
 		PNode Root; // root node 
-		THash<TStr, TInt> LabelH; // maps label to integer 
-		THash<TInt, TStr> InvLabelH; // maps integer to label 
-		TVec<THash<TStr, TInt> > AttrsHashV; // vector of attribute hash tables 
-		TVec<THash<TInt, TStr> > InvAttrsHashV; // vector of attribute inverse hash tables 
-		TAttrManV AttrManV; // attribute managment 
-		TParser Params; // data stream parameters 
+		const PSchema Schema; // attributes and labels; possibly shared with other trees 
 		int ExportN;
 	private:
+		static const int FormatVersion; // of Save; bumped whenever the layout of a tree or its nodes changes 
 		double TieBreaking; // tau; when to consider two attributes equally good 
 		double SplitConfidence; // delta; NOTE: this is actually error tolerance; condifdence would be 1-`SplitConfidence'
 		int GracePeriod; // nmin; recompute heuristic estimates every nmin examples 
-		TStr ConfigNm; // configuration file name 
 		int DriftCheck; // check for drift every `DriftCheck' examples 
 		int WindowSize; // keep `WindowSize' examples in main memory 
 		// int MemoryConstraint; // memory contraints (?) 
 		const bool IsAlt; // alternate trees are not allowed to grow altenrate trees 
-		const int BinsN; // number of bins when apprximating numberic attribute's value distribution with histogram 
+		int BinsN; // number of bins when apprximating numberic attribute's value distribution with histogram 
 		int MxId;
 		TTaskType TaskType;
 		int AltTreesN; // number of alternate trees 
 		TQQueue<PExample> ExampleQ; // last W examples 
 		int DriftExamplesN; // examples since last drift check 
 		const double FadingFactor; // fading factor used for error estimation; see `On Evaluating Stream Learning Algorithms' [Gama et al., 2013]
-		double CrrErr; // current prequential error using fading factors 
-		double Salpha;
-		double Nalpha;
 		PIdGen IdGen; // ID generator 
-		bool ConceptDriftP;
+		TDriftMode DriftMode;
+		double MnRegVal; // smallest target value seen so far; normalizes regression loss 
+		double MxRegVal; // largest target value seen so far 
+		int SubspaceN; // attributes considered at each leaf; 0 means all 
+		TRnd Rnd;
+		PViewPub ViewPub; // snapshots for concurrent readers; empty unless enabled 
+		bool StructChangeP; // tree changed since the last snapshot 
+		int PubPeriod; // refresh snapshot statistics every PubPeriod examples 
+		int PubExamplesN;
+		uint64 ViewVersion;
+		PPreqEval Eval; // empty unless enabled 
+		TPhaseProfiler* Profiler; // also updated by const methods (Preprocess, Classify, ForgetCls); null if profiling is off 
+		TAttrHeuristic AttrHeuristic;
+		bool SparseP; // sparse input lines 
+		int RecheckN; // updates an internal node needs before its split is checked again 
+		int SweepThreadsN; // threads evaluating the nodes of a drift check 
+		TSweepPool* SweepPool; // the other SweepThreadsN-1 threads; null with one thread 
+		int MxNodeAltsN; // alternate trees per node; 0 for no limit 
+		int MxAltsN; // alternate trees in the whole tree 
+		uint64 MxAltMemB; // bytes taken by alternate trees 
+		int MxAltLostN; // evaluation rounds lost in a row before an alternate is pruned 
+		// kernel instantiations chosen by InitKernels 
+		typedef void (THoeffdingTree::*TCountsFun)(PNode Node, PExample Example) const;
+		typedef TBstAttr (TNode::*TBstAttrFun)(const TSchema& Schema, const TIntV& BannedAttrV);
+		TCountsFun IncCountsFun;
+		TCountsFun DecCountsFun;
+		TBstAttrFun BestClsAttrFun;
 	private:
-		void Init(); // initialize attribute managment classes 
+		THoeffdingTree(const THoeffdingTree&); // owns the profiler 
+		// Parameters and defaults only, without an ID generator or a root; Load reads those instead of building them 
+		THoeffdingTree(const PSchema& Schema_, const int& GracePeriod_, const double& SplitConfidence_, const double& TieBreaking_,
+			const int& DriftCheck_, const int& WindowSize_, const bool& IsAlt_, const double& FadingFactor_, PIdGen IdGen_, const bool& /*LoadP*/)
+			: Schema(Schema_), GracePeriod(GracePeriod_), SplitConfidence(SplitConfidence_), TieBreaking(TieBreaking_), DriftExamplesN(0),
+			DriftCheck(DriftCheck_), WindowSize(WindowSize_), BinsN(TDatastream::BinsN), MxId(1), IsAlt(IsAlt_), AltTreesN(0), FadingFactor(FadingFactor_),
+			IdGen(IdGen_), DriftMode(TDriftMode::CVFDT), MnRegVal(TFlt::Mx), MxRegVal(TFlt::Mn), SubspaceN(0), StructChangeP(false), PubPeriod(0), PubExamplesN(0), ViewVersion(0), ExportN(0), Profiler(nullptr), AttrHeuristic(TAttrHeuristic::INFO_GAIN), SparseP(false),
+			RecheckN(GracePeriod_), SweepThreadsN(1), SweepPool(nullptr), MxNodeAltsN(3), MxAltsN(100), MxAltMemB(0), MxAltLostN(3) {
+				TaskType = Schema->GetTaskType();
+		}
+		double Process(PExample Example, const bool& PredP); // returns the prediction if PredP 
+		void Init(); // initialize the root node 
+		void InitKernels();
+		void EnforceAltBudget(); // recount alternate trees and evict the worst ones beyond the memory budget 
+		static uint64 GetSubtreeMemUsed(const TNode* Node); // with its alternate trees 
+		static void MulNaiveBayes(const TVec<int64>& CountV, const TFltV& PriorV, const int& AttrsN, TFltV& ProbV);
+		template <bool DiscP, bool NumP> void IncCountsT(PNode Node, PExample Example) const;
+		template <bool DiscP, bool NumP> void DecCountsT(PNode Node, PExample Example) const;
+		void IncDiscCount(PNode Node, PExample Example, const TAttribute& Attr) const;
+		void DecDiscCount(PNode Node, PExample Example, const TAttribute& Attr) const;
 		void PrintXML(PNode Node, const int& Depth, TFOut& FOut) const; // export decision tree to XML 
 		void PrintJSON(PNode Node, const int& Depth, TFOut& FOut) const;
 		void PrintDOT(PNode Node, TFOut& FOut, const bool& AlternateP = false) const;
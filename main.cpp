@@ -1,10 +1,16 @@
 #include "hoeffding.h"
+#include "ensemble.h"
+#include "server.h"
+#include "pipeline.h"
 #include "winnow.h"
 
 using namespace TDatastream;
 
-void ProcessData(const TStr& FileNm, PHoeffdingTree HoeffdingTree);
-void WinnowTest(const TVec<TIntV>& ExamplesV);
+void ProcessData(const TStr& FileNm, PHoeffdingTree HoeffdingTree, const int& ProfileEvery = 0, const int& ParsersN = 0);
+void ProcessData(const TStr& FileNm, PHoeffdingEnsemble Ensemble, const int& ParsersN = 0);
+TDriftMode GetDriftMode(const TStr& DriftModeNm);
+TAttrHeuristic GetAttrHeuristic(const TStr& AttrHeuristicNm);
+void WinnowTest(const TVec<TIntV>& ActiveVV, const TIntV& LabelV, const int& FeaturesN);
 void WinnowTest(const TStr& FileNm);
 
 int main(int argc, char** argv) {
@@ -13,6 +19,7 @@ int main(int argc, char** argv) {
 		Env = TEnv(argc, argv, TNotify::StdNotify);
 		// Pass some parameters 
 		const bool ConceptDriftP = Env.IsArgStr("drift"); // use version that handles concept-drift? 
+		const TStr DriftModeNm = Env.GetIfArgPrefixStr("-driftMode:", "cvfdt", "Concept drift handling (none, cvfdt, hat)");
 		const double SplitConfidence = Env.GetIfArgPrefixFlt("-splitConfidence:", 1e-6, "Split confidence"); // 1e-6 
 		const double TieBreaking = Env.GetIfArgPrefixFlt("-tieBreaking:", 0.01, "Tie breaking"); // 1e-2 
 		// const TStr ConfigFNm = Env.GetIfArgPrefixStr("-config:", "sea.config", "Config file");
@@ -21,29 +28,105 @@ int main(int argc, char** argv) {
 		// const TStr ConfigFNm = Env.GetIfArgPrefixStr("-config:", "nyel-numeric.config", "Config file"); // regression problem 
 		// const TStr ConfigFNm = Env.GetIfArgPrefixStr("-config:", "housing.config", "Config file");
 		const TStr ConfigFNm = Env.GetIfArgPrefixStr("-config:", "regression-test.config", "Config file");
-		const TStr AttrHeuristic= Env.GetIfArgPrefixStr("-attrEval:", "InfoGain", "Attribute evaluation heuristic");
+		const TStr SchemaCacheDir = Env.GetIfArgPrefixStr("-schemaCache:", "", "Directory of compiled configurations (no cache if empty)");
+		const TStr AttrHeuristic= Env.GetIfArgPrefixStr("-attrEval:", "InfoGain", "Attribute evaluation heuristic (InfoGain, GiniGain)");
 		const int GracePeriod = Env.GetIfArgPrefixInt("-gracePeriod:", 300, "Grace period"); // 3e2 
 		const int DriftCheck = Env.GetIfArgPrefixInt("-driftCheck:", 10000, "Drift check"); // 1e4 
 		const int WindowSize = Env.GetIfArgPrefixInt("-windowSize:", 50000, "Window size"); // 1e5 
 		// const TStr ExportFNm = Env.GetIfArgPrefixStr("-export:", "titanic.xml", "Decision tree export file");
+		const TStr DataFNm = Env.GetIfArgPrefixStr("-data:", "data/regression-test.dat", "Data file");
+		const int TreesN = Env.GetIfArgPrefixInt("-trees:", 1, "Number of trees (online bagging if more than one)");
+		const double Lambda = Env.GetIfArgPrefixFlt("-lambda:", 1.0, "Poisson parameter for online bagging");
+		const int SubspaceN = Env.GetIfArgPrefixInt("-subspace:", 0, "Attributes considered at each leaf (0 for all)");
+		const int HistBinsN = Env.GetIfArgPrefixInt("-bins:", BinsN, "Histogram bins per numeric attribute");
+		const bool SparseP = Env.GetIfArgPrefixBool("-sparse:", false, "Sparse data lines: index:value pairs, then the label");
+		const int ThreadsN = Env.GetIfArgPrefixInt("-threads:", 0, "Worker threads for the ensemble, or for drift checks of a single tree (0 for one per core)");
+		const int MxAltsN = Env.GetIfArgPrefixInt("-maxAlts:", 100, "Alternate trees per tree (0 for no limit); at most three per node");
+		const int AltMemMB = Env.GetIfArgPrefixInt("-altMemMB:", 0, "Memory budget of alternate trees in MB (0 for no limit)");
+		const int RecheckN = Env.GetIfArgPrefixInt("-recheck:", -1, "Updates of an internal node before its split is checked again (-1 for the grace period)");
+		const int ParsersN = Env.GetIfArgPrefixInt("-parsers:", 0, "Parser threads between the reader and the learner (0 to read and parse on the learner thread)");
+		const TStr ModeNm = Env.GetIfArgPrefixStr("-mode:", "train", "Run mode (train, serve)");
+		const TStr SocketFNm = Env.GetIfArgPrefixStr("-socket:", "", "Unix domain socket for serve mode (stdin if empty)");
+		const int MxBatchN = Env.GetIfArgPrefixInt("-batch:", 1024, "Maximal number of requests in a batch (serve mode)");
+		const int MxWaitMSecs = Env.GetIfArgPrefixInt("-batchWait:", 2, "Milliseconds to wait for a batch to fill up (serve mode)");
+		const TStr TraceFNm = Env.GetIfArgPrefixStr("-trace:", "", "Binary event trace file; decode with scripts/trace-decode.py (no trace if empty)");
+		const TStr TraceLevelNm = Env.GetIfArgPrefixStr("-traceLevel:", "struct", "Trace verbosity (struct, check, all)");
+		const int EvalEvery = Env.GetIfArgPrefixInt("-evalEvery:", 0, "Prequential evaluation; learning-curve row every n examples (0 for no evaluation)");
+		const TStr EvalCurveFNm = Env.GetIfArgPrefixStr("-evalCurve:", "learning-curve.tsv", "Learning-curve file");
+		const int EvalWindow = Env.GetIfArgPrefixInt("-evalWindow:", 1000, "Sliding window for prequential evaluation");
+		const int ProfileEvery = Env.GetIfArgPrefixInt("-profileEvery:", 0, "Print phase counters every n examples (0 for only at the end)");
 		
 		EAssertR(SplitConfidence > 0, "Split confidence must be positive real number.");
 		EAssertR(GracePeriod > 0, "Positive integer");
 		EAssertR(DriftCheck > 0, "Positive integer.");
 		EAssertR(WindowSize > 0, "Window size should be positive integer.");
 		EAssertR(TieBreaking >= 0, "Tie breaking must be nonnegative.");
+		EAssertR(TreesN > 0, "Number of trees should be positive integer.");
+		EAssertR(Lambda > 0, "Poisson parameter must be positive.");
+		EAssertR(SubspaceN >= 0, "Subspace size must be nonnegative.");
+		EAssertR(HistBinsN > 1, "Number of histogram bins must be at least two.");
+		EAssertR(ModeNm == "train" || ModeNm == "serve", "Mode must be either train or serve.");
+		EAssertR(MxBatchN > 0 && MxWaitMSecs >= 0, "Batch size must be positive and batch wait nonnegative.");
+		EAssertR(ProfileEvery >= 0, "Profile period must be nonnegative.");
+		EAssertR(ParsersN >= 0, "Number of parser threads must be nonnegative.");
+		EAssertR(RecheckN >= -1, "Recheck period must be nonnegative (or -1).");
+		EAssertR(MxAltsN >= 0 && AltMemMB >= 0, "Alternate tree limits must be nonnegative.");
+		EAssertR(EvalEvery >= 0 && EvalWindow > 0, "Evaluation period must be nonnegative and window positive.");
 
 		// Reset error 
 		// TStr FNm = ConceptDriftP ? "err-cvfdt.dat" : "err-vfdt.dat";
 		// if (TFile::Exists(FNm)) { TFile::Del(FNm); }
 
+		if (!TraceFNm.Empty()) { TTrace::Start(TTrace::GetLevel(TraceLevelNm)); }
+		TSchema::SetCacheDir(SchemaCacheDir);
+
+		if (TreesN > 1) { // ensemble 
+			PHoeffdingEnsemble Ensemble = THoeffdingEnsemble::New("docs/" + ConfigFNm, TreesN, GracePeriod, SplitConfidence, TieBreaking,
+				DriftCheck, WindowSize, Lambda, SubspaceN, ThreadsN);
+			Ensemble->SetAdaptive(GetDriftMode(DriftModeNm));
+			for (int TreeN = 0; TreeN < Ensemble->GetTreesN(); ++TreeN) {
+				Ensemble->GetTree(TreeN)->SetBinsN(HistBinsN);
+				Ensemble->GetTree(TreeN)->SetAttrHeuristic(GetAttrHeuristic(AttrHeuristic));
+				Ensemble->GetTree(TreeN)->SetSparse(SparseP);
+				Ensemble->GetTree(TreeN)->SetRecheck(RecheckN == -1 ? GracePeriod : RecheckN);
+				Ensemble->GetTree(TreeN)->SetAltBudget(3, MxAltsN, (uint64) AltMemMB*1024*1024/TreesN);
+			}
+			TTmProfiler Prof;
+			Prof.AddTimer("HoeffdingEnsemble");
+			Prof.StartTimer(0);
+			ProcessData(DataFNm, Ensemble, ParsersN);
+			Prof.StopTimer(0);
+			printf("Time = %f sec\n", Prof.GetTimerSec(0));
+			if (!TraceFNm.Empty()) { TTrace::Stop(); TTrace::Save(TraceFNm); }
+			return 0;
+		}
+
 		// usage example 
 		PHoeffdingTree ht = THoeffdingTree::New("docs/" + ConfigFNm, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize);
 		// ht->SetAdaptive(true); // ht->SetAdaptive(ConceptDriftP);
+		ht->SetAdaptive(GetDriftMode(DriftModeNm));
+		ht->SetProfiling(true);
+		if (SubspaceN > 0) { ht->SetSubspace(SubspaceN); }
+		ht->SetBinsN(HistBinsN);
+		ht->SetAttrHeuristic(GetAttrHeuristic(AttrHeuristic));
+		ht->SetSparse(SparseP);
+		ht->SetRecheck(RecheckN == -1 ? GracePeriod : RecheckN, ThreadsN);
+		ht->SetAltBudget(3, MxAltsN, (uint64) AltMemMB*1024*1024);
+		if (EvalEvery > 0) { ht->EnableEval(EvalCurveFNm, EvalEvery, EvalWindow); }
+		if (ModeNm == "serve") { // long-lived sidecar 
+			PServer Server = TServer::New(ht, MxBatchN, MxWaitMSecs);
+			if (SocketFNm.Empty()) {
+				Server->ServeStdIn();
+			} else {
+				Server->ServeUnixSocket(SocketFNm);
+			}
+			fprintf(stderr, "%s\n", Server->GetStatsStr().CStr());
+			return 0;
+		}
 		TTmProfiler Prof;
 		Prof.AddTimer("HoeffdingTree");
 		Prof.StartTimer(0);
-		ProcessData("data/regression-test.dat", ht);
+		ProcessData(DataFNm, ht, ProfileEvery, ParsersN);
 		// ProcessData("data/sea.dat", ht);
 		// ProcessData("data/nyel-base-final.dat", ht);
 		// ProcessData("data/nyel-numeric-final.dat", ht);
@@ -71,6 +154,9 @@ int main(int argc, char** argv) {
 		printf("Time = %f sec\n", Prof.GetTimerSec(0));
 		printf("Time = %f min\n", Prof.GetTimerSec(0)/60.0);
 		printf("Time = %f h\n", Prof.GetTimerSec(0)/(60.0*60.0));
+		printf("%s", ht->GetProfiler().GetStr().CStr());
+		if (EvalEvery > 0) { printf("%s\n", ht->GetEval()->GetStr().CStr()); }
+		if (!TraceFNm.Empty()) { TTrace::Stop(); TTrace::Save(TraceFNm); }
 		//ht->Export("exports/housing-100K.xml");
 		ht->Export("exports/regression-test.gv", TExportType::DOT);
 		// ht->PrintHist("exports/adult.hist");
@@ -92,39 +178,98 @@ int main(int argc, char** argv) {
 	return 0;
 }
 
-// process data line-by-line 
-void ProcessData(const TStr& FileNm, PHoeffdingTree HoeffdingTree) {
+// process data line-by-line, plain or compressed; with parser threads, the learner thread only learns 
+void ProcessData(const TStr& FileNm, PHoeffdingTree HoeffdingTree, const int& ProfileEvery, const int& ParsersN) {
 	Assert(TFile::Exists(FileNm));
-	TFIn FIn(FileNm);
+	uint64 ExamplesN = 0;
+	if (ParsersN > 0) {
+		PPipeline Pipeline = TPipeline::New(HoeffdingTree, FileNm, ParsersN);
+		TVec<PExample> ExampleV;
+		while (Pipeline->NextBatch(ExampleV)) {
+			HoeffdingTree->ProcessBatch(ExampleV);
+			const uint64 PrevExamplesN = ExamplesN;
+			ExamplesN += ExampleV.Len();
+			if (ProfileEvery > 0 && ExamplesN/ProfileEvery != PrevExamplesN/ProfileEvery) {
+				printf("[Profile] %s examples\n%s", TUInt64::GetStr(ExamplesN).CStr(), HoeffdingTree->GetProfiler().GetStr().CStr());
+			}
+		}
+		printf("[Pipeline] %s\n", Pipeline->GetStatsStr().CStr());
+		return;
+	}
+	PDataIn In = TDataIn::New(FileNm);
 	TStr Line;
-	while (FIn.GetNextLn(Line)) {
+	while (In->GetNextLn(Line)) {
+		if (Line.Empty()) { continue; }
 		HoeffdingTree->Process(Line, ',');
+		if (ProfileEvery > 0 && ++ExamplesN % ProfileEvery == 0) {
+			printf("[Profile] %s examples\n%s", TUInt64::GetStr(ExamplesN).CStr(), HoeffdingTree->GetProfiler().GetStr().CStr());
+		}
 	}
 }
 
-void WinnowTest(const TVec<TIntV>& ExamplesV) {
-	const int DimN = ExamplesV.Last().Len();
-	printf("DimN = %d\n", DimN);
-	PWinnow Winnow = TWinnow::New(DimN-1);
-	for (TVec<TIntV>::TIter It = ExamplesV.BegI(); It != ExamplesV.EndI(); ++It) {
-		Winnow->Process(*It);
+void ProcessData(const TStr& FileNm, PHoeffdingEnsemble Ensemble, const int& ParsersN) {
+	Assert(TFile::Exists(FileNm));
+	if (ParsersN > 0) {
+		PPipeline Pipeline = TPipeline::New(Ensemble->GetTree(0), FileNm, ParsersN);
+		PExample Example;
+		while (Pipeline->Next(Example)) {
+			Ensemble->Process(Example);
+		}
+		printf("[Pipeline] %s\n", Pipeline->GetStatsStr().CStr());
+	} else {
+		PDataIn In = TDataIn::New(FileNm);
+		TStr Line;
+		while (In->GetNextLn(Line)) {
+			if (Line.Empty()) { continue; }
+			Ensemble->Process(Line, ',');
+		}
 	}
-	printf("Classify last as %d.\n", Winnow->Classify(ExamplesV.Last()));
+	Ensemble->Flush();
+}
+
+TDriftMode GetDriftMode(const TStr& DriftModeNm) {
+	if (DriftModeNm == "none") { return TDriftMode::NONE; }
+	if (DriftModeNm == "cvfdt") { return TDriftMode::CVFDT; }
+	if (DriftModeNm == "hat") { return TDriftMode::HAT; }
+	throw TDtExcept::New("Drift mode must be one of none, cvfdt, or hat.");
+}
+
+TAttrHeuristic GetAttrHeuristic(const TStr& AttrHeuristicNm) {
+	if (AttrHeuristicNm == "InfoGain") { return TAttrHeuristic::INFO_GAIN; }
+	if (AttrHeuristicNm == "GiniGain" || AttrHeuristicNm == "Gini") { return TAttrHeuristic::GINI_GAIN; }
+	throw TDtExcept::New("Attribute heuristic must be either InfoGain or GiniGain.");
+}
+
+void WinnowTest(const TVec<TIntV>& ActiveVV, const TIntV& LabelV, const int& FeaturesN) {
+	printf("FeaturesN = %d\n", FeaturesN);
+	const int LabelsN = TMath::Mx<int>(LabelV.Len() > 0 ? LabelV[LabelV.GetMxValN()]+1 : 0, 2);
+	PWinnow Winnow = TWinnow::NewMulti(FeaturesN, LabelsN);
+	Winnow->ProcessBatch(ActiveVV, LabelV);
+	printf("Classify last as %d.\n", Winnow->ClassifySparse(ActiveVV.Last()));
 }
 
+// Dense 0/1 lines with the label last; the line is scanned in place into the indices of the active features 
 void WinnowTest(const TStr& FileNm) {
-	TVec<TIntV> ExamplesV;
-	TFIn FIn(FileNm);
+	TVec<TIntV> ActiveVV;
+	TIntV LabelV;
+	int FeaturesN = 0;
+	PDataIn In = TDataIn::New(FileNm);
 	TStr Ln;
-	TStrV LnV;
-	while (!FIn.Eof()) {
-		TIntV ExampleV;
-		FIn.GetNextLn(Ln);
-		Ln.SplitOnAllCh(',', LnV);
-		for (TStrV::TIter It = LnV.BegI(); It != LnV.EndI(); ++It) {
-			ExampleV.Add(It->GetInt());
+	while (In->GetNextLn(Ln)) {
+		if (Ln.Empty()) { continue; }
+		TIntV ActiveV;
+		const char* Ch = Ln.CStr();
+		int FieldN = 0, Val = 0;
+		for (; *Ch != 0; ++Ch) {
+			if (*Ch == ',') {
+				if (Val != 0) { ActiveV.Add(FieldN); }
+				++FieldN; Val = 0;
+			} else if (TCh::IsNum(*Ch)) {
+				Val = 10*Val+(*Ch-'0');
+			}
 		}
-		ExamplesV.Add(ExampleV);
+		FeaturesN = TMath::Mx<int>(FeaturesN, FieldN);
+		ActiveVV.Add(ActiveV); LabelV.Add(Val);
 	}
-	WinnowTest(ExamplesV);
+	WinnowTest(ActiveVV, LabelV, FeaturesN);
 }
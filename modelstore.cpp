@@ -0,0 +1,125 @@
+#include "modelstore.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Model-Store
+	TModelStore::TModelStore(const PSchema& Schema_, const int& GracePeriod_, const double& SplitConfidence_, const double& TieBreaking_,
+		const int& MxLiveN_, const TStr& SnapshotDir_)
+		: Schema(Schema_), IdGen(TIdGen::New()), GracePeriod(GracePeriod_), SplitConfidence(SplitConfidence_), TieBreaking(TieBreaking_),
+		MxLiveN(MxLiveN_), SnapshotDir(SnapshotDir_), DriftCheck(10000), WindowSize(50000), DriftMode(TDriftMode::NONE), BinsN(TDatastream::BinsN),
+		AttrHeuristic(TAttrHeuristic::INFO_GAIN), SparseP(false), LiveN(0), Tick(0), EvictionsN(0), LoadsN(0) {
+		EAssertR(MxLiveN > 0, "At least one tenant tree must stay live.");
+		if (!SnapshotDir.Empty() && !TDir::Exists(SnapshotDir)) { TDir::GenDir(SnapshotDir); }
+	}
+	void TModelStore::Process(const TStr& Line, const TCh& Delimiter) {
+		TStr Key, ExampleStr;
+		Line.SplitOnCh(Key, Delimiter, ExampleStr);
+		EAssertR(!Key.Empty(), "Missing tenant key: " + Line);
+		GetTree(Key)->Process(ExampleStr, Delimiter);
+	}
+	PHoeffdingTree TModelStore::NewTree() const {
+		PHoeffdingTree Tree = THoeffdingTree::New(Schema, GracePeriod, SplitConfidence, TieBreaking, DriftCheck, WindowSize, false, 0.9995, IdGen);
+		Tree->SetAdaptive(DriftMode);
+		if (BinsN != TDatastream::BinsN) { Tree->SetBinsN(BinsN); }
+		if (AttrHeuristic != TAttrHeuristic::INFO_GAIN) { Tree->SetAttrHeuristic(AttrHeuristic); }
+		Tree->SetSparse(SparseP);
+		return Tree;
+	}
+	PHoeffdingTree TModelStore::GetTree(const TStr& Key) {
+		int KeyId = TenantH.GetKeyId(Key);
+		if (KeyId == -1) { KeyId = TenantH.AddKey(Key); }
+		TTenant& Tenant = TenantH[KeyId];
+		Tenant.LastTick = ++Tick;
+		if (!Tenant.Tree.Empty()) { return Tenant.Tree; }
+		if (LiveN == MxLiveN) { EvictLru(KeyId); }
+		if (!Tenant.Snapshot.Empty()) {
+			TMemIn MIn(*Tenant.Snapshot);
+			Tenant.Tree = THoeffdingTree::Load(MIn, Schema, IdGen);
+			Tenant.Snapshot.Clr();
+			++LoadsN;
+		} else if (!SnapshotDir.Empty() && TFile::Exists(GetSnapshotFNm(KeyId))) {
+			TFIn FIn(Tenant.SnapshotFNm);
+			const TStr SavedKey(FIn);
+			EAssertR(SavedKey == Key, "Snapshot `" + Tenant.SnapshotFNm + "' belongs to tenant `" + SavedKey + "', not `" + Key + "'.");
+			Tenant.Tree = THoeffdingTree::Load(FIn, Schema, IdGen);
+			++LoadsN;
+		} else {
+			Tenant.Tree = NewTree();
+		}
+		++LiveN;
+		return Tenant.Tree;
+	}
+	void TModelStore::Evict(const TStr& Key) {
+		const int KeyId = TenantH.GetKeyId(Key);
+		if (KeyId != -1) { Evict(KeyId); }
+	}
+	void TModelStore::Evict(const int& KeyId) {
+		TTenant& Tenant = TenantH[KeyId];
+		if (Tenant.Tree.Empty()) { return; }
+		if (SnapshotDir.Empty()) {
+			Tenant.Snapshot = TMem::New();
+			TMemOut MOut(Tenant.Snapshot);
+			Tenant.Tree->Save(MOut);
+		} else {
+			TFOut FOut(GetSnapshotFNm(KeyId));
+			TenantH.GetKey(KeyId).Save(FOut);
+			Tenant.Tree->Save(FOut);
+		}
+		Tenant.Tree.Clr(); // the nodes go back to the node pool
+		--LiveN; ++EvictionsN;
+	}
+	// Hashes of different keys may collide; the next free name is taken then, and the key saved in front of the tree tells
+	// the files apart. The name is looked up once per tenant
+	TStr TModelStore::GetSnapshotFNm(const int& KeyId) {
+		TTenant& Tenant = TenantH[KeyId];
+		if (!Tenant.SnapshotFNm.Empty()) { return Tenant.SnapshotFNm; }
+		const TStr& Key = TenantH.GetKey(KeyId);
+		for (int ProbeN = 0; ; ++ProbeN) {
+			const TStr FNm = GetSnapshotFNm(Key, ProbeN);
+			if (TFile::Exists(FNm)) {
+				TFIn FIn(FNm);
+				if (TStr(FIn) != Key) { continue; }
+			}
+			Tenant.SnapshotFNm = FNm;
+			return FNm;
+		}
+	}
+	TStr TModelStore::GetSnapshotFNm(const TStr& Key, const int& ProbeN) const {
+		TStr FNm = SnapshotDir + "/tenant-" + TStr::Fmt("%08x%08x", (uint) Key.GetPrimHashCd(), (uint) Key.GetSecHashCd());
+		if (ProbeN > 0) { FNm += "-" + TInt::GetStr(ProbeN); }
+		return FNm + ".ht";
+	}
+	// NOTE: Linear in the number of tenants, but runs only when a tenant is loaded into a full store
+	void TModelStore::EvictLru(const int& KeepKeyId) {
+		int LruKeyId = -1;
+		uint64 LruTick = TUInt64::Mx;
+		for (int KeyId = TenantH.FFirstKeyId(); TenantH.FNextKeyId(KeyId); ) {
+			const TTenant& Tenant = TenantH[KeyId];
+			if (KeyId == KeepKeyId || Tenant.Tree.Empty()) { continue; }
+			if (Tenant.LastTick < LruTick) { LruTick = Tenant.LastTick; LruKeyId = KeyId; }
+		}
+		if (LruKeyId != -1) { Evict(LruKeyId); }
+	}
+	void TModelStore::EvictIdle(const uint64& MxIdleN) {
+		for (int KeyId = TenantH.FFirstKeyId(); TenantH.FNextKeyId(KeyId); ) {
+			if (Tick-TenantH[KeyId].LastTick > MxIdleN) { Evict(KeyId); }
+		}
+	}
+	void TModelStore::EvictAll() {
+		for (int KeyId = TenantH.FFirstKeyId(); TenantH.FNextKeyId(KeyId); ) { Evict(KeyId); }
+	}
+	uint64 TModelStore::GetMemUsed() const {
+		uint64 MemUsed = sizeof(TModelStore)+TenantH.GetMemUsed();
+		for (int KeyId = TenantH.FFirstKeyId(); TenantH.FNextKeyId(KeyId); ) {
+			const TTenant& Tenant = TenantH[KeyId];
+			MemUsed += TenantH.GetKey(KeyId).GetMemUsed();
+			if (!Tenant.Tree.Empty()) { MemUsed += Tenant.Tree->GetMemUsed(); }
+			if (!Tenant.Snapshot.Empty()) { MemUsed += sizeof(TMem)+Tenant.Snapshot->Len(); }
+		}
+		return MemUsed;
+	}
+	TStr TModelStore::GetStatsStr() const {
+		return TStr::Fmt("tenants = %d; live = %d; evictions = %s; loads = %s; memory = %s KB", TenantH.Len(), LiveN,
+			TUInt64::GetStr(EvictionsN).CStr(), TUInt64::GetStr(LoadsN).CStr(), TUInt64::GetStr(GetMemUsed()/1024).CStr());
+	}
+} // namespace TDatastream
@@ -0,0 +1,83 @@
+#ifndef MODELSTORE_H
+#define MODELSTORE_H
+
+#include "hoeffding.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Model-Store
+	// One small tree per tenant key, all learned against one shared schema and one ID generator. Tenant trees do not
+	// profile, so a fresh tenant costs little more than the tree object and its root. At most MxLiveN trees stay live;
+	// touching another tenant evicts the least recently used one to a snapshot (in memory, or a file in SnapshotDir if
+	// given), and the tenant's next example loads it back. Snapshot files are named by a hash of the tenant key and start
+	// with the key, so a store restarted over the same directory finds its tenants again. Not thread-safe; run one store per thread
+	ClassTP(TModelStore, PModelStore) // {
+	public:
+		TModelStore(const PSchema& Schema_, const int& GracePeriod_, const double& SplitConfidence_, const double& TieBreaking_,
+			const int& MxLiveN_, const TStr& SnapshotDir_);
+		static PModelStore New(const PSchema& Schema, const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking,
+			const int& MxLiveN = 1024, const TStr& SnapshotDir = TStr()) {
+			return new TModelStore(Schema, GracePeriod, SplitConfidence, TieBreaking, MxLiveN, SnapshotDir);
+		}
+		static PModelStore New(const TStr& ConfigFNm, const int& GracePeriod, const double& SplitConfidence, const double& TieBreaking,
+			const int& MxLiveN = 1024, const TStr& SnapshotDir = TStr()) {
+			return New(TSchema::New(ConfigFNm), GracePeriod, SplitConfidence, TieBreaking, MxLiveN, SnapshotDir);
+		}
+		// settings of tenant trees created from now on
+		void SetAdaptive(const TDriftMode& DriftMode_) { DriftMode = DriftMode_; }
+		void SetDrift(const int& DriftCheck_, const int& WindowSize_) { DriftCheck = DriftCheck_; WindowSize = WindowSize_; }
+		void SetBinsN(const int& BinsN_) { BinsN = BinsN_; }
+		void SetAttrHeuristic(const TAttrHeuristic& AttrHeuristic_) { AttrHeuristic = AttrHeuristic_; }
+		void SetSparse(const bool& SparseP_) { SparseP = SparseP_; }
+		void Process(const TStr& Key, PExample Example) { GetTree(Key)->Process(Example); }
+		void Process(const TStr& Line, const TCh& Delimiter = ','); // tenant key, then the example as THoeffdingTree reads it
+		TLabel Classify(const TStr& Key, PExample Example) { return GetTree(Key)->Classify(Example); }
+		double Predict(const TStr& Key, PExample Example) { return GetTree(Key)->Predict(Example); }
+		PHoeffdingTree GetTree(const TStr& Key); // creates new tenants and loads evicted ones
+		inline bool IsTenant(const TStr& Key) const { return TenantH.IsKey(Key); }
+		inline bool IsLive(const TStr& Key) const { return TenantH.IsKey(Key) && !TenantH.GetDat(Key).Tree.Empty(); }
+		inline int GetTenantsN() const { return TenantH.Len(); }
+		inline int GetLiveN() const { return LiveN; }
+		void Evict(const TStr& Key);
+		void EvictIdle(const uint64& MxIdleN); // tenants without an example among the last MxIdleN
+		void EvictAll();
+		uint64 GetMemUsed() const; // live trees and in-memory snapshots, in bytes
+		TStr GetStatsStr() const;
+	private:
+		class TTenant {
+		public:
+			TTenant() : LastTick(0) { }
+		public:
+			PHoeffdingTree Tree; // empty while evicted
+			PMem Snapshot; // evicted tree, unless snapshots go to files
+			TStr SnapshotFNm; // snapshot file, once looked up
+			uint64 LastTick; // store tick of the last access
+		};
+		PHoeffdingTree NewTree() const;
+		void Evict(const int& KeyId);
+		void EvictLru(const int& KeepKeyId); // least recently used live tenant other than KeepKeyId
+		TStr GetSnapshotFNm(const int& KeyId); // the file holding the tenant's key, or the first free one
+		TStr GetSnapshotFNm(const TStr& Key, const int& ProbeN) const;
+	private:
+		const PSchema Schema;
+		PIdGen IdGen; // shared by all tenant trees
+		const int GracePeriod;
+		const double SplitConfidence;
+		const double TieBreaking;
+		const int MxLiveN;
+		const TStr SnapshotDir;
+		int DriftCheck;
+		int WindowSize;
+		TDriftMode DriftMode;
+		int BinsN;
+		TAttrHeuristic AttrHeuristic;
+		bool SparseP;
+		THash<TStr, TTenant> TenantH;
+		int LiveN;
+		uint64 Tick;
+		uint64 EvictionsN;
+		uint64 LoadsN;
+	};
+} // namespace TDatastream
+
+#endif
@@ -8,73 +8,59 @@ namespace TDatastream {
 			BackP = false;
 			return LastTok;
 		}
-		CurrCh = SIn->GetCh();
-		// skip whitespace 
+		static const TStr LParenthesisStr = "(", RParenthesisStr = ")", ColonStr = ":", SemicStr = ";", CommaStr = ",", EquStr = "=";
 		EatWs();
-		// ignore comments 
-		while (CurrCh == '#') { SkipLn(); EatWs(); }
-
-		switch (CurrCh) {
-		case '(':
-			LastTok = TToken("(", TTokType::LPARENTHESIS, LineN);
-			return LastTok;
-		case ')':
-			LastTok = TToken(")", TTokType::RPARENTHESIS, LineN);
-			return LastTok;
-		case ':':
-			LastTok = TToken(":", TTokType::COLON, LineN);
-			return LastTok;
-		case ';':
-			LastTok = TToken(";", TTokType::SEMIC, LineN);
-			return LastTok;
-		case ',':
-			LastTok = TToken(",", TTokType::COMMA, LineN);
-			return LastTok;
-		case '=':
-			LastTok = TToken("=", TTokType::EQU, LineN);
+		if (Pos == BfL) {
+			LastTok = TToken(TStr(), TTokType::END, LineN); // end-of-file
 			return LastTok;
 		}
+		switch (Bf[Pos]) {
+		case '(': ++Pos; LastTok = TToken(LParenthesisStr, TTokType::LPARENTHESIS, LineN); return LastTok;
+		case ')': ++Pos; LastTok = TToken(RParenthesisStr, TTokType::RPARENTHESIS, LineN); return LastTok;
+		case ':': ++Pos; LastTok = TToken(ColonStr, TTokType::COLON, LineN); return LastTok;
+		case ';': ++Pos; LastTok = TToken(SemicStr, TTokType::SEMIC, LineN); return LastTok;
+		case ',': ++Pos; LastTok = TToken(CommaStr, TTokType::COMMA, LineN); return LastTok;
+		case '=': ++Pos; LastTok = TToken(EquStr, TTokType::EQU, LineN); return LastTok;
+		}
 		// identifier?
-		if (IsValid(CurrCh)) {
-			TChA ChA;
-			ChA.AddCh(CurrCh);
-			while (!SIn->Eof() && IsValid(SIn->PeekCh())) {
-				CurrCh = SIn->GetCh();
-				ChA.AddCh(CurrCh);
-			}
-			if (ChA == "dataFormat") {
-				LastTok = TToken(ChA, TTokType::DFORMAT, LineN);
-			} else if (ChA == "discrete") {
-				LastTok = TToken(ChA, TTokType::DISCRETE, LineN);
-			} else if (ChA == "numeric") {
-				LastTok = TToken(ChA, TTokType::NUMERIC, LineN);
-			} else {
-				LastTok = TToken(ChA, TTokType::ID, LineN);
-			}
-		} else {
-			if (!SIn->Eof()) {
-				printf("[Line %d] Illegal character: '%c'.\n", LineN, CurrCh);
-				Fail;
-			}
-			LastTok = TToken("", TTokType::END, LineN); // end-of-file
+		if (!IsValid(Bf[Pos])) {
+			printf("[Line %d] Illegal character: '%c'.\n", LineN, Bf[Pos]);
+			Fail;
 		}
+		const int StartPos = Pos;
+		while (Pos < BfL && IsValid(Bf[Pos])) { ++Pos; }
+		const int TokLen = Pos-StartPos;
+		// keywords are compared in place; only the token itself is copied 
+		TTokType Type = TTokType::ID;
+		if (TokLen == 10 && strncmp(Bf+StartPos, "dataFormat", 10) == 0) {
+			Type = TTokType::DFORMAT;
+		} else if (TokLen == 8 && strncmp(Bf+StartPos, "discrete", 8) == 0) {
+			Type = TTokType::DISCRETE;
+		} else if (TokLen == 7 && strncmp(Bf+StartPos, "numeric", 7) == 0) {
+			Type = TTokType::NUMERIC;
+		}
+		LastTok = TToken(Text.GetSubStr(StartPos, Pos-1), Type, LineN);
 		return LastTok;
 	}
 
 	void TLexer::EatWs() {
-		while (!SIn->Eof() && TCh::IsWs(CurrCh)) {
-			if (CurrCh == '\n') ++LineN;
-			CurrCh = SIn->GetCh();
+		while (Pos < BfL) {
+			const char Ch = Bf[Pos];
+			if (Ch == '#') { // comment, up to the end of the line 
+				while (Pos < BfL && Bf[Pos] != '\n') { ++Pos; }
+			} else if (TCh::IsWs(Ch)) {
+				if (Ch == '\n') { ++LineN; }
+				++Pos;
+			} else {
+				break;
+			}
 		}
 	}
 
-	void TLexer::SkipLn() {
-		while (!SIn->Eof() && CurrCh != '\n') { CurrCh = SIn->GetCh(); }
-	}
 	///////////////////////////////
 	// parameters
-	void TParser::CfgParse(const TStr& FileNm) {
-		TLexer Lexer(FileNm);
+	void TParser::CfgParse(const TStr& Text) {
+		TLexer Lexer(Text);
 		TToken Tok;
 		//while ((Tok = Lexer.GetNextTok()).Type != TTokType::END) {
 		//	printf("\tToken: %s\n", Tok.Val.CStr());
@@ -93,10 +79,10 @@ namespace TDatastream {
 			printf("[Line %d] Expected 'dataFormat' keyword instead of '%s'.\n", Tok.LineN, Tok.Val.CStr());
 			Fail;
 		}
-		// =
+		// : or =
 		Tok = Lexer.GetNextTok();
-		if (Tok.Type != TTokType::COLON) {
-			printf("[Line %d] Expected ':' instead of '%s'.\n", Tok.LineN, Tok.Val.CStr());
+		if (Tok.Type != TTokType::COLON && Tok.Type != TTokType::EQU) {
+			printf("[Line %d] Expected ':' or '=' instead of '%s'.\n", Tok.LineN, Tok.Val.CStr());
 			Fail;
 		}
 		// (
@@ -125,7 +111,6 @@ namespace TDatastream {
 				printf("[Line %d] Expected identifier instead of '%s'.\n", Tok.LineN, Tok.Val.CStr());
 				Fail;
 			}
-			printf("Declaring '%s'...\n", Tok.Val.CStr());
 			DataFormatH.AddDat(Tok.Val, IdxN);
 			InvDataFormatH.AddDat(IdxN, Tok.Val);
 			// ,
@@ -170,7 +155,6 @@ namespace TDatastream {
 			// discrete/numeric
 			Tok = Lexer.GetNextTok();
 			if (Tok.Type == TTokType::DISCRETE) {
-				printf("Nominal attirubte %s\n", AttrNm.CStr());
 				// (
 				Tok = Lexer.GetNextTok();
 				if (Tok.Type != TTokType::LPARENTHESIS) {
@@ -185,7 +169,6 @@ namespace TDatastream {
 					Fail;
 				}
 			} else if (Tok.Type == TTokType::NUMERIC) {
-				printf("Numeric atribute\n");
 				const int CountN = DataFormatH.GetDat(AttrNm);
 				AttrsHV.GetVal(CountN).AddDat("", 0);
 				InvAttrsHV.GetVal(CountN).AddDat(0, "");
@@ -14,26 +14,27 @@ namespace TDatastream {
 		int LineN;
 	};
 
-	// simple lexical analyzer
+	// simple lexical analyzer; scans the whole configuration text in memory 
 	class TLexer {
 	public:
-		TLexer(const TStr& FileNm)
-			: LineN(1), BackP(false) { SIn = TFIn::New(FileNm); }
+		TLexer(const TStr& Text_)
+			: Text(Text_), Bf(Text.CStr()), BfL(Text.Len()), Pos(0), LineN(1), BackP(false) { }
 		TToken GetNextTok();
 		inline void PutBack() { // need this for lookahead 
 			BackP = true;
 		}
 		static bool IsValid(const char& Ch) {
-			return TCh::IsAlNum(Ch) || (Ch == '_' || Ch == '-' || Ch == '&' || Ch == '<' || Ch == '>' || Ch == '=' || Ch == '.');
+			return TCh::IsAlNum(Ch) || (Ch == '_' || Ch == '-' || Ch == '&' || Ch == '<' || Ch == '>' || Ch == '=' || Ch == '.' || Ch == '?');
 		}
 	private:
-		void EatWs(); // eats whitespace 
-		void SkipLn(); // skip line 
-		int CurrCh; // current character 
+		void EatWs(); // eats whitespace and comments 
+		const TStr Text;
+		const char* Bf;
+		const int BfL;
+		int Pos; // next character 
 		int LineN; // current line 
 		TToken LastTok;
 		bool BackP;
-		PSIn SIn;
 	};
 
 	// parameters class 
@@ -54,7 +55,7 @@ namespace TDatastream {
 		// THash<TStr, TInt> NumAttrsH;
 		// THash<TInt, TStr> InvNumAttrsH;
 	private:
-		void CfgParse(const TStr& FileNm);
+		void CfgParse(const TStr& Text);
 		void InitLine(TLexer& Lexer); // dataFormat = (a1, a2, ..., an)
 		void InitParam(TLexer& Lexer); // parameter list, i.e., `a1, a2, ..., an'
 		void AttrLine(TLexer& Lexer); // ai: discrete(vi1, vi2, ..., vini) or aj: numeric
@@ -62,8 +63,14 @@ namespace TDatastream {
 		void Error(const TStr& Msg); // TODO: make it StrFmt 
 	public:
 		TParser(const TStr& FNm) {
-			CfgParse(FNm);
+			CfgParse(TStr::LoadTxt(FNm));
 		}
+		// Text is the already loaded configuration file 
+		static TParser FromText(const TStr& Text) {
+			TParser Parser; Parser.CfgParse(Text); return Parser;
+		}
+	private:
+		TParser() { }
 	};
 } // namespace TDatastream
 
@@ -0,0 +1,153 @@
+#include "pipeline.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Ingestion-Pipeline
+	TPipeline::TPipeline(const PHoeffdingTree& Parser_, const TStr& FNm, const int& ParsersN, const int& ChunkKB, const int& MxChunksN_,
+		const TCh& Delimiter_)
+		: Parser(Parser_), ParserPt(Parser_()), Delimiter(Delimiter_), ChunkBytes(ChunkKB*1024), MxChunksN(MxChunksN_), In(TDataIn::New(FNm, ChunkKB)),
+		ReadN(0), NextSeqN(0), InFlightN(0), EofP(false), StopP(false), BatchPos(0), ExamplesN(0), ReaderWaitsN(0), LearnerWaitsN(0) {
+		EAssertR(ChunkKB > 0 && MxChunksN > 0, "Chunk size and the number of chunks in flight must be positive.");
+		const int ThreadsN = ParsersN > 0 ? ParsersN : TMath::Mx<int>(1, (int) std::thread::hardware_concurrency()-2);
+		Reader = std::thread(&TPipeline::Read, this);
+		for (int ThreadN = 0; ThreadN < ThreadsN; ++ThreadN) { ParserV.push_back(std::thread(&TPipeline::Parse, this)); }
+	}
+	TPipeline::~TPipeline() {
+		Stop();
+	}
+	void TPipeline::Stop() {
+		{
+			std::lock_guard<std::mutex> Lock(QueueMutex);
+			StopP = true;
+		}
+		ReadCond.notify_all(); ParseCond.notify_all(); LearnCond.notify_all();
+		if (Reader.joinable()) { Reader.join(); }
+		for (auto It = ParserV.begin(); It != ParserV.end(); ++It) { if (It->joinable()) { It->join(); } }
+		ParserV.clear();
+	}
+	void TPipeline::Read() {
+		std::string Rest; // the unfinished last line of the previous chunk
+		std::vector<char> BfV(ChunkBytes);
+		while (true) {
+			{
+				std::unique_lock<std::mutex> Lock(QueueMutex);
+				if (InFlightN >= MxChunksN && !StopP) {
+					++ReaderWaitsN;
+					ReadCond.wait(Lock, [this] { return InFlightN < MxChunksN || StopP; });
+				}
+				if (StopP) { return; }
+			}
+			size_t BfL = 0;
+			try {
+				BfL = In->Read(BfV.data(), (int) BfV.size());
+			} catch (PExcept ReadExcept) {
+				const std::string ReadErrStr(ReadExcept->GetMsgStr().CStr());
+				std::lock_guard<std::mutex> Lock(QueueMutex);
+				if (ErrStr.empty()) { ErrStr = ReadErrStr; }
+				LearnCond.notify_all();
+				return;
+			}
+			TChunk Chunk;
+			Chunk.Buf.swap(Rest);
+			if (BfL == 0) { // end of file; the last line need not end with a newline
+				std::lock_guard<std::mutex> Lock(QueueMutex);
+				if (!Chunk.Buf.empty()) { Chunk.SeqN = ReadN++; ++InFlightN; ChunkQ.push_back(Chunk); }
+				EofP = true;
+				ParseCond.notify_all(); LearnCond.notify_all();
+				return;
+			}
+			// Cut after the last newline; the rest goes to the next chunk
+			size_t CutN = BfL;
+			while (CutN > 0 && BfV[CutN-1] != '\n') { --CutN; }
+			if (CutN == 0) { // no line end yet; keep the whole read and keep reading
+				Rest = Chunk.Buf+std::string(BfV.data(), BfL);
+				continue;
+			}
+			Chunk.Buf.append(BfV.data(), CutN);
+			Rest.assign(BfV.data()+CutN, BfL-CutN);
+			std::lock_guard<std::mutex> Lock(QueueMutex);
+			Chunk.SeqN = ReadN++; ++InFlightN;
+			ChunkQ.push_back(TChunk());
+			ChunkQ.back().SeqN = Chunk.SeqN; ChunkQ.back().Buf.swap(Chunk.Buf);
+			ParseCond.notify_one();
+		}
+	}
+	void TPipeline::Parse() {
+		while (true) {
+			TChunk Chunk;
+			{
+				std::unique_lock<std::mutex> Lock(QueueMutex);
+				ParseCond.wait(Lock, [this] { return !ChunkQ.empty() || EofP || StopP; });
+				if (StopP || ChunkQ.empty()) { return; }
+				Chunk.SeqN = ChunkQ.front().SeqN; Chunk.Buf.swap(ChunkQ.front().Buf);
+				ChunkQ.pop_front();
+			}
+			TVec<PExample> ExampleV;
+			try {
+				const char* LineStart = Chunk.Buf.c_str();
+				const char* BufEnd = LineStart+Chunk.Buf.size();
+				while (LineStart < BufEnd) {
+					const char* LineEnd = LineStart;
+					while (LineEnd < BufEnd && *LineEnd != '\n') { ++LineEnd; }
+					int LineLen = (int) (LineEnd-LineStart);
+					if (LineLen > 0 && LineStart[LineLen-1] == '\r') { --LineLen; }
+					if (LineLen > 0) { ExampleV.Add(ParserPt->Parse(LineStart, LineLen, Delimiter)); } // the chunk ends with a null 
+					LineStart = LineEnd+1;
+				}
+			} catch (PExcept ParseExcept) {
+				const std::string ParseErrStr(ParseExcept->GetMsgStr().CStr());
+				std::lock_guard<std::mutex> Lock(QueueMutex);
+				if (ErrStr.empty()) { ErrStr = ParseErrStr; }
+				LearnCond.notify_all();
+				return;
+			}
+			std::lock_guard<std::mutex> Lock(QueueMutex);
+			BatchM[Chunk.SeqN].Swap(ExampleV);
+			if (Chunk.SeqN == NextSeqN) { LearnCond.notify_one(); }
+		}
+	}
+	bool TPipeline::NextChunk() {
+		while (BatchPos == BatchV.Len()) {
+			BatchV.Clr(); BatchPos = 0;
+			std::unique_lock<std::mutex> Lock(QueueMutex);
+			auto IsReady = [this] { return BatchM.count(NextSeqN) > 0 || (EofP && NextSeqN == ReadN) || !ErrStr.empty(); };
+			if (!IsReady()) { ++LearnerWaitsN; LearnCond.wait(Lock, IsReady); }
+			if (!ErrStr.empty()) {
+				const TStr MsgStr = ErrStr.c_str();
+				Lock.unlock(); Stop();
+				throw TDtExcept::New(MsgStr);
+			}
+			if (BatchM.count(NextSeqN) == 0) { return false; } // end of file
+			auto It = BatchM.find(NextSeqN);
+			BatchV.Swap(It->second);
+			BatchM.erase(It);
+			++NextSeqN; --InFlightN;
+			ReadCond.notify_one();
+		}
+		return true;
+	}
+	bool TPipeline::Next(PExample& Example) {
+		if (!NextChunk()) { return false; }
+		Example = BatchV[BatchPos];
+		BatchV[BatchPos++].Clr(); // the learner becomes the only owner
+		++ExamplesN;
+		return true;
+	}
+	bool TPipeline::NextBatch(TVec<PExample>& ExampleV) {
+		if (!NextChunk()) { return false; }
+		if (BatchPos == 0) {
+			ExampleV.Clr(false); ExampleV.Swap(BatchV);
+		} else {
+			ExampleV.Clr(false);
+			for (; BatchPos < BatchV.Len(); ++BatchPos) { ExampleV.Add(BatchV[BatchPos]); BatchV[BatchPos].Clr(); }
+			BatchV.Clr();
+		}
+		BatchPos = 0;
+		ExamplesN += ExampleV.Len();
+		return true;
+	}
+	TStr TPipeline::GetStatsStr() const {
+		return TStr::Fmt("examples = %s; chunks = %s; reader waits = %s; learner waits = %s; parsers = %d", TUInt64::GetStr(ExamplesN).CStr(),
+			TUInt64::GetStr(ReadN).CStr(), TUInt64::GetStr(ReaderWaitsN).CStr(), TUInt64::GetStr(LearnerWaitsN).CStr(), (int) ParserV.size());
+	}
+} // namespace TDatastream
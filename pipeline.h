@@ -0,0 +1,81 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "hoeffding.h"
+#include "datain.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDatastream {
+	///////////////////////////////
+	// Ingestion-Pipeline
+	// Reads a data file (plain, gzip, or zstd; see TDataIn) on a reader thread in chunks of about ChunkKB kilobytes cut at line ends, parses the chunks on
+	// ParsersN threads with THoeffdingTree::Parse, and hands the examples to the learner thread, which pulls them with
+	// Next in file order. At most MxChunksN chunks are read but not yet learned, so a slow learner stalls the reader
+	// instead of filling the memory. A read or parse error stops the pipeline and is thrown from Next.
+	//   PPipeline Pipeline = TPipeline::New(Tree, "data.dat");
+	//   PExample Example;
+	//   while (Pipeline->Next(Example)) { Tree->Process(Example); }
+	// or, a chunk at a time,
+	//   TVec<PExample> ExampleV;
+	//   while (Pipeline->NextBatch(ExampleV)) { Tree->ProcessBatch(ExampleV); }
+	ClassTP(TPipeline, PPipeline) // {
+	public:
+		// Parser only parses; it must stay alive and keep its schema and input format while the pipeline runs
+		static PPipeline New(const PHoeffdingTree& Parser, const TStr& FNm, const int& ParsersN = 0, const int& ChunkKB = 1024,
+			const int& MxChunksN = 16, const TCh& Delimiter = ',') {
+			return new TPipeline(Parser, FNm, ParsersN, ChunkKB, MxChunksN, Delimiter);
+		}
+		~TPipeline();
+		bool Next(PExample& Example); // learner thread only; false at the end of the file
+		bool NextBatch(TVec<PExample>& ExampleV); // the rest of the current chunk; for THoeffdingTree::ProcessBatch
+		inline uint64 GetExamplesN() const { return ExamplesN; }
+		TStr GetStatsStr() const;
+	private:
+		TPipeline(const PHoeffdingTree& Parser_, const TStr& FNm, const int& ParsersN, const int& ChunkKB, const int& MxChunksN_,
+			const TCh& Delimiter_);
+		TPipeline(const TPipeline&);
+		TPipeline& operator=(const TPipeline&);
+		void Read(); // reader thread
+		void Parse(); // parser threads
+		void Stop(); // wake up and join all threads
+		bool NextChunk(); // waits until the current batch has examples left; false at the end of the file
+		struct TChunk {
+			uint64 SeqN;
+			std::string Buf; // whole lines
+		};
+	private:
+		const PHoeffdingTree Parser; // keeps the parser alive; the threads use ParserPt, since reference counts are not thread-safe
+		const THoeffdingTree* ParserPt;
+		const TCh Delimiter;
+		const int ChunkBytes;
+		const int MxChunksN;
+		PDataIn In; // decompresses on its own thread
+		std::mutex QueueMutex;
+		std::condition_variable ReadCond; // room for another chunk
+		std::condition_variable ParseCond; // a chunk to parse
+		std::condition_variable LearnCond; // the next batch is parsed
+		std::deque<TChunk> ChunkQ; // read, not yet parsed
+		std::map<uint64, TVec<PExample> > BatchM; // parsed, by chunk sequence number; they reach the learner in this order
+		uint64 ReadN; // chunks read
+		uint64 NextSeqN; // next chunk for the learner
+		int InFlightN; // read, not yet learned
+		bool EofP;
+		bool StopP;
+		std::string ErrStr; // first read or parse error; a deep copy, since TStr reference counts are not thread-safe
+		TVec<PExample> BatchV; // learner's current batch
+		int BatchPos;
+		uint64 ExamplesN;
+		uint64 ReaderWaitsN; // the reader waited for the learner: learning is the bottleneck
+		uint64 LearnerWaitsN; // the learner waited for the parsers: reading or parsing is the bottleneck
+		std::thread Reader;
+		std::vector<std::thread> ParserV;
+	};
+} // namespace TDatastream
+
+#endif
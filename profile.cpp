@@ -0,0 +1,72 @@
+#include "profile.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Latency-Histogram
+	// Bucket of a value with the most significant bit MsbN >= SubBitsN is (MsbN-SubBitsN)*SubBucketsN + (NSecs >> (MsbN-SubBitsN)),
+	// which continues the exact buckets 0..2*SubBucketsN-1 without gaps
+	int TLatencyHist::GetBucketN(const uint64& NSecs) {
+		if (NSecs < (uint64) SubBucketsN) { return (int) NSecs; }
+		int MsbN = 0; uint64 Val = NSecs;
+		if (Val >= (1ull << 32)) { Val >>= 32; MsbN += 32; }
+		if (Val >= (1ull << 16)) { Val >>= 16; MsbN += 16; }
+		if (Val >= (1ull << 8)) { Val >>= 8; MsbN += 8; }
+		if (Val >= (1ull << 4)) { Val >>= 4; MsbN += 4; }
+		if (Val >= (1ull << 2)) { Val >>= 2; MsbN += 2; }
+		if (Val >= (1ull << 1)) { MsbN += 1; }
+		const int ShiftN = MsbN-SubBitsN;
+		return (ShiftN << SubBitsN)+(int) (NSecs >> ShiftN);
+	}
+	uint64 TLatencyHist::GetBucketMx(const int& BucketN) {
+		if (BucketN < 2*SubBucketsN) { return (uint64) BucketN; }
+		const int ShiftN = (BucketN >> SubBitsN)-1;
+		const uint64 SubN = (uint64) (BucketN-(ShiftN << SubBitsN));
+		return ((SubN+1) << ShiftN)-1;
+	}
+	uint64 TLatencyHist::GetPercentile(const double& Percentile) const {
+		if (CountN == 0) { return 0; }
+		const uint64 RankN = TMath::Mx<uint64>(1, (uint64) ceil(Percentile/100.0*CountN));
+		uint64 SeenN = 0;
+		for (int BucketN = 0; BucketN < BucketsN; ++BucketN) {
+			if ((SeenN += CountV[BucketN]) >= RankN) { return TMath::Mn<uint64>(GetBucketMx(BucketN), MxNSecs); }
+		}
+		return MxNSecs;
+	}
+	void TLatencyHist::Clr() {
+		memset(CountV, 0, sizeof(CountV));
+		CountN = SumNSecs = MxNSecs = 0;
+	}
+
+	///////////////////////////////
+	// Phase-Profiler
+	TStr TPhaseProfiler::GetStr() const {
+		TChA ChA;
+		ChA += TStr::Fmt("%-12s %12s %12s %10s %10s %10s %10s %10s\n", "phase", "calls", "total-ms", "mean-ns", "p50-ns", "p99-ns", "p999-ns", "max-ns");
+		for (int PhaseN = 0; PhaseN < PhasesN; ++PhaseN) {
+			const TLatencyHist& Hist = HistV[PhaseN];
+			if (Hist.GetCount() == 0) { continue; }
+			ChA += TStr::Fmt("%-12s %12s %12.1f %10.0f %10s %10s %10s %10s\n", GetPhaseNm((TPhase) PhaseN), TUInt64::GetStr(Hist.GetCount()).CStr(),
+				1e-6*Hist.GetSum(), Hist.GetMean(), TUInt64::GetStr(Hist.GetPercentile(50.0)).CStr(), TUInt64::GetStr(Hist.GetPercentile(99.0)).CStr(),
+				TUInt64::GetStr(Hist.GetPercentile(99.9)).CStr(), TUInt64::GetStr(Hist.GetMx()).CStr());
+		}
+		return ChA;
+	}
+	void TPhaseProfiler::Clr() {
+		for (int PhaseN = 0; PhaseN < PhasesN; ++PhaseN) { HistV[PhaseN].Clr(); }
+	}
+	const char* TPhaseProfiler::GetPhaseNm(const TPhase& Phase) {
+		switch (Phase) {
+		case TPhase::PARSE: return "parse";
+		case TPhase::ROUTE: return "route";
+		case TPhase::LEAF_UPDATE: return "leaf-update";
+		case TPhase::SPLIT_EVAL: return "split-eval";
+		case TPhase::SPLIT: return "split";
+		case TPhase::FORGET: return "forget";
+		case TPhase::SELF_EVAL: return "self-eval";
+		case TPhase::DRIFT_CHECK: return "drift-check";
+		case TPhase::PROCESS: return "process";
+		case TPhase::CLASSIFY: return "classify";
+		default: return "unknown";
+		}
+	}
+} // namespace TDatastream
@@ -0,0 +1,92 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <base.h>
+#include <chrono>
+
+namespace TDatastream {
+	// learner phases; PROCESS and CLASSIFY cover whole calls and include the other phases
+	enum class TPhase : char { PARSE, ROUTE, LEAF_UPDATE, SPLIT_EVAL, SPLIT, FORGET, SELF_EVAL, DRIFT_CHECK, PROCESS, CLASSIFY };
+	const int PhasesN = 10;
+
+	///////////////////////////////
+	// Latency-Histogram
+	// Log-linear buckets in the style of HdrHistogram: values below 2^SubBitsN nanoseconds are exact, larger
+	// values fall into one of 2^SubBitsN linear sub-buckets of their power of two, i.e., within 1/32 of the true value
+	class TLatencyHist {
+	public:
+		TLatencyHist() { Clr(); }
+		inline void Add(const uint64& NSecs) {
+			++CountV[GetBucketN(NSecs)]; ++CountN; SumNSecs += NSecs;
+			if (NSecs > MxNSecs) { MxNSecs = NSecs; }
+		}
+		uint64 GetPercentile(const double& Percentile) const; // nanoseconds; Percentile lies in [0,100]
+		inline uint64 GetCount() const { return CountN; }
+		inline uint64 GetSum() const { return SumNSecs; }
+		inline uint64 GetMx() const { return MxNSecs; }
+		inline double GetMean() const { return CountN > 0 ? 1.0*SumNSecs/CountN : 0.0; }
+		void Clr();
+	private:
+		static int GetBucketN(const uint64& NSecs);
+		static uint64 GetBucketMx(const int& BucketN); // largest value that falls into the bucket
+	private:
+		static const int SubBitsN = 5;
+		static const int SubBucketsN = 1 << SubBitsN;
+		static const int BucketsN = (64-SubBitsN+1)*SubBucketsN;
+		uint64 CountV[BucketsN];
+		uint64 CountN;
+		uint64 SumNSecs;
+		uint64 MxNSecs;
+	};
+
+	///////////////////////////////
+	// Phase-Profiler
+	// Call counts, total time, and latency distribution of each learner phase
+	class TPhaseProfiler {
+	public:
+		inline void Add(const TPhase& Phase, const uint64& NSecs) { HistV[(int) Phase].Add(NSecs); }
+		inline uint64 GetCallsN(const TPhase& Phase) const { return HistV[(int) Phase].GetCount(); }
+		inline double GetSec(const TPhase& Phase) const { return 1e-9*HistV[(int) Phase].GetSum(); }
+		inline uint64 GetPercentile(const TPhase& Phase, const double& Percentile) const {
+			return HistV[(int) Phase].GetPercentile(Percentile);
+		}
+		inline const TLatencyHist& GetHist(const TPhase& Phase) const { return HistV[(int) Phase]; }
+		TStr GetStr() const; // one line per phase that was called at least once
+		void Clr();
+		static const char* GetPhaseNm(const TPhase& Phase);
+	private:
+		TLatencyHist HistV[PhasesN];
+	};
+
+	///////////////////////////////
+	// Phase-Timer
+	// Adds the lifetime of the object to its phase; use through HT_PROFILE. A null profiler reads no clock 
+	class TPhaseTimer {
+	public:
+		TPhaseTimer(TPhaseProfiler* Profiler_, const TPhase& Phase_)
+			: Profiler(Profiler_), Phase(Phase_),
+			StartTm(Profiler_ != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) { }
+		~TPhaseTimer() {
+			if (Profiler == nullptr) { return; }
+			Profiler->Add(Phase, (uint64) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-StartTm).count());
+		}
+	private:
+		TPhaseTimer(const TPhaseTimer&);
+		TPhaseTimer& operator=(const TPhaseTimer&);
+	private:
+		TPhaseProfiler* Profiler;
+		const TPhase Phase;
+		const std::chrono::steady_clock::time_point StartTm;
+	};
+} // namespace TDatastream
+
+// Time the rest of the enclosing scope; compile with HT_NPROFILE to remove all timers
+#ifdef HT_NPROFILE
+	#define HT_PROFILE(Profiler, Phase)
+#else
+	#define HT_PROFILE_CONCAT_(A, B) A##B
+	#define HT_PROFILE_CONCAT(A, B) HT_PROFILE_CONCAT_(A, B)
+	#define HT_PROFILE(Profiler, Phase) TDatastream::TPhaseTimer HT_PROFILE_CONCAT(PhaseTimer, __LINE__)(Profiler, Phase)
+#endif
+
+#endif
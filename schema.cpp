@@ -0,0 +1,199 @@
+#include "schema.h"
+#include <functional>
+#include <thread>
+#if defined(GLIB_WIN)
+	#include <process.h>
+	#define getpid _getpid
+#else
+	#include <unistd.h>
+#endif
+
+namespace TDatastream {
+	///////////////////////////////
+	// Attribute-Managment
+	TAttrMan::TAttrMan(const THash<TStr, TInt>& AttrH_, const THash<TInt, TStr>& InvAttrH_,
+		const int& Id_, const TStr& Nm_, const TAttrType& Type_)
+		: AttrH(AttrH_), InvAttrH(InvAttrH_), Id(Id_), Nm(Nm_), Type(Type_) {
+			AttrH.GetDatV(ValueV); // Possible values; there is a single value for numeric attributes
+	}
+	TAttrMan::TAttrMan(TSIn& SIn) : AttrH(SIn), InvAttrH(SIn), ValueV(SIn), Nm(SIn), Id(SIn) {
+		char TypeCh; SIn.Load(TypeCh); Type = (TAttrType) TypeCh;
+	}
+	void TAttrMan::Save(TSOut& SOut) const {
+		AttrH.Save(SOut); InvAttrH.Save(SOut); ValueV.Save(SOut); Nm.Save(SOut); Id.Save(SOut);
+		SOut.Save((char) Type);
+	}
+
+	///////////////////////////////
+	// Value-Dictionary
+	TValDict::TValDict(TSIn& SIn) : OffV(SIn), LenV(SIn), CodeV(SIn), DispV(SIn) {
+		int KeyBfL; SIn.Load(KeyBfL);
+		KeyBfV.Gen(KeyBfL);
+		if (KeyBfL > 0) { SIn.LoadBf(KeyBfV.BegI(), KeyBfL); }
+		SIn.Load(SlotsN); SIn.Load(BucketsN); SIn.Load(Seed);
+	}
+	void TValDict::Save(TSOut& SOut) const {
+		OffV.Save(SOut); LenV.Save(SOut); CodeV.Save(SOut); DispV.Save(SOut);
+		SOut.Save(KeyBfV.Len());
+		if (!KeyBfV.Empty()) { SOut.SaveBf(KeyBfV.BegI(), KeyBfV.Len()); }
+		SOut.Save(SlotsN); SOut.Save(BucketsN); SOut.Save(Seed);
+	}
+	void TValDict::Gen(const THash<TStr, TInt>& ValH) {
+		KeyBfV.Clr(); OffV.Clr(); LenV.Clr(); CodeV.Clr(); DispV.Clr();
+		SlotsN = ValH.Len(); BucketsN = 0; Seed = 0;
+		TStrV KeyV; TIntV KeyCodeV;
+		for (int KeyId = ValH.FFirstKeyId(); ValH.FNextKeyId(KeyId); ) { KeyV.Add(ValH.GetKey(KeyId)); KeyCodeV.Add(ValH[KeyId]); }
+		if (SlotsN <= LinearMxN) {
+			for (int KeyN = 0; KeyN < SlotsN; ++KeyN) {
+				OffV.Add(KeyBfV.Len()); LenV.Add(KeyV[KeyN].Len()); CodeV.Add(KeyCodeV[KeyN]);
+				for (int ChN = 0; ChN < KeyV[KeyN].Len(); ++ChN) { KeyBfV.Add(KeyV[KeyN][ChN]); }
+			}
+			return;
+		}
+		// Another seed if two keys hash alike or a bucket finds no free slots; every SeedsPerLoadN seeds, buckets get half
+		// as many keys, which makes them easier to place
+		TVec<uint64> HashV(SlotsN);
+		int KeysPerBucketN = BucketKeysN;
+		for (Seed = 0; Seed < 64; ++Seed) {
+			if (Seed > 0 && Seed % SeedsPerLoadN == 0 && KeysPerBucketN > 1) { KeysPerBucketN /= 2; }
+			BucketsN = SlotsN/KeysPerBucketN+1;
+			for (int KeyN = 0; KeyN < SlotsN; ++KeyN) { HashV[KeyN] = GetHash(KeyV[KeyN].CStr(), KeyV[KeyN].Len()); }
+			if (TryGen(HashV)) { break; }
+		}
+		EAssertR(Seed < 64, "Cannot build a perfect hash of attribute values.");
+		// Keys in slot order
+		TIntV SlotKeyV(SlotsN);
+		for (int KeyN = 0; KeyN < SlotsN; ++KeyN) { SlotKeyV[GetSlotN(HashV[KeyN], DispV[GetBucketN(HashV[KeyN])])] = KeyN; }
+		for (int SlotN = 0; SlotN < SlotsN; ++SlotN) {
+			const int KeyN = SlotKeyV[SlotN];
+			OffV.Add(KeyBfV.Len()); LenV.Add(KeyV[KeyN].Len()); CodeV.Add(KeyCodeV[KeyN]);
+			for (int ChN = 0; ChN < KeyV[KeyN].Len(); ++ChN) { KeyBfV.Add(KeyV[KeyN][ChN]); }
+		}
+	}
+	bool TValDict::TryGen(const TVec<uint64>& HashV) {
+		TVec<uint64> SortHashV(HashV); SortHashV.Sort();
+		for (int KeyN = 1; KeyN < SortHashV.Len(); ++KeyN) { if (SortHashV[KeyN-1] == SortHashV[KeyN]) { return false; } }
+		TVec<TIntV> BucketV(BucketsN);
+		for (int KeyN = 0; KeyN < HashV.Len(); ++KeyN) { BucketV[GetBucketN(HashV[KeyN])].Add(KeyN); }
+		// largest buckets first, while most slots are free
+		TIntPrV SizeBucketV(BucketsN, 0);
+		for (int BucketN = 0; BucketN < BucketsN; ++BucketN) { SizeBucketV.Add(TIntPr(BucketV[BucketN].Len(), BucketN)); }
+		SizeBucketV.Sort(false);
+		TBoolV TakenV(SlotsN); TakenV.PutAll(false);
+		DispV.Gen(BucketsN); DispV.PutAll(0);
+		// A few times the table size: with free slots left, a bucket almost always fits by then, and if not, another seed is
+		// cheaper than searching on
+		const int MxDisp = MxDispPerSlotN*SlotsN;
+		TIntV SlotV;
+		for (int PairN = 0; PairN < SizeBucketV.Len(); ++PairN) {
+			const TIntV& KeyNV = BucketV[SizeBucketV[PairN].Val2];
+			if (KeyNV.Empty()) { break; }
+			int Disp = 0;
+			for (; Disp < MxDisp; ++Disp) {
+				SlotV.Clr(false);
+				for (int KeyNN = 0; KeyNN < KeyNV.Len(); ++KeyNN) {
+					const int SlotN = GetSlotN(HashV[KeyNV[KeyNN]], Disp);
+					if (TakenV[SlotN] || SlotV.IsIn(SlotN)) { break; }
+					SlotV.Add(SlotN);
+				}
+				if (SlotV.Len() == KeyNV.Len()) { break; }
+			}
+			if (Disp == MxDisp) { return false; }
+			DispV[SizeBucketV[PairN].Val2] = Disp;
+			for (int SlotN = 0; SlotN < SlotV.Len(); ++SlotN) { TakenV[SlotV[SlotN]] = true; }
+		}
+		return true;
+	}
+
+	///////////////////////////////
+	// Data-Stream-Schema
+	TStr TSchema::CacheDir;
+	const int TSchema::CacheVersion = 2; // 2: value dictionaries are saved
+
+	TSchema::TSchema(const TParser& Parser) : AttrsN(Parser.AttrsHV.Len()-1) {
+		EAssertR(AttrsN >= 0, "The configuration file defines no attributes.");
+		AttrManV.Reserve(AttrsN+1);
+		// NOTE: Label is also ``attribute-managed''
+		for (int AttrN = 0; AttrN <= AttrsN; ++AttrN) {
+			const THash<TStr, TInt>& AttrH = Parser.AttrsHV.GetVal(AttrN);
+			// Continuous attributes have, in a sense, `single' value
+			const TAttrType Type = AttrH.Len() == 1 ? TAttrType::CONTINUOUS : TAttrType::DISCRETE;
+			AttrManV.Add(TAttrMan(AttrH, Parser.InvAttrsHV.GetVal(AttrN), AttrN, Parser.InvDataFormatH.GetDat(AttrN), Type));
+			NumericV.Add(Type == TAttrType::CONTINUOUS);
+			ValsNV.Add(AttrManV.Last().ValueV.Len());
+			if (AttrN == AttrsN) { // label
+				NumIdxV.Add(-1); DiscIdxV.Add(-1);
+			} else if (Type == TAttrType::CONTINUOUS) {
+				NumIdxV.Add(NumAttrV.Len()); DiscIdxV.Add(-1); NumAttrV.Add(AttrN);
+			} else {
+				NumIdxV.Add(-1); DiscIdxV.Add(DiscAttrV.Len()); DiscAttrV.Add(AttrN);
+			}
+		}
+		TaskType = NumericV.Last() ? TTaskType::REGRESSION : TTaskType::CLASSIFICATION;
+		GenValDicts();
+	}
+	TSchema::TSchema(TSIn& SIn) : AttrManV(SIn), NumericV(SIn), ValsNV(SIn), NumIdxV(SIn), DiscIdxV(SIn), NumAttrV(SIn), DiscAttrV(SIn) {
+		SIn.Load(AttrsN);
+		char TaskTypeCh; SIn.Load(TaskTypeCh); TaskType = (TTaskType) TaskTypeCh;
+		ValDictV.Load(SIn);
+	}
+	void TSchema::GenValDicts() {
+		ValDictV.Gen(AttrsN+1);
+		for (int AttrN = 0; AttrN <= AttrsN; ++AttrN) {
+			if (!NumericV[AttrN]) { ValDictV[AttrN].Gen(AttrManV[AttrN].AttrH); }
+		}
+	}
+	void TSchema::Save(TSOut& SOut) const {
+		AttrManV.Save(SOut); NumericV.Save(SOut); ValsNV.Save(SOut); NumIdxV.Save(SOut); DiscIdxV.Save(SOut); NumAttrV.Save(SOut); DiscAttrV.Save(SOut);
+		SOut.Save(AttrsN);
+		SOut.Save((char) TaskType);
+		ValDictV.Save(SOut);
+	}
+	// NOTE: The cache file name is the hash of the configuration text, and the file repeats the hash and the text length, so
+	// an edited configuration never loads a stale schema. A damaged cache file is parsed over and rewritten
+	PSchema TSchema::New(const TStr& ConfigFNm) {
+		const TStr Text = TStr::LoadTxt(ConfigFNm);
+		if (CacheDir.Empty()) { return new TSchema(TParser::FromText(Text)); }
+		const uint64 Hash = GetTextHash(Text);
+		const TStr CacheFNm = CacheDir + "/" + TStr::Fmt("%016llx", (unsigned long long) Hash) + ".schema";
+		if (TFile::Exists(CacheFNm)) {
+			try {
+				TFIn FIn(CacheFNm);
+				int Version, TextLen; uint64 FileHash;
+				FIn.Load(Version); FIn.Load(FileHash); FIn.Load(TextLen);
+				if (Version == CacheVersion && FileHash == Hash && TextLen == Text.Len()) { return new TSchema(FIn); }
+			} catch (PExcept Except) { }
+		}
+		PSchema Schema = new TSchema(TParser::FromText(Text));
+		if (!TDir::Exists(CacheDir)) { TDir::GenDir(CacheDir); }
+		// written under a name of its own (process and thread), so a concurrent run neither reads half a file nor writes into ours
+		const TStr TmpFNm = CacheFNm + TStr::Fmt(".%d-%llx.tmp", (int) getpid(),
+			(unsigned long long) std::hash<std::thread::id>()(std::this_thread::get_id()));
+		{
+			TFOut FOut(TmpFNm);
+			FOut.Save(CacheVersion); FOut.Save(Hash); FOut.Save(Text.Len());
+			Schema->Save(FOut);
+		}
+		if (TFile::Exists(CacheFNm)) { TFile::Del(CacheFNm); }
+		TFile::Rename(TmpFNm, CacheFNm);
+		return Schema;
+	}
+	uint64 TSchema::GetTextHash(const TStr& Text) {
+		uint64 Hash = 14695981039346656037ULL;
+		const char* Bf = Text.CStr();
+		for (int ChN = 0; ChN < Text.Len(); ++ChN) {
+			Hash ^= (uchar) Bf[ChN];
+			Hash *= 1099511628211ULL;
+		}
+		return Hash;
+	}
+	uint64 TSchema::GetMemUsed() const {
+		uint64 MemUsed = sizeof(TSchema)+AttrManV.GetMemUsed()+NumericV.GetMemUsed()+ValsNV.GetMemUsed()+
+			NumIdxV.GetMemUsed()+DiscIdxV.GetMemUsed()+NumAttrV.GetMemUsed()+DiscAttrV.GetMemUsed()+ValDictV.GetMemUsed();
+		for (int AttrN = 0; AttrN < AttrManV.Len(); ++AttrN) {
+			const TAttrMan& AttrMan = AttrManV[AttrN];
+			MemUsed += AttrMan.AttrH.GetMemUsed()+AttrMan.InvAttrH.GetMemUsed()+AttrMan.ValueV.GetMemUsed()+ValDictV[AttrN].GetMemUsed()-sizeof(TValDict); // the object is counted in ValDictV
+		}
+		return MemUsed;
+	}
+} // namespace TDatastream
@@ -0,0 +1,152 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <base.h>
+#include "parser.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Forward-Declarations
+	class TAttrMan;
+	ClassHdTP(TSchema, PSchema)
+
+	typedef TVec<TAttrMan> TAttrManV;
+
+	// learning task type
+	enum class TTaskType : char { CLASSIFICATION, REGRESSION };
+	// attribute value type
+	enum class TAttrType : char { DISCRETE, CONTINUOUS };
+
+	///////////////////////////////
+	// Attribute-Managment
+	class TAttrMan {
+	public:
+		TAttrMan(const THash<TStr, TInt>& AttrH_ = THash<TStr, TInt>(), const THash<TInt, TStr>& InvAttrH_ = THash<TInt, TStr>(),
+			const int& Id_ = -1, const TStr& Nm_ = "Anon", const TAttrType& Type_ = TAttrType::DISCRETE);
+		explicit TAttrMan(TSIn& SIn);
+		void Save(TSOut& SOut) const;
+		public:
+		THash<TStr, TInt> AttrH; // maps attribute value to id
+		THash<TInt, TStr> InvAttrH; // maps id to attribute value, inverting AttrH
+		TIntV ValueV; // possible values
+		TAttrType Type; // attribute type
+		TStr Nm; // attribute name
+		TInt Id; // attribute ID used internally
+	};
+
+	///////////////////////////////
+	// Value-Dictionary
+	// Maps the raw bytes of a discrete value straight to its code. Vocabularies of up to LinearMxN values are scanned
+	// linearly; larger ones get a minimal perfect hash (hash and displace: the key's bucket stores the displacement under
+	// which all keys of the bucket rehash to free slots), built once when the schema is compiled. Every slot keeps its key, so unknown
+	// values are detected and give -1
+	class TValDict {
+	public:
+		TValDict() : SlotsN(0), BucketsN(0), Seed(0) { }
+		explicit TValDict(TSIn& SIn);
+		void Save(TSOut& SOut) const;
+		void Gen(const THash<TStr, TInt>& ValH);
+		inline int GetValN(const char* Bf, const int& BfL) const {
+			if (BucketsN == 0) {
+				for (int SlotN = 0; SlotN < SlotsN; ++SlotN) { if (IsKey(SlotN, Bf, BfL)) { return CodeV[SlotN]; } }
+				return -1;
+			}
+			const uint64 Hash = GetHash(Bf, BfL);
+			const int SlotN = GetSlotN(Hash, DispV[GetBucketN(Hash)]);
+			return IsKey(SlotN, Bf, BfL) ? (int) CodeV[SlotN] : -1;
+		}
+		inline int GetValsN() const { return SlotsN; }
+		uint64 GetMemUsed() const { return sizeof(TValDict)+KeyBfV.GetMemUsed()+OffV.GetMemUsed()+LenV.GetMemUsed()+CodeV.GetMemUsed()+DispV.GetMemUsed(); }
+	private:
+		static const int LinearMxN = 8;
+		static const int BucketKeysN = 4; // average keys per bucket
+		static const int SeedsPerLoadN = 16; // failed seeds before buckets get fewer keys
+		static const int MxDispPerSlotN = 16; // displacements tried per bucket, relative to the table size
+		bool TryGen(const TVec<uint64>& HashV);
+		inline uint64 GetHash(const char* Bf, const int& BfL) const {
+			uint64 Hash = 14695981039346656037ULL ^ Seed;
+			for (int ChN = 0; ChN < BfL; ++ChN) { Hash ^= (uchar) Bf[ChN]; Hash *= 1099511628211ULL; }
+			Hash ^= Hash >> 33; Hash *= 0xff51afd7ed558ccdULL; Hash ^= Hash >> 33; // spread to the high bits
+			return Hash;
+		}
+		inline int GetBucketN(const uint64& Hash) const { return (int) ((Hash >> 32) % (uint64) BucketsN); }
+		inline int GetSlotN(const uint64& Hash, const int& Disp) const { // rehash under the bucket's displacement
+			uint64 SlotHash = Hash ^ ((uint64) (Disp+1) * 0x9e3779b97f4a7c15ULL);
+			SlotHash ^= SlotHash >> 29; SlotHash *= 0xbf58476d1ce4e5b9ULL; SlotHash ^= SlotHash >> 32;
+			return (int) (SlotHash % (uint64) SlotsN);
+		}
+		inline bool IsKey(const int& SlotN, const char* Bf, const int& BfL) const {
+			return LenV[SlotN] == BfL && memcmp(KeyBfV.BegI()+OffV[SlotN], Bf, BfL) == 0;
+		}
+	private:
+		TVec<char> KeyBfV; // all keys, back to back
+		TIntV OffV; // by slot 
+		TIntV LenV;
+		TIntV CodeV;
+		TIntV DispV; // by bucket 
+		int SlotsN;
+		int BucketsN; // 0 for linear scan
+		uint64 Seed;
+	};
+
+	///////////////////////////////
+	// Data-Stream-Schema
+	// Compiled once from the configuration file and never changed afterwards, so trees of an ensemble share one instance.
+	// Attributes are indexed 0..AttrsN-1 as in the data, the label (or target) comes last at index AttrsN. Learners keep
+	// the PSchema and pass `const TSchema&' down; GLib reference counts are not thread-safe, so do not copy PSchema on
+	// worker threads. With a cache directory set, a compiled schema is saved there under the hash of the configuration
+	// text, and later runs with the same configuration load it instead of parsing the file again
+	ClassTP(TSchema, PSchema) // {
+	public:
+		TSchema(const TParser& Parser);
+		explicit TSchema(TSIn& SIn);
+		static PSchema New(const TParser& Parser) { return new TSchema(Parser); }
+		static PSchema New(const TStr& ConfigFNm); // through the cache, if set
+		static PSchema Load(TSIn& SIn) { return new TSchema(SIn); }
+		void Save(TSOut& SOut) const;
+		static void SetCacheDir(const TStr& CacheDir_) { CacheDir = CacheDir_; } // empty disables the cache
+		static uint64 GetTextHash(const TStr& Text); // 64-bit FNV-1a
+		inline int GetAttrsN() const { return AttrsN; } // without the label
+		inline TTaskType GetTaskType() const { return TaskType; }
+		inline bool IsCls() const { return TaskType == TTaskType::CLASSIFICATION; }
+		inline bool IsNumeric(const int& AttrN) const { return NumericV[AttrN]; }
+		inline TAttrType GetType(const int& AttrN) const { return NumericV[AttrN] ? TAttrType::CONTINUOUS : TAttrType::DISCRETE; }
+		// number of values of a discrete attribute; numeric attributes have, in a sense, `single' value
+		inline int GetValsN(const int& AttrN) const { return ValsNV[AttrN]; }
+		inline int GetLabelsN() const { return ValsNV[AttrsN]; }
+		// dense index among the numeric (or discrete) attributes; -1 for attributes of the other type
+		inline int GetNumIdx(const int& AttrN) const { return NumIdxV[AttrN]; }
+		inline int GetDiscIdx(const int& AttrN) const { return DiscIdxV[AttrN]; }
+		inline int GetNumAttrsN() const { return NumAttrV.Len(); }
+		inline int GetDiscAttrsN() const { return DiscAttrV.Len(); }
+		inline const TIntV& GetNumAttrV() const { return NumAttrV; }
+		inline const TIntV& GetDiscAttrV() const { return DiscAttrV; }
+		// names
+		inline const TAttrMan& GetAttrMan(const int& AttrN) const { return AttrManV[AttrN]; }
+		inline const TAttrManV& GetAttrManV() const { return AttrManV; }
+		inline const TStr& GetAttrNm(const int& AttrN) const { return AttrManV[AttrN].Nm; }
+		inline const TStr& GetValNm(const int& AttrN, const int& ValN) const { return AttrManV[AttrN].InvAttrH.GetDat(ValN); }
+		inline const TStr& GetLabelNm(const int& LabelN) const { return GetValNm(AttrsN, LabelN); }
+		inline int GetValN(const int& AttrN, const TStr& ValNm) const { return AttrManV[AttrN].AttrH.GetDat(ValNm); }
+		// value code of raw bytes, for parsing; -1 if the value is unknown 
+		inline int GetValN(const int& AttrN, const char* Bf, const int& BfL) const { return ValDictV[AttrN].GetValN(Bf, BfL); }
+		uint64 GetMemUsed() const; // bytes
+	private:
+		void GenValDicts();
+	private:
+		static TStr CacheDir;
+		static const int CacheVersion;
+		int AttrsN;
+		TTaskType TaskType;
+		TAttrManV AttrManV; // value names; the only copy of the configuration hash tables
+		TBoolV NumericV;
+		TIntV ValsNV;
+		TIntV NumIdxV;
+		TIntV DiscIdxV;
+		TIntV NumAttrV; // numeric attributes, in order
+		TIntV DiscAttrV; // discrete attributes, in order
+		TVec<TValDict> ValDictV; // empty for numeric attributes; saved with the schema, so cache hits do not rebuild the hashes
+	};
+} // namespace TDatastream
+
+#endif
@@ -1,9 +1,18 @@
+# Plots a learning curve written with -evalEvery: (see TPreqEval); the error column is the fading-factor
+# error rate for classification and the MAE for regression 
+import sys
 from matplotlib import pyplot
 
-f = open('err.dat').read().split('\n')
+fnm = sys.argv[1] if len(sys.argv) > 1 else 'learning-curve.tsv'
+lines = [l.split('\t') for l in open(fnm).read().split('\n') if len(l) > 0]
+header, rows = lines[0], lines[1:]
 
-y = [float(k) if len(k) > 0 else 0 for k in f]
-x = range(len(y))
-
-pyplot.plot(x, y)
+x = [int(r[0]) for r in rows]
+fig, (ax_err, ax_nodes) = pyplot.subplots(2, 1, sharex=True)
+for col in range(1, len(header)-2):
+	ax_err.plot(x, [float(r[col]) for r in rows], label=header[col])
+ax_err.legend()
+ax_nodes.plot(x, [int(r[-2]) for r in rows], label='nodes')
+ax_nodes.set_xlabel('examples')
+ax_nodes.legend()
 pyplot.show()
@@ -0,0 +1,25 @@
+# Prints a binary event trace written with -trace: (see trace.h), one event per line 
+import struct
+import sys
+
+EVENTS = ['split', 'alt-start', 'swap', 'alt-drop', 'drift-check', 'forget']
+# event, node ID, argument, value, time (ns) 
+REC = struct.Struct('<BiidQ')
+
+if len(sys.argv) < 2:
+	print('usage: trace-decode.py trace.bin [event ...]')
+	sys.exit(1)
+
+only = set(sys.argv[2:])
+data = open(sys.argv[1], 'rb').read()
+if data[:8] != b'HTTRACE1':
+	print('%s is not an event trace' % sys.argv[1])
+	sys.exit(1)
+n = struct.unpack_from('<Q', data, 8)[0]
+print('time-ms\tevent\tnode\targ\tvalue')
+for i in range(n):
+	event, node, arg, val, tm = REC.unpack_from(data, 16+i*REC.size)
+	name = EVENTS[event] if event < len(EVENTS) else str(event)
+	if only and name not in only:
+		continue
+	print('%.3f\t%s\t%d\t%d\t%g' % (tm/1e6, name, node, arg, val))
@@ -0,0 +1,208 @@
+#include "server.h"
+#ifdef GLIB_UNIX
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+namespace TDatastream {
+	///////////////////////////////
+	// Scoring-and-Training-Server
+	void TServer::ServeStdIn() {
+		// Keep stdout for replies; debug output of the learner goes to stderr 
+#ifdef GLIB_UNIX
+		signal(SIGPIPE, SIG_IGN); // a closed stdout fails the write instead of killing the process 
+		FILE* Out = fdopen(dup(fileno(stdout)), "w");
+		EAssertR(Out != NULL, "Cannot open reply stream.");
+		fflush(stdout);
+		dup2(fileno(stderr), fileno(stdout));
+		Serve(fileno(stdin), Out);
+#else
+		FILE* Out = _fdopen(_dup(_fileno(stdout)), "w");
+		EAssertR(Out != NULL, "Cannot open reply stream.");
+		fflush(stdout);
+		_dup2(_fileno(stderr), _fileno(stdout));
+		Serve(_fileno(stdin), Out);
+#endif
+		fclose(Out);
+	}
+	void TServer::ServeUnixSocket(const TStr& SocketFNm) {
+#ifdef GLIB_UNIX
+		const int ListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+		EAssertR(ListenFd != -1, "Cannot create socket.");
+		struct sockaddr_un Addr;
+		memset(&Addr, 0, sizeof(Addr));
+		Addr.sun_family = AF_UNIX;
+		EAssertR(SocketFNm.Len() < (int)sizeof(Addr.sun_path), "Socket path too long.");
+		strcpy(Addr.sun_path, SocketFNm.CStr());
+		unlink(SocketFNm.CStr());
+		EAssertR(bind(ListenFd, (struct sockaddr*)&Addr, sizeof(Addr)) == 0, "Cannot bind socket `"+SocketFNm+"'.");
+		EAssertR(listen(ListenFd, 1) == 0, "Cannot listen on socket.");
+		// A client that disconnects fails the write instead of killing the process 
+		signal(SIGPIPE, SIG_IGN);
+		fprintf(stderr, "Listening on `%s'.\n", SocketFNm.CStr());
+		while (true) {
+			const int ConnFd = accept(ListenFd, NULL, NULL);
+			if (ConnFd == -1) { continue; }
+#ifdef SO_NOSIGPIPE
+			const int OnP = 1;
+			setsockopt(ConnFd, SOL_SOCKET, SO_NOSIGPIPE, &OnP, sizeof(OnP));
+#endif
+			FILE* Out = fdopen(dup(ConnFd), "w");
+			if (Out == NULL) { close(ConnFd); continue; }
+			try {
+				Serve(ConnFd, Out);
+			} catch (...) {
+				fclose(Out); close(ConnFd);
+				throw;
+			}
+			fclose(Out); close(ConnFd);
+			fprintf(stderr, "%s\n", GetStatsStr().CStr());
+		}
+#else
+		throw TDtExcept::New("Unix domain sockets are not supported on this platform.");
+#endif
+	}
+	TStr TServer::GetStatsStr() const {
+		const double MeanMSecs = BatchesN > 0 ? SumBatchMSecs/BatchesN : 0.0;
+		return TStr::Fmt("stats queue=%d maxQueue=%d requests=%s batches=%s lastBatchMs=%.3f meanBatchMs=%.3f maxBatchMs=%.3f",
+			LastQueueLen, MxQueueLen, TUInt64::GetStr(RequestsN).CStr(), TUInt64::GetStr(BatchesN).CStr(), LastBatchMSecs, MeanMSecs, MxBatchMSecs);
+	}
+	void TServer::Serve(const int& InFd, FILE* Out) {
+		EofP = false; StopP = false;
+		RequestQ.clear();
+		std::thread Reader(&TServer::Read, this, InFd);
+		std::deque<TRequest> BatchQ;
+		TChA ReplyChA;
+		// The reader must be joined on every way out, otherwise its destructor calls std::terminate 
+		try {
+			while (true) {
+				{
+					std::unique_lock<std::mutex> Lock(QueueMutex);
+					QueueCond.wait(Lock, [this] { return !RequestQ.empty() || EofP; });
+					if (RequestQ.empty() && EofP) { break; }
+					// Under light load, wait a little so that requests arriving together share a batch 
+					if ((int)RequestQ.size() < MxBatchN && !EofP) {
+						QueueCond.wait_for(Lock, std::chrono::milliseconds(MxWaitMSecs), [this] { return (int)RequestQ.size() >= MxBatchN || EofP; });
+					}
+					LastQueueLen = (int)RequestQ.size();
+					MxQueueLen = TMath::Mx<int>(MxQueueLen, LastQueueLen);
+					while (!RequestQ.empty() && (int)BatchQ.size() < MxBatchN) {
+						BatchQ.push_back(RequestQ.front());
+						RequestQ.pop_front();
+					}
+				}
+				ReplyChA.Clr();
+				ProcessBatch(BatchQ, ReplyChA);
+				if (!ReplyChA.Empty()) {
+					if ((int)fwrite(ReplyChA.CStr(), 1, ReplyChA.Len(), Out) != ReplyChA.Len() || fflush(Out) != 0) {
+						fprintf(stderr, "Client is gone; dropping the connection.\n");
+						break;
+					}
+				}
+				const double BatchMSecs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-BatchQ.front().ArrivalTm).count();
+				LastBatchMSecs = BatchMSecs; SumBatchMSecs += BatchMSecs;
+				MxBatchMSecs = TMath::Mx<double>(MxBatchMSecs, BatchMSecs);
+				RequestsN += BatchQ.size(); ++BatchesN;
+				BatchQ.clear();
+			}
+		} catch (...) {
+			StopReader(Reader);
+			throw;
+		}
+		StopReader(Reader);
+	}
+	void TServer::StopReader(std::thread& Reader) {
+		StopP = true;
+		Reader.join();
+	}
+	// Reads raw blocks instead of lines, so that it can wait for input with a timeout and notice StopP 
+	void TServer::Read(const int InFd) {
+		std::string BufStr;
+		char Buff[4096];
+		while (!StopP) {
+#ifdef GLIB_UNIX
+			struct pollfd PollFd;
+			PollFd.fd = InFd; PollFd.events = POLLIN; PollFd.revents = 0;
+			const int ReadyN = poll(&PollFd, 1, StopMSecs);
+			if (ReadyN == 0 || (ReadyN < 0 && errno == EINTR)) { continue; }
+			const ssize_t ReadN = ReadyN < 0 ? -1 : read(InFd, Buff, sizeof(Buff));
+			if (ReadN < 0 && errno == EINTR) { continue; }
+#else
+			// NOTE: No timeout on Windows; after StopP the reader ends with the next block or the end of input 
+			const int ReadN = _read(InFd, Buff, sizeof(Buff));
+#endif
+			if (ReadN <= 0) { break; }
+			BufStr.append(Buff, ReadN);
+			size_t StartN = 0, EndN;
+			while ((EndN = BufStr.find('\n', StartN)) != std::string::npos) {
+				PushLn(BufStr.substr(StartN, EndN-StartN));
+				StartN = EndN+1;
+			}
+			BufStr.erase(0, StartN);
+		}
+		if (!StopP) { PushLn(BufStr); } // last line without a newline 
+		std::lock_guard<std::mutex> Lock(QueueMutex);
+		EofP = true;
+		QueueCond.notify_one();
+	}
+	void TServer::PushLn(std::string Line) {
+		if (!Line.empty() && Line[Line.size()-1] == '\r') { Line.resize(Line.size()-1); }
+		if (Line.empty()) { return; }
+		TRequest Request;
+		Request.Line.swap(Line);
+		Request.ArrivalTm = std::chrono::steady_clock::now();
+		std::lock_guard<std::mutex> Lock(QueueMutex);
+		RequestQ.push_back(Request);
+		QueueCond.notify_one();
+	}
+	// Parse the whole batch first, then apply it in request order 
+	void TServer::ProcessBatch(const std::deque<TRequest>& BatchQ, TChA& ReplyChA) {
+		const int BatchLen = (int)BatchQ.size();
+		TVec<PExample> ExampleV(BatchLen);
+		TIntV TypeV(BatchLen); // 0 = train, 1 = predict, 2 = stats, -1 = malformed 
+		TStrV ErrV(BatchLen);
+		for (int RequestN = 0; RequestN < BatchLen; ++RequestN) {
+			const std::string& Line = BatchQ[RequestN].Line;
+			const size_t SepN = Line.find(' ');
+			const std::string Cmd = Line.substr(0, SepN);
+			if (Cmd == "stats") { TypeV[RequestN] = 2; continue; }
+			if ((Cmd != "train" && Cmd != "predict") || SepN == std::string::npos) {
+				TypeV[RequestN] = -1; ErrV[RequestN] = "Unknown request."; continue;
+			}
+			TypeV[RequestN] = Cmd == "train" ? 0 : 1;
+			try {
+				ExampleV[RequestN] = Tree->Preprocess(TStr(Line.c_str()+SepN+1), Delimiter);
+			} catch (PExcept Except) {
+				TypeV[RequestN] = -1; ErrV[RequestN] = Except->GetMsgStr();
+			}
+		}
+		const bool ClsP = Tree->Schema->IsCls();
+		TVec<PExample> TrainV; // consecutive train requests are learned together, before the next reply 
+		for (int RequestN = 0; RequestN < BatchLen; ++RequestN) {
+			if (TypeV[RequestN] == 0) { TrainV.Add(ExampleV[RequestN]); continue; }
+			if (!TrainV.Empty()) { Tree->ProcessBatch(TrainV); TrainV.Clr(false); }
+			switch (TypeV[RequestN]) {
+			case 1:
+				if (ClsP) {
+					ReplyChA += Tree->Schema->GetLabelNm(Tree->Classify(ExampleV[RequestN]));
+				} else {
+					ReplyChA += TFlt::GetStr(Tree->Predict(ExampleV[RequestN]));
+				}
+				ReplyChA += '\n';
+				break;
+			case 2:
+				ReplyChA += GetStatsStr(); ReplyChA += '\n';
+				break;
+			default:
+				ReplyChA += "error "; ReplyChA += ErrV[RequestN]; ReplyChA += '\n';
+			}
+		}
+		if (!TrainV.Empty()) { Tree->ProcessBatch(TrainV); }
+	}
+} // namespace TDatastream
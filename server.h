@@ -0,0 +1,68 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "hoeffding.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace TDatastream {
+	///////////////////////////////
+	// Scoring-and-Training-Server
+	// Line protocol, one request per line:
+	//   train <example>     learn from the example; no reply
+	//   predict <example>   reply with the predicted label (classification) or value (regression)
+	//   stats               reply with queue depth and batch latency
+	// Examples use the same format as THoeffdingTree::Preprocess. Replies come in request order.
+	// A reader thread queues requests; the learner takes whatever is queued (up to MxBatchN requests,
+	// waiting at most MxWaitMSecs for more) and answers the whole batch with a single write.
+	// A client that goes away ends only its connection; an error while learning stops the reader before it is rethrown.
+	ClassTP(TServer, PServer) // {
+	public:
+		static PServer New(PHoeffdingTree Tree, const int& MxBatchN = 1024, const int& MxWaitMSecs = 2, const TCh& Delimiter = ',') {
+			return new TServer(Tree, MxBatchN, MxWaitMSecs, Delimiter);
+		}
+		void ServeStdIn(); // requests on stdin, replies on stdout; other output goes to stderr
+		void ServeUnixSocket(const TStr& SocketFNm); // serves one connection after another; Unix only
+		TStr GetStatsStr() const;
+	private:
+		TServer(PHoeffdingTree Tree_, const int& MxBatchN_, const int& MxWaitMSecs_, const TCh& Delimiter_)
+			: Tree(Tree_), MxBatchN(MxBatchN_), MxWaitMSecs(MxWaitMSecs_), Delimiter(Delimiter_), EofP(false), StopP(false),
+			BatchesN(0), RequestsN(0), LastBatchMSecs(0.0), SumBatchMSecs(0.0), MxBatchMSecs(0.0), LastQueueLen(0), MxQueueLen(0) { }
+		void Serve(const int& InFd, FILE* Out); // returns when InFd is exhausted or the client is gone
+		void Read(const int InFd); // reader thread
+		void StopReader(std::thread& Reader);
+		struct TRequest {
+			std::string Line;
+			std::chrono::steady_clock::time_point ArrivalTm;
+		};
+		void ProcessBatch(const std::deque<TRequest>& BatchQ, TChA& ReplyChA);
+		void PushLn(std::string Line);
+	private:
+		PHoeffdingTree Tree;
+		const int MxBatchN;
+		const int MxWaitMSecs;
+		const TCh Delimiter;
+		// NOTE: Requests are queued as std::string, because TStr reference counts are not thread-safe
+		std::mutex QueueMutex;
+		std::condition_variable QueueCond;
+		std::deque<TRequest> RequestQ;
+		bool EofP;
+		std::atomic<bool> StopP; // set by the learner; the reader checks it at least every StopMSecs
+		static const int StopMSecs = 100;
+		// statistics
+		uint64 BatchesN;
+		uint64 RequestsN;
+		double LastBatchMSecs; // from the arrival of the oldest request to the reply
+		double SumBatchMSecs;
+		double MxBatchMSecs;
+		int LastQueueLen; // queue depth when the last batch was taken
+		int MxQueueLen;
+	};
+} // namespace TDatastream
+
+#endif
@@ -0,0 +1,267 @@
+#include "hoeffding.h"
+#include "generator.h"
+#include "ensemble.h"
+#include "pipeline.h"
+
+using namespace TDatastream;
+
+///////////////////////////////
+// Test-Harness
+// Every test is deterministic and throws (EAssertR) on failure; main runs the tests whose name starts with -test:
+// and returns the number of failures, so a build can run it as a check
+typedef void (*TTestFun)();
+struct TTest {
+	const char* Nm;
+	TTestFun Fun;
+};
+
+TStr GetConfigFNm(const PStreamGen& Gen);
+bool IsSameTree(const PHoeffdingTree& Tree1, const PHoeffdingTree& Tree2);
+void TestEnsembleThreads();
+void TestSnapshotReaders();
+void TestPrequentialPrediction();
+void TestNodePool();
+void TestPipeline();
+void TestBatchCvfdt();
+
+const TTest TestV[] = {
+	{ "ensemble-threads", TestEnsembleThreads },
+	{ "snapshot-readers", TestSnapshotReaders },
+	{ "prequential-prediction", TestPrequentialPrediction },
+	{ "node-pool", TestNodePool },
+	{ "pipeline", TestPipeline },
+	{ "batch-cvfdt", TestBatchCvfdt },
+};
+
+int main(int argc, char** argv) {
+	Env = TEnv(argc, argv, TNotify::StdNotify);
+	const TStr PrefixStr = Env.GetIfArgPrefixStr("-test:", "", "Run only the tests whose name starts with this");
+	int FailedN = 0;
+	for (int TestN = 0; TestN < (int) (sizeof(TestV)/sizeof(TestV[0])); ++TestN) {
+		const TStr TestNm = TestV[TestN].Nm;
+		if (!TestNm.IsPrefix(PrefixStr)) { continue; }
+		try {
+			TestV[TestN].Fun();
+			printf("[ OK ] %s\n", TestNm.CStr());
+		} catch (PExcept Except) {
+			printf("[FAIL] %s: %s\n", TestNm.CStr(), Except->GetMsgStr().CStr());
+			++FailedN;
+		}
+	}
+	return FailedN;
+}
+
+// Configuration of the generator's schema, written once per run
+TStr GetConfigFNm(const PStreamGen& Gen) {
+	const TStr ConfigFNm = "test-" + Gen->GetNm() + ".config";
+	if (!TFile::Exists(ConfigFNm)) { Gen->SaveConfig(ConfigFNm); }
+	return ConfigFNm;
+}
+
+// Saved trees compared byte for byte: same structure, counts, histograms, and IDs
+bool IsSameTree(const PHoeffdingTree& Tree1, const PHoeffdingTree& Tree2) {
+	TMOut MOut1, MOut2;
+	Tree1->Save(MOut1); Tree2->Save(MOut2);
+	return MOut1.Len() == MOut2.Len() && memcmp(MOut1.GetBfAddr(), MOut2.GetBfAddr(), MOut1.Len()) == 0;
+}
+
+///////////////////////////////
+// Ensemble
+// Every tree learns its examples in stream order whichever worker runs it, so the trees do not depend on the number of threads
+void TestEnsembleThreads() {
+	PStreamGen Gen = TRandomTreeGen::New(10, 5, 2, 5, 0, 0.05, 7);
+	const TStr ConfigFNm = GetConfigFNm(Gen);
+	PHoeffdingEnsemble SeqEns = THoeffdingEnsemble::New(ConfigFNm, 4, 100, 1e-6, 0.05, 1000, 5000, 1.0, 0, 1, 1);
+	PHoeffdingEnsemble ParEns = THoeffdingEnsemble::New(ConfigFNm, 4, 100, 1e-6, 0.05, 1000, 5000, 1.0, 0, 4, 1);
+	for (int ExampleN = 0; ExampleN < 20000; ++ExampleN) {
+		PExample Example = Gen->Next();
+		SeqEns->Process(Example); ParEns->Process(Example);
+		if (ExampleN % 5000 == 0) { ParEns->Flush(); } // workers go idle and must wake up for the next example
+	}
+	SeqEns->Flush(); ParEns->Flush();
+	for (int TreeN = 0; TreeN < SeqEns->GetTreesN(); ++TreeN) {
+		EAssertR(SeqEns->GetTree(TreeN)->GetNodesN() > 1, "The ensemble did not learn.");
+		EAssertR(IsSameTree(SeqEns->GetTree(TreeN), ParEns->GetTree(TreeN)), "Tree " + TInt::GetStr(TreeN) + " depends on the number of threads.");
+	}
+}
+
+///////////////////////////////
+// Snapshots
+// Readers score through pinned views while the tree learns and publishes: each reader sees the versions in order, and
+// the view published at the end classifies exactly like the tree
+void TestSnapshotReaders() {
+	PStreamGen Gen = TRandomTreeGen::New(10, 5, 2, 5, 0, 0.05, 11);
+	PHoeffdingTree Tree = THoeffdingTree::New(GetConfigFNm(Gen), 100, 1e-6, 0.05);
+	Tree->EnableSnapshots(8, 50);
+	const int ReadersN = 4;
+	const int LabelsN = Tree->Schema->GetLabelsN();
+	// Every reader scores its own examples, since PExample reference counts are not atomic either 
+	TVec<TVec<PExample> > ExampleVV(ReadersN);
+	for (int ReaderN = 0; ReaderN < ReadersN; ++ReaderN) {
+		for (int ExampleN = 0; ExampleN < 1000; ++ExampleN) { ExampleVV[ReaderN].Add(Gen->Next()); }
+	}
+	TViewPub* ViewPub = Tree->GetViewPub();
+	std::atomic<bool> DoneP(false);
+	std::atomic<int> ErrN(0);
+	std::atomic<uint64> ScoredN(0);
+	std::vector<std::thread> ReaderV;
+	for (int ReaderN = 0; ReaderN < ReadersN; ++ReaderN) {
+		const TVec<PExample>* ExampleV = &ExampleVV[ReaderN];
+		ReaderV.push_back(std::thread([ViewPub, ExampleV, LabelsN, &DoneP, &ErrN, &ScoredN] {
+			const int SlotN = ViewPub->Register();
+			uint64 Version = 0;
+			for (int ExampleN = 0; !DoneP.load(); ExampleN = (ExampleN+1) % ExampleV->Len()) {
+				TViewGuard View(ViewPub, SlotN);
+				if (View->GetVersion() < Version) { ++ErrN; }
+				Version = View->GetVersion();
+				const int Label = View->Classify((*ExampleV)[ExampleN]);
+				if (Label < 0 || Label >= LabelsN) { ++ErrN; }
+				++ScoredN;
+			}
+			ViewPub->Unregister(SlotN);
+		}));
+	}
+	for (int ExampleN = 0; ExampleN < 30000; ++ExampleN) { Tree->Process(Gen->Next()); }
+	DoneP.store(true);
+	for (auto It = ReaderV.begin(); It != ReaderV.end(); ++It) { It->join(); }
+	EAssertR(ErrN.load() == 0, "A reader saw an older view or an invalid label.");
+	EAssertR(ScoredN.load() > 0, "The readers did not score.");
+	EAssertR(Tree->GetNodesN() > 1, "The tree did not learn.");
+	Tree->Publish();
+	const int SlotN = ViewPub->Register();
+	{
+		TViewGuard View(ViewPub, SlotN);
+		for (int ExampleN = 0; ExampleN < ExampleVV[0].Len(); ++ExampleN) {
+			EAssertR(View->Classify(ExampleVV[0][ExampleN]) == Tree->Classify(ExampleVV[0][ExampleN]), "The view and the tree disagree.");
+		}
+	}
+	ViewPub->Unregister(SlotN);
+}
+
+///////////////////////////////
+// Prequential-Prediction
+// ProcessAndClassify returns what Classify says just before Process, also while nodes self-evaluate on a drifting stream
+void TestPrequentialPrediction() {
+	PStreamGen Gen = TSeaGen::New(5000, 0.1, 3);
+	const TStr ConfigFNm = GetConfigFNm(Gen);
+	PHoeffdingTree SepTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05, 100, 2000);
+	PHoeffdingTree PreqTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05, 100, 2000);
+	int MxAltTreesN = 0;
+	for (int ExampleN = 0; ExampleN < 40000; ++ExampleN) {
+		PExample Example = Gen->Next();
+		const int Label = SepTree->Classify(Example);
+		SepTree->Process(Example);
+		// Each tree gets its own copy, since CVFDT stores the leaf ID in the example 
+		EAssertR(PreqTree->ProcessAndClassify(TExample::New(*Example)) == Label, "Prediction differs at example " + TInt::GetStr(ExampleN) + ".");
+		MxAltTreesN = TMath::Mx<int>(MxAltTreesN, PreqTree->GetAltTreesN());
+	}
+	EAssertR(MxAltTreesN > 0, "The drift did not grow alternate trees, so no node self-evaluated.");
+	EAssertR(IsSameTree(SepTree, PreqTree), "ProcessAndClassify learned a different tree.");
+}
+
+///////////////////////////////
+// Node-Pool
+// A drifting stream drops subtrees, so slots are freed and reused while learning. Learning the same stream again
+// reuses the slots of the first tree and grows the same tree, also after the first one was learned on another thread
+PHoeffdingTree LearnPoolTree(const TStr& ConfigFNm, const TVec<PExample>& ExampleV) {
+	PHoeffdingTree Tree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05, 100, 2000);
+	for (int ExampleN = 0; ExampleN < ExampleV.Len(); ++ExampleN) { Tree->Process(TExample::New(*ExampleV[ExampleN])); }
+	return Tree;
+}
+
+void TestNodePool() {
+	PStreamGen Gen = TSeaGen::New(5000, 0.1, 5);
+	const TStr ConfigFNm = GetConfigFNm(Gen);
+	TVec<PExample> ExampleV;
+	for (int ExampleN = 0; ExampleN < 30000; ++ExampleN) { ExampleV.Add(Gen->Next()); }
+	// the worker only touches its own copies; ExampleV is read-only while it runs 
+	PHoeffdingTree ThreadTree;
+	std::thread Worker([&ConfigFNm, &ExampleV, &ThreadTree] { ThreadTree = LearnPoolTree(ConfigFNm, ExampleV); });
+	Worker.join();
+	TMOut ThreadMOut; ThreadTree->Save(ThreadMOut);
+	EAssertR(ThreadTree->GetNodesN() > 1, "The tree did not learn.");
+	ThreadTree.Clr(); // frees the worker's nodes on this thread 
+	PHoeffdingTree Tree = LearnPoolTree(ConfigFNm, ExampleV);
+	TMOut MOut; Tree->Save(MOut);
+	EAssertR(MOut.Len() == ThreadMOut.Len() && memcmp(MOut.GetBfAddr(), ThreadMOut.GetBfAddr(), MOut.Len()) == 0,
+		"The tree depends on the thread that learned it.");
+	const uint64 SlotsN = TNodePool::GetSlotsN();
+	Tree.Clr();
+	Tree = LearnPoolTree(ConfigFNm, ExampleV);
+	EAssertR(TNodePool::GetSlotsN() == SlotsN, "The pool grew instead of reusing the slots of the dropped tree.");
+	EAssertR(TNodePool::GetFreeN() <= SlotsN, "More free slots than slots.");
+	TMOut ReMOut; Tree->Save(ReMOut);
+	EAssertR(ReMOut.Len() == MOut.Len() && memcmp(ReMOut.GetBfAddr(), MOut.GetBfAddr(), MOut.Len()) == 0, "Reused slots grew a different tree.");
+}
+
+///////////////////////////////
+// Pipeline
+// Small chunks and several parsers still hand the learner the examples of the file in order, so it grows the same tree
+// as reading the file line by line; a malformed line stops the pipeline with the parser's message
+void TestPipeline() {
+	PStreamGen Gen = TRandomTreeGen::New(10, 5, 2, 5, 0, 0.05, 13);
+	const TStr ConfigFNm = GetConfigFNm(Gen);
+	PHoeffdingTree SeqTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05);
+	const PSchema& Schema = SeqTree->Schema;
+	const TStr DataFNm = "test-pipeline.dat";
+	{
+		TFOut FOut(DataFNm);
+		for (int ExampleN = 0; ExampleN < 20000; ++ExampleN) {
+			PExample Example = Gen->Next();
+			for (int AttrN = 0; AttrN < Schema->GetAttrsN(); ++AttrN) {
+				FOut.PutStr(Schema->GetValNm(AttrN, Example->AttributesV[AttrN].Value)); FOut.PutCh(',');
+			}
+			FOut.PutStr(Schema->GetLabelNm(Example->Label)); FOut.PutLn();
+		}
+	}
+	PDataIn In = TDataIn::New(DataFNm);
+	TStr Line;
+	while (In->GetNextLn(Line)) { SeqTree->Process(Line, ','); }
+	PHoeffdingTree PipeTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05);
+	PPipeline Pipeline = TPipeline::New(PipeTree, DataFNm, 3, 4, 4);
+	PExample Example;
+	while (Pipeline->Next(Example)) { PipeTree->Process(Example); }
+	EAssertR(Pipeline->GetExamplesN() == 20000, "The pipeline lost examples.");
+	EAssertR(SeqTree->GetNodesN() > 1, "The tree did not learn.");
+	EAssertR(IsSameTree(SeqTree, PipeTree), "The pipeline learned a different tree.");
+	{
+		TFOut FOut(DataFNm, true);
+		FOut.PutStr("not,a,valid,line"); FOut.PutLn();
+	}
+	bool ErrP = false;
+	try {
+		PPipeline ErrPipeline = TPipeline::New(PipeTree, DataFNm, 3, 4, 4);
+		while (ErrPipeline->Next(Example)) { }
+	} catch (PExcept Except) {
+		ErrP = !Except->GetMsgStr().Empty();
+	}
+	EAssertR(ErrP, "A malformed line did not stop the pipeline.");
+}
+
+///////////////////////////////
+// Batch-CVFDT
+// ProcessBatch grows the same tree as Process on a drifting stream, with batches shorter and longer than the window,
+// so examples of the current batch are forgotten too, and long enough for the root to self-evaluate 
+void TestBatchCvfdt() {
+	PStreamGen Gen = TRandomTreeGen::New(10, 5, 2, 5, 5000, 0.05, 17);
+	const TStr ConfigFNm = GetConfigFNm(Gen);
+	PHoeffdingTree SeqTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05, 100, 2000);
+	PHoeffdingTree BatchTree = THoeffdingTree::New(ConfigFNm, 100, 1e-6, 0.05, 100, 2000);
+	const int BatchLenV[] = { 1, 64, 777, 2500 };
+	int MxAltTreesN = 0;
+	for (int BatchN = 0, ExampleN = 0; ExampleN < 40000; ++BatchN) {
+		const int BatchLen = BatchLenV[BatchN % 4];
+		TVec<PExample> ExampleV;
+		for (int ExampleOff = 0; ExampleOff < BatchLen; ++ExampleOff, ++ExampleN) {
+			PExample Example = Gen->Next();
+			SeqTree->Process(Example);
+			// Each tree gets its own copy, since CVFDT stores the leaf ID in the example 
+			ExampleV.Add(TExample::New(*Example));
+		}
+		BatchTree->ProcessBatch(ExampleV);
+		MxAltTreesN = TMath::Mx<int>(MxAltTreesN, BatchTree->GetAltTreesN());
+		EAssertR(IsSameTree(SeqTree, BatchTree), "The trees differ after batch " + TInt::GetStr(BatchN) + ".");
+	}
+	EAssertR(SeqTree->GetNodesN() > 1, "The tree did not learn.");
+	EAssertR(MxAltTreesN > 0, "The drift did not grow alternate trees.");
+}
@@ -0,0 +1,76 @@
+#include "trace.h"
+
+namespace TDatastream {
+	///////////////////////////////
+	// Event-Trace
+	std::atomic<int> TTrace::Level((int) TTraceLevel::OFF);
+	std::atomic<uint64> TTrace::NextN(0);
+	TTrace::TRec* TTrace::RecV = nullptr;
+	uint64 TTrace::Mask = 0;
+	std::chrono::steady_clock::time_point TTrace::StartTm;
+
+	// NOTE: Not thread-safe with respect to Add; call before the learners start
+	void TTrace::Start(const TTraceLevel& Level_, const int& CapacityLog2) {
+		EAssertR(CapacityLog2 > 0 && CapacityLog2 < 32, "Trace capacity must be between 2^1 and 2^31 records.");
+		Level.store((int) TTraceLevel::OFF);
+		delete [] RecV;
+		const uint64 Capacity = 1ull << CapacityLog2;
+		RecV = new TRec[(size_t) Capacity];
+		for (uint64 RecN = 0; RecN < Capacity; ++RecN) { RecV[RecN].SeqN.store(0, std::memory_order_relaxed); }
+		Mask = Capacity-1;
+		NextN.store(0);
+		StartTm = std::chrono::steady_clock::now();
+		Level.store((int) Level_);
+	}
+	void TTrace::Add(const TTraceEvent& Event, const int& NodeId, const int& Arg, const double& Val) {
+		const uint64 RecN = NextN.fetch_add(1, std::memory_order_relaxed);
+		TRec& Rec = RecV[RecN & Mask];
+		Rec.SeqN.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Rec.TmNSecs = (uint64) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-StartTm).count();
+		Rec.NodeId = NodeId;
+		Rec.Arg = Arg;
+		Rec.Val = Val;
+		Rec.Event = (uchar) Event;
+		Rec.SeqN.store(RecN+1, std::memory_order_release);
+	}
+	// File: "HTTRACE1", record count (uint64), then records as event (uint8), node ID (int32), argument (int32),
+	// value (double), time (uint64 ns); all little-endian
+	void TTrace::Save(const TStr& FNm) {
+		TFOut FOut(FNm);
+		FOut.PutStr("HTTRACE1");
+		const uint64 EndN = NextN.load(std::memory_order_acquire);
+		const uint64 BegN = RecV == nullptr ? EndN : (EndN > Mask+1 ? EndN-(Mask+1) : 0);
+		// Copy consistent records first, so that the count in the header is exact
+		TVec<uchar> EventV; TIntV NodeIdV, ArgV; TFltV ValV; TVec<uint64> TmV;
+		for (uint64 RecN = BegN; RecN < EndN; ++RecN) {
+			const TRec& Rec = RecV[RecN & Mask];
+			if (Rec.SeqN.load(std::memory_order_acquire) != RecN+1) { continue; } // being written or already overwritten
+			const uchar Event = Rec.Event; const int NodeId = Rec.NodeId, Arg = Rec.Arg;
+			const double Val = Rec.Val; const uint64 TmNSecs = Rec.TmNSecs;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (Rec.SeqN.load(std::memory_order_relaxed) != RecN+1) { continue; }
+			EventV.Add(Event); NodeIdV.Add(NodeId); ArgV.Add(Arg); ValV.Add(Val); TmV.Add(TmNSecs);
+		}
+		FOut.Save((uint64) EventV.Len());
+		for (int RecN = 0; RecN < EventV.Len(); ++RecN) {
+			FOut.Save(EventV[RecN]); FOut.Save((int) NodeIdV[RecN]); FOut.Save((int) ArgV[RecN]);
+			FOut.Save((double) ValV[RecN]); FOut.Save(TmV[RecN]);
+		}
+		FOut.Flush();
+	}
+	TTraceLevel TTrace::GetLevel(const TTraceEvent& Event) {
+		switch (Event) {
+		case TTraceEvent::DRIFT_CHECK: return TTraceLevel::CHECK;
+		case TTraceEvent::FORGET: return TTraceLevel::ALL;
+		default: return TTraceLevel::STRUCT;
+		}
+	}
+	TTraceLevel TTrace::GetLevel(const TStr& LevelNm) {
+		if (LevelNm == "off") { return TTraceLevel::OFF; }
+		if (LevelNm == "struct") { return TTraceLevel::STRUCT; }
+		if (LevelNm == "check") { return TTraceLevel::CHECK; }
+		if (LevelNm == "all") { return TTraceLevel::ALL; }
+		throw TExcept::New("Trace level must be one of off, struct, check, or all.");
+	}
+} // namespace TDatastream
@@ -0,0 +1,58 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <base.h>
+#include <atomic>
+#include <chrono>
+
+namespace TDatastream {
+	// traced learner events; the numbers are part of the file format (see scripts/trace-decode.py)
+	enum class TTraceEvent : uchar { SPLIT = 0, ALT_START = 1, SWAP = 2, ALT_DROP = 3, DRIFT_CHECK = 4, FORGET = 5 };
+	// verbosity; each level includes the previous ones
+	enum class TTraceLevel : char { OFF = 0, STRUCT = 1, CHECK = 2, ALL = 3 }; // STRUCT: splits, alternate trees, swaps; CHECK: drift checks; ALL: forgetting
+
+	///////////////////////////////
+	// Event-Trace
+	// Process-wide ring buffer of fixed-size binary records; when full, the oldest records are overwritten.
+	// Writers claim slots with a single atomic increment and publish them with a sequence number, so trees
+	// on different threads can trace concurrently and Save skips records that were overwritten while copying.
+	//   Record: event, node ID, argument (usually an attribute index), value (usually the split heuristic estimate),
+	//   nanoseconds since Start
+	class TTrace {
+	public:
+		static void Start(const TTraceLevel& Level_ = TTraceLevel::STRUCT, const int& CapacityLog2 = 20);
+		static void Stop() { Level.store((int) TTraceLevel::OFF, std::memory_order_relaxed); }
+		static inline bool IsOn(const TTraceEvent& Event) {
+			return (int) GetLevel(Event) <= Level.load(std::memory_order_relaxed);
+		}
+		static void Add(const TTraceEvent& Event, const int& NodeId, const int& Arg, const double& Val);
+		static void Save(const TStr& FNm); // oldest record first
+		static inline uint64 GetRecsN() { return NextN.load(std::memory_order_relaxed); } // including overwritten ones
+		static TTraceLevel GetLevel(const TTraceEvent& Event);
+		static TTraceLevel GetLevel(const TStr& LevelNm); // off, struct, check, all
+	private:
+		struct TRec {
+			std::atomic<uint64> SeqN; // 1+position in the stream once written; 0 while empty or being written
+			uint64 TmNSecs;
+			int NodeId;
+			int Arg;
+			double Val;
+			uchar Event;
+		};
+		static std::atomic<int> Level;
+		static std::atomic<uint64> NextN;
+		static TRec* RecV;
+		static uint64 Mask;
+		static std::chrono::steady_clock::time_point StartTm;
+	};
+} // namespace TDatastream
+
+// Record an event if the current verbosity includes it; compile with HT_NTRACE to remove all tracing
+#ifdef HT_NTRACE
+	#define HT_TRACE(Event, NodeId, Arg, Val)
+#else
+	#define HT_TRACE(Event, NodeId, Arg, Val) \
+		do { if (TDatastream::TTrace::IsOn(Event)) { TDatastream::TTrace::Add(Event, NodeId, Arg, Val); } } while (0)
+#endif
+
+#endif
@@ -1,27 +1,149 @@
 #include "winnow.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace TDatastream {
 	///////////////////////////////
 	// Winnow
+	TWinnow::TWinnow(const int& FeaturesN_, const int& LabelsN_, const double& Treshold, const double& Alpha)
+		: FeaturesN(FeaturesN_), LabelsN(LabelsN_), ModelsN(LabelsN_ <= 2 ? 1 : LabelsN_), Treshold(Treshold), Alpha(Alpha) {
+		EAssertR(FeaturesN > 0 && LabelsN >= 2, "Winnow needs at least one feature and two labels.");
+		WeightV.Gen(FeaturesN*ModelsN); WeightV.PutAll(1.0); // multiplicative updates never move a zero weight
+		ScoreBfV.Gen(ModelsN);
+	}
 	void TWinnow::Process(const TIntV& Example) {
-		const bool Label = Example.Last() == 1;
-		const bool Pred = Dot(WeightV, Example) > Treshold;
-		if (Label != Pred) {
-			const double Factor = Label ? Alpha : 1/Alpha;
-			for (int ElN = 0; ElN < WeightV.Len(); ++ElN) {
-				if (Example[ElN]) WeightV[ElN] *= Factor;
-			}
-		}
+		GetActive(Example);
+		const int Label = ModelsN == 1 ? (Example.Last() == 1 ? 1 : 0) : Example.Last();
+		Update(GetPt(ActiveBfV), ActiveBfV.Len(), Label);
 	}
 	int TWinnow::Classify(const TIntV& Example) {
-		return Dot(WeightV, Example) > Treshold;
+		GetActive(Example);
+		GetScores(GetPt(ActiveBfV), ActiveBfV.Len(), GetPt(ScoreBfV));
+		return GetLabel(GetPt(ScoreBfV));
+	}
+	void TWinnow::ProcessSparse(const TIntV& ActiveV, const int& Label) {
+		CheckSparse(ActiveV);
+		Update(GetPt(ActiveV), ActiveV.Len(), Label);
+	}
+	int TWinnow::ClassifySparse(const TIntV& ActiveV) {
+		CheckSparse(ActiveV);
+		GetScores(GetPt(ActiveV), ActiveV.Len(), GetPt(ScoreBfV));
+		return GetLabel(GetPt(ScoreBfV));
+	}
+	void TWinnow::ProcessBits(const TVec<uint64>& BitV, const int& Label) {
+		GetActive(BitV);
+		Update(GetPt(ActiveBfV), ActiveBfV.Len(), Label);
+	}
+	int TWinnow::ClassifyBits(const TVec<uint64>& BitV) {
+		GetActive(BitV);
+		GetScores(GetPt(ActiveBfV), ActiveBfV.Len(), GetPt(ScoreBfV));
+		return GetLabel(GetPt(ScoreBfV));
+	}
+	void TWinnow::ProcessBatch(const TVec<TIntV>& ActiveVV, const TIntV& LabelV) {
+		EAssertR(ActiveVV.Len() == LabelV.Len(), "Every example needs a label.");
+		for (int ExampleN = 0; ExampleN < ActiveVV.Len(); ++ExampleN) {
+			ProcessSparse(ActiveVV[ExampleN], LabelV[ExampleN]);
+		}
+	}
+	double TWinnow::GetScore(const TIntV& ActiveV, const int& LabelN) const {
+		CheckSparse(ActiveV);
+		EAssertR(0 <= LabelN && LabelN < LabelsN, "Label out of range.");
+		if (ModelsN == 1) { return GatherSum(GetPt(WeightV), GetPt(ActiveV), ActiveV.Len()); }
+		double Score = 0.0;
+		for (int ElN = 0; ElN < ActiveV.Len(); ++ElN) { Score += WeightV[ActiveV[ElN]*ModelsN+LabelN]; }
+		return Score;
+	}
+	void TWinnow::SetWeighs(TFltV& Model, const int& LabelN) const {
+		const int ModelN = GetModelN(LabelN);
+		Model.Gen(FeaturesN);
+		for (int FeatureN = 0; FeatureN < FeaturesN; ++FeatureN) { Model[FeatureN] = WeightV[FeatureN*ModelsN+ModelN]; }
+	}
+	void TWinnow::GetScores(const int* ActiveV, const int& ActiveN, double* ScoreV) const {
+		const double* Weights = GetPt(WeightV);
+		if (ModelsN == 1) { ScoreV[0] = GatherSum(Weights, ActiveV, ActiveN); return; }
+		for (int ModelN = 0; ModelN < ModelsN; ++ModelN) { ScoreV[ModelN] = 0.0; }
+		// The weights of a feature are contiguous, so the inner loop adds two rows and vectorizes
+		for (int ElN = 0; ElN < ActiveN; ++ElN) {
+			const double* FeatureWeights = Weights+(int64) ActiveV[ElN]*ModelsN;
+			for (int ModelN = 0; ModelN < ModelsN; ++ModelN) { ScoreV[ModelN] += FeatureWeights[ModelN]; }
+		}
 	}
-	double TWinnow::Dot(const TFltV& WeightV, const TIntV& BoolV) {
-		EAssert(WeightV.Len() == BoolV.Len()-1); // last BoolV is class label 
-		double Val = 0;
-		for (int ElN = 0; ElN < WeightV.Len(); ++ElN) {
-			Val += WeightV[ElN]*BoolV[ElN];
+	int TWinnow::GetLabel(const double* ScoreV) const {
+		if (ModelsN == 1) { return ScoreV[0] > Treshold; }
+		int BestN = 0;
+		for (int ModelN = 1; ModelN < ModelsN; ++ModelN) {
+			if (ScoreV[ModelN] > ScoreV[BestN]) { BestN = ModelN; }
+		}
+		return BestN;
+	}
+	// Mistake-driven: only the Winnows that got the example wrong change, and only their active weights
+	void TWinnow::Update(const int* ActiveV, const int& ActiveN, const int& Label) {
+		EAssertR(0 <= Label && Label < LabelsN, "Label out of range.");
+		double* Weights = GetPt(WeightV);
+		GetScores(ActiveV, ActiveN, GetPt(ScoreBfV));
+		for (int ModelN = 0; ModelN < ModelsN; ++ModelN) {
+			const bool LabelP = ModelsN == 1 ? Label == 1 : Label == ModelN;
+			const bool PredP = ScoreBfV[ModelN] > Treshold;
+			if (LabelP == PredP) { continue; }
+			const double Factor = LabelP ? Alpha : 1/Alpha;
+			for (int ElN = 0; ElN < ActiveN; ++ElN) { Weights[(int64) ActiveV[ElN]*ModelsN+ModelN] *= Factor; }
+		}
+	}
+	void TWinnow::CheckSparse(const TIntV& ActiveV) const {
+		for (int ElN = 0; ElN < ActiveV.Len(); ++ElN) {
+			EAssertR(0 <= ActiveV[ElN] && ActiveV[ElN] < FeaturesN, "Feature index out of range.");
+		}
+	}
+	void TWinnow::GetActive(const TIntV& Example) {
+		EAssert(Example.Len() == FeaturesN+1); // last element is the class label
+		ActiveBfV.Clr(false);
+		for (int ElN = 0; ElN < FeaturesN; ++ElN) {
+			if (Example[ElN]) { ActiveBfV.Add(ElN); }
+		}
+	}
+	void TWinnow::GetActive(const TVec<uint64>& BitV) {
+		const int WordsN = (FeaturesN+63)/64;
+		EAssertR(BitV.Len() >= WordsN, "Too few words for the number of features.");
+		ActiveBfV.Clr(false);
+		for (int WordN = 0; WordN < WordsN; ++WordN) {
+			uint64 Word = BitV[WordN];
+			if (WordN == WordsN-1 && FeaturesN % 64 != 0) { Word &= (1ULL << (FeaturesN % 64))-1; } // ignore padding bits
+			while (Word != 0) {
+#ifdef _MSC_VER
+				unsigned long BitN; _BitScanForward64(&BitN, Word);
+#else
+				const int BitN = __builtin_ctzll(Word);
+#endif
+				ActiveBfV.Add(WordN*64+(int) BitN);
+				Word &= Word-1; // clear the lowest set bit
+			}
+		}
+	}
+	double TWinnow::GatherSum(const double* WeightV, const int* ActiveV, const int& ActiveN) {
+		int ElN = 0;
+		double Sum = 0.0;
+#ifdef __AVX2__
+		__m256d SumV = _mm256_setzero_pd();
+		for (; ElN+4 <= ActiveN; ElN += 4) {
+			const __m128i IdxV = _mm_loadu_si128((const __m128i*) (ActiveV+ElN));
+			SumV = _mm256_add_pd(SumV, _mm256_i32gather_pd(WeightV, IdxV, 8));
+		}
+		double LaneV[4]; _mm256_storeu_pd(LaneV, SumV);
+		Sum = (LaneV[0]+LaneV[1])+(LaneV[2]+LaneV[3]);
+#else
+		// four independent sums, so the additions do not wait on each other
+		double Sum1 = 0.0, Sum2 = 0.0, Sum3 = 0.0, Sum4 = 0.0;
+		for (; ElN+4 <= ActiveN; ElN += 4) {
+			Sum1 += WeightV[ActiveV[ElN]]; Sum2 += WeightV[ActiveV[ElN+1]];
+			Sum3 += WeightV[ActiveV[ElN+2]]; Sum4 += WeightV[ActiveV[ElN+3]];
 		}
-		return Val;
+		Sum = (Sum1+Sum2)+(Sum3+Sum4);
+#endif
+		for (; ElN < ActiveN; ++ElN) { Sum += WeightV[ActiveV[ElN]]; }
+		return Sum;
 	}
 } // namespace TDatastream
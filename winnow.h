@@ -7,28 +7,68 @@
 namespace TDatastream {
 	///////////////////////////////
 	// Winnow
+	// Examples come in one of three forms: a dense 0/1 vector with the label last, a sparse list of active feature
+	// indices, or a bit-packed vector where feature n is bit n%64 of word n/64. Only active features are touched, so a
+	// score is a gather-sum over the active weights. With more than two labels there is one Winnow per label
+	// (one-vs-rest), and the label with the highest score wins; the weights of a feature are stored next to each other
+	// for all labels, so every active feature is read once.
+	//   PWinnow Winnow = TWinnow::NewMulti(FeaturesN, LabelsN);
+	//   Winnow->ProcessSparse(ActiveV, Label);
+	//   const int Label = Winnow->ClassifySparse(ActiveV);
 	ClassTP(TWinnow, PWinnow) // {
 	private:
-		TWinnow(const int& FeaturesN, const double& Treshold, const double& Alpha)
-			: Treshold(Treshold), Alpha(Alpha) { WeightV.Reserve(FeaturesN, FeaturesN); }
+		TWinnow(const int& FeaturesN_, const int& LabelsN_, const double& Treshold, const double& Alpha);
 	public:
 		static PWinnow New(const int& FeaturesN, const double& Treshold, const double& Alpha = 2.0) {
-			return new TWinnow(FeaturesN, Treshold, Alpha);
+			return new TWinnow(FeaturesN, 2, Treshold, Alpha);
 		}
 		static PWinnow New(const int& FeaturesN, const double& Alpha = 2.0) {
-			return new TWinnow(FeaturesN, FeaturesN/2.0, Alpha);
+			return new TWinnow(FeaturesN, 2, FeaturesN/2.0, Alpha);
 		}
+		static PWinnow NewMulti(const int& FeaturesN, const int& LabelsN, const double& Treshold, const double& Alpha) {
+			return new TWinnow(FeaturesN, LabelsN, Treshold, Alpha);
+		}
+		static PWinnow NewMulti(const int& FeaturesN, const int& LabelsN, const double& Alpha = 2.0) {
+			return new TWinnow(FeaturesN, LabelsN, FeaturesN/2.0, Alpha);
+		}
+		// dense; the last element is the label
 		void Process(const TIntV& Example);
 		int Classify(const TIntV& Example);
-		void SetWeighs(TFltV& Model) const {
-			Model = WeightV;
-		}
+		// sparse; indices of the active features in any order
+		void ProcessSparse(const TIntV& ActiveV, const int& Label);
+		int ClassifySparse(const TIntV& ActiveV);
+		// bit-packed; at least (FeaturesN+63)/64 words
+		void ProcessBits(const TVec<uint64>& BitV, const int& Label);
+		int ClassifyBits(const TVec<uint64>& BitV);
+		// in order, exactly as one at a time
+		void ProcessBatch(const TVec<TIntV>& ActiveVV, const TIntV& LabelV);
+		double GetScore(const TIntV& ActiveV, const int& LabelN = 1) const; // sum of the active weights of the label's Winnow
+		inline int GetFeaturesN() const { return FeaturesN; }
+		inline int GetLabelsN() const { return LabelsN; }
+		// Weights of the label's Winnow; with two labels there is a single Winnow, which predicts label 1
+		void SetWeighs(TFltV& Model, const int& LabelN = 1) const;
 	private:
-		static double Dot(const TFltV& WeightV, const TIntV& BoolV);
+		inline int GetModelN(const int& LabelN) const { return ModelsN == 1 ? 0 : LabelN; }
+		void GetScores(const int* ActiveV, const int& ActiveN, double* ScoreV) const;
+		int GetLabel(const double* ScoreV) const;
+		void Update(const int* ActiveV, const int& ActiveN, const int& Label);
+		void CheckSparse(const TIntV& ActiveV) const;
+		void GetActive(const TIntV& Example); // into ActiveBfV
+		void GetActive(const TVec<uint64>& BitV);
+		static double GatherSum(const double* WeightV, const int* ActiveV, const int& ActiveN);
+		// TInt and TFlt only wrap an int and a double, so the vectors are plain arrays for the inner loops
+		static inline const int* GetPt(const TIntV& Vec) { return (const int*) Vec.BegI(); }
+		static inline const double* GetPt(const TFltV& Vec) { return (const double*) Vec.BegI(); }
+		static inline double* GetPt(TFltV& Vec) { return (double*) Vec.BegI(); }
 	private:
-		TFltV WeightV;
+		int FeaturesN;
+		int LabelsN;
+		int ModelsN; // one for two labels, otherwise one per label
+		TFltV WeightV; // feature-major: WeightV[FeatureN*ModelsN+ModelN]
 		double Treshold;
 		double Alpha;
+		TIntV ActiveBfV; // active features of a dense or bit-packed example
+		TFltV ScoreBfV;
 	};
 
 } // namespace TDatastream